@@ -30,13 +30,24 @@
 struct PageFaultInfo
 {
     uptr addr;
+    bool write; // the faulting access was a write
 
-    PageFaultInfo(uptr address)
+    PageFaultInfo(uptr address, bool is_write = false)
     {
         addr = address;
+        write = is_write;
     }
 };
 
+// A listener that unprotects a page only for the faulting access asks for a single step:
+// the platform handler sets the trap flag, lets the instruction complete, and calls
+// Rearm(Param) from the trap that follows it.
+struct PageFaultStep
+{
+    void (*Rearm)(uptr param);
+    uptr Param;
+};
+
 // --------------------------------------------------------------------------------------
 //  IEventListener_PageFault
 // --------------------------------------------------------------------------------------
@@ -107,10 +118,13 @@ protected:
 
 protected:
     bool m_handled;
+    int m_stepCount;
+    PageFaultStep m_steps[4];
 
 public:
     SrcType_PageFault()
         : m_handled(false)
+        , m_stepCount(0)
     {
     }
     virtual ~SrcType_PageFault() = default;
@@ -118,6 +132,12 @@ public:
     bool WasHandled() const { return m_handled; }
     virtual void Dispatch(const PageFaultInfo &params);
 
+    // Only valid from a listener's OnPageFaultEvent.
+    void RequestStep(void (*rearm)(uptr), uptr param);
+
+    int GetStepCount() const { return m_stepCount; }
+    const PageFaultStep &GetStep(int i) const { return m_steps[i]; }
+
 protected:
     virtual void _DispatchRaw(ListenerIterator iter, const ListenerIterator &iend, const PageFaultInfo &evt);
 };
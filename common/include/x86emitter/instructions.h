@@ -502,6 +502,25 @@ extern void xINSERTPS(const xRegisterSSE &to, const xIndirect32 &from, u8 imm8);
 extern void xEXTRACTPS(const xRegister32or64 &to, const xRegisterSSE &from, u8 imm8);
 extern void xEXTRACTPS(const xIndirect32 &dest, const xRegisterSSE &from, u8 imm8);
 
+// ------------------------------------------------------------------------
+// AVX2 256 bit integer forms, only for code generated when x86caps.hasAVX2. Emit
+// xVZEROUPPER before going back to legacy SSE code. Memory operands can't use r8-r15 as
+// base or index, the VEX helpers don't encode VEX.X/VEX.B for them.
+
+extern void xVMOVDQU(const xRegisterYMM &to, const xIndirectVoid &from);
+extern void xVMOVDQU(const xIndirectVoid &to, const xRegisterYMM &from);
+
+extern void xVPMOVSXBD(const xRegisterYMM &to, const xIndirectVoid &from);
+extern void xVPMOVSXWD(const xRegisterYMM &to, const xIndirectVoid &from);
+extern void xVPMOVZXBD(const xRegisterYMM &to, const xIndirectVoid &from);
+extern void xVPMOVZXWD(const xRegisterYMM &to, const xIndirectVoid &from);
+
+extern void xVPBLENDD(const xRegisterYMM &to, const xRegisterYMM &from1, const xRegisterYMM &from2, u8 imm8);
+extern void xVPBLENDD(const xRegisterYMM &to, const xRegisterYMM &from1, const xIndirectVoid &from2, u8 imm8);
+extern void xVINSERTI128(const xRegisterYMM &to, const xRegisterYMM &from1, const xRegisterSSE &from2, u8 imm8);
+
+extern void xVZEROUPPER();
+
 // ------------------------------------------------------------------------
 
 extern const xImplSimd_DestRegEither xPAND;
@@ -124,7 +124,7 @@ __emitinline void xOpWriteC5(u8 prefix, u8 opcode, const T1 &param1, const T2 &p
 {
     pxAssert(prefix == 0 || prefix == 0x66 || prefix == 0xF3 || prefix == 0xF2);
 
-    const xRegisterInt &reg = param1.IsReg() ? param1 : param2;
+    const xRegisterBase &reg = param1.IsReg() ? static_cast<const xRegisterBase &>(param1) : static_cast<const xRegisterBase &>(param2);
 
 #ifdef __M_X86_64
     u8 nR = reg.IsExtended() ? 0x00 : 0x80;
@@ -148,12 +148,12 @@ __emitinline void xOpWriteC5(u8 prefix, u8 opcode, const T1 &param1, const T2 &p
 
 // VEX 3 Bytes Prefix
 template <typename T1, typename T2, typename T3>
-__emitinline void xOpWriteC4(u8 prefix, u8 mb_prefix, u8 opcode, const T1 &param1, const T2 &param2, const T3 &param3, int w = -1)
+__emitinline void xOpWriteC4(u8 prefix, u8 mb_prefix, u8 opcode, const T1 &param1, const T2 &param2, const T3 &param3, int w = -1, int extraRIPOffset = 0)
 {
     pxAssert(prefix == 0 || prefix == 0x66 || prefix == 0xF3 || prefix == 0xF2);
     pxAssert(mb_prefix == 0x0F || mb_prefix == 0x38 || mb_prefix == 0x3A);
 
-    const xRegisterInt &reg = param1.IsReg() ? param1 : param2;
+    const xRegisterBase &reg = param1.IsReg() ? static_cast<const xRegisterBase &>(param1) : static_cast<const xRegisterBase &>(param2);
 
 #ifdef __M_X86_64
     u8 nR = reg.IsExtended() ? 0x00 : 0x80;
@@ -183,6 +183,6 @@ __emitinline void xOpWriteC4(u8 prefix, u8 mb_prefix, u8 opcode, const T1 &param
     xWrite8(nR | nX | nB | m);
     xWrite8(W | nv | L | p);
     xWrite8(opcode);
-    EmitSibMagic(param1, param3);
+    EmitSibMagic(param1, param3, extraRIPOffset);
 }
 }
@@ -464,6 +464,32 @@ public:
     static const inline xRegisterSSE &GetInstance(uint id);
 };
 
+// --------------------------------------------------------------------------------------
+//  xRegisterYMM  -  Represents a 256 bit AVX register
+// --------------------------------------------------------------------------------------
+// Only accepted by the VEX.256 instructions (xVMOVDQU and friends). The low 128 bits are
+// the xRegisterSSE of the same Id.
+
+class xRegisterYMM : public xRegisterBase
+{
+    typedef xRegisterBase _parent;
+
+public:
+    xRegisterYMM()
+        : _parent()
+    {
+    }
+    explicit xRegisterYMM(int regId)
+        : _parent(regId)
+    {
+    }
+
+    virtual uint GetOperandSize() const { return 32; }
+
+    bool operator==(const xRegisterYMM &src) const { return this->Id == src.Id; }
+    bool operator!=(const xRegisterYMM &src) const { return this->Id != src.Id; }
+};
+
 class xRegisterCL : public xRegister8
 {
 public:
@@ -643,6 +669,12 @@ extern const xRegisterSSE
     xmm8, xmm9, xmm10, xmm11,
     xmm12, xmm13, xmm14, xmm15;
 
+extern const xRegisterYMM
+    ymm0, ymm1, ymm2, ymm3,
+    ymm4, ymm5, ymm6, ymm7,
+    ymm8, ymm9, ymm10, ymm11,
+    ymm12, ymm13, ymm14, ymm15;
+
 extern const xAddressReg
     rax, rbx, rcx, rdx,
     rsi, rdi, rbp, rsp,
@@ -21,6 +21,7 @@
 
 #include <sys/mman.h>
 #include <signal.h>
+#include <ucontext.h>
 #include <errno.h>
 #include <unistd.h>
 
@@ -32,10 +33,59 @@
 
 extern void SignalExit(int sig);
 
-static const uptr m_pagemask = getpagesize() - 1;
+static const uptr TrapFlag = 0x100; // EFLAGS.TF
+
+// Single steps requested by the last page fault of this thread, run from the SIGTRAP
+// raised once the faulting instruction has completed.
+static DeclareTls(int) s_pending_step_count(0);
+static DeclareTls(PageFaultStep) s_pending_steps[4];
+
+// Bit 1 of the page fault error code is set for writes.
+static bool IsWriteFault(const ucontext_t *uc)
+{
+#if defined(__APPLE__)
+    return (uc->uc_mcontext->__es.__err & 2) != 0;
+#else
+    return (uc->uc_mcontext.gregs[REG_ERR] & 2) != 0;
+#endif
+}
+
+static void SetTrapFlag(ucontext_t *uc, bool set)
+{
+#if defined(__APPLE__) && defined(__x86_64__)
+    auto &flags = uc->uc_mcontext->__ss.__rflags;
+#elif defined(__APPLE__)
+    auto &flags = uc->uc_mcontext->__ss.__eflags;
+#else
+    auto &flags = uc->uc_mcontext.gregs[REG_EFL];
+#endif
+    if (set)
+        flags |= TrapFlag;
+    else
+        flags &= ~TrapFlag;
+}
+
+static void SysSingleStepSignalFilter(int signal, siginfo_t *siginfo, void *context)
+{
+    if (s_pending_step_count == 0) {
+        // Not ours (pxTrap, for instance): do what SIGTRAP would have done anyway.
+        ::signal(SIGTRAP, SIG_DFL);
+        raise(SIGTRAP);
+        return;
+    }
+
+    {
+        Threading::ScopedLock lock(PageFault_Mutex);
+        for (int i = 0; i < s_pending_step_count; ++i)
+            s_pending_steps[i].Rearm(s_pending_steps[i].Param);
+    }
+    s_pending_step_count = 0;
+
+    SetTrapFlag((ucontext_t *)context, false);
+}
 
 // Linux implementation of SIGSEGV handler.  Bind it using sigaction().
-static void SysPageFaultSignalFilter(int signal, siginfo_t *siginfo, void *)
+static void SysPageFaultSignalFilter(int signal, siginfo_t *siginfo, void *context)
 {
     // [TODO] : Add a thread ID filter to the Linux Signal handler here.
     // Rationale: On windows, the __try/__except model allows per-thread specific behavior
@@ -59,12 +109,21 @@ static void SysPageFaultSignalFilter(int signal, siginfo_t *siginfo, void *)
     // so for now we lock this exception code unless someone can fix this better...
     Threading::ScopedLock lock(PageFault_Mutex);
 
-    Source_PageFault->Dispatch(PageFaultInfo((uptr)siginfo->si_addr & ~m_pagemask));
+    // Pass the exact address, like on Windows; memory watchpoints need to know which bytes were hit.
+    Source_PageFault->Dispatch(PageFaultInfo((uptr)siginfo->si_addr, IsWriteFault((ucontext_t *)context)));
 
     // resumes execution right where we left off (re-executes instruction that
     // caused the SIGSEGV).
-    if (Source_PageFault->WasHandled())
+    if (Source_PageFault->WasHandled()) {
+        // An instruction may fault more than once (say, a watched page that also holds
+        // code) before it completes; the steps pile up until the trap.
+        const int steps = Source_PageFault->GetStepCount();
+        for (int i = 0; i < steps && s_pending_step_count < (int)ArraySize(s_pending_steps); ++i)
+            s_pending_steps[s_pending_step_count++] = Source_PageFault->GetStep(i);
+        if (steps)
+            SetTrapFlag((ucontext_t *)context, true);
         return;
+    }
 
     if (!wxThread::IsMain()) {
         pxFailRel(pxsFmt("Unhandled page fault @ 0x%08x", siginfo->si_addr));
@@ -92,6 +151,10 @@ void _platform_InstallSignalHandler()
 #else
     sigaction(SIGSEGV, &sa, NULL);
 #endif
+
+    // Single steps after a page fault (memory watchpoints) end up here.
+    sa.sa_sigaction = SysSingleStepSignalFilter;
+    sigaction(SIGTRAP, &sa, NULL);
 }
 
 static __ri void PageSizeAssertionTest(size_t size)
@@ -57,9 +57,18 @@ EventListener_PageFault::~EventListener_PageFault()
 void SrcType_PageFault::Dispatch(const PageFaultInfo &params)
 {
     m_handled = false;
+    m_stepCount = 0;
     _parent::Dispatch(params);
 }
 
+void SrcType_PageFault::RequestStep(void (*rearm)(uptr), uptr param)
+{
+    pxAssertRel(m_stepCount < (int)ArraySize(m_steps), "Too many single step requests for one page fault");
+    m_steps[m_stepCount].Rearm = rearm;
+    m_steps[m_stepCount].Param = param;
+    ++m_stepCount;
+}
+
 void SrcType_PageFault::_DispatchRaw(ListenerIterator iter, const ListenerIterator &iend, const PageFaultInfo &evt)
 {
     do {
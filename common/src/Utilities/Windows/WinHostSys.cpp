@@ -19,8 +19,34 @@
 
 #include <winnt.h>
 
+static const DWORD TrapFlag = 0x100; // EFLAGS.TF
+
+// Single steps requested by the last page fault of this thread, run from the
+// EXCEPTION_SINGLE_STEP raised once the faulting instruction has completed.
+static DeclareTls(int) s_pending_step_count(0);
+static DeclareTls(PageFaultStep) s_pending_steps[4];
+
+static long DoSysSingleStepExceptionFilter(EXCEPTION_POINTERS *eps)
+{
+    if (s_pending_step_count == 0)
+        return EXCEPTION_CONTINUE_SEARCH;
+
+    {
+        Threading::ScopedLock lock(PageFault_Mutex);
+        for (int i = 0; i < s_pending_step_count; ++i)
+            s_pending_steps[i].Rearm(s_pending_steps[i].Param);
+    }
+    s_pending_step_count = 0;
+
+    eps->ContextRecord->EFlags &= ~TrapFlag;
+    return EXCEPTION_CONTINUE_EXECUTION;
+}
+
 static long DoSysPageFaultExceptionFilter(EXCEPTION_POINTERS *eps)
 {
+    if (eps->ExceptionRecord->ExceptionCode == EXCEPTION_SINGLE_STEP)
+        return DoSysSingleStepExceptionFilter(eps);
+
     if (eps->ExceptionRecord->ExceptionCode != EXCEPTION_ACCESS_VIOLATION)
         return EXCEPTION_CONTINUE_SEARCH;
 
@@ -28,8 +54,21 @@ static long DoSysPageFaultExceptionFilter(EXCEPTION_POINTERS *eps)
     // Source_PageFault is a global variable with its own state information
     // so for now we lock this exception code unless someone can fix this better...
     Threading::ScopedLock lock(PageFault_Mutex);
-    Source_PageFault->Dispatch(PageFaultInfo((uptr)eps->ExceptionRecord->ExceptionInformation[1]));
-    return Source_PageFault->WasHandled() ? EXCEPTION_CONTINUE_EXECUTION : EXCEPTION_CONTINUE_SEARCH;
+
+    // ExceptionInformation[0] is 1 for writes (0 for reads, 8 for DEP violations).
+    const bool write = eps->ExceptionRecord->ExceptionInformation[0] == 1;
+    Source_PageFault->Dispatch(PageFaultInfo((uptr)eps->ExceptionRecord->ExceptionInformation[1], write));
+    if (!Source_PageFault->WasHandled())
+        return EXCEPTION_CONTINUE_SEARCH;
+
+    // An instruction may fault more than once (say, a watched page that also holds code)
+    // before it completes; the steps pile up until the trap.
+    const int steps = Source_PageFault->GetStepCount();
+    for (int i = 0; i < steps && s_pending_step_count < (int)ArraySize(s_pending_steps); ++i)
+        s_pending_steps[s_pending_step_count++] = Source_PageFault->GetStep(i);
+    if (steps)
+        eps->ContextRecord->EFlags |= TrapFlag;
+    return EXCEPTION_CONTINUE_EXECUTION;
 }
 
 long __stdcall SysPageFaultExceptionFilter(EXCEPTION_POINTERS *eps)
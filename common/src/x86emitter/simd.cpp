@@ -768,6 +768,49 @@ __emitinline void xEXTRACTPS(const xRegister32or64 &to, const xRegisterSSE &from
 __emitinline void xEXTRACTPS(const xIndirect32 &dest, const xRegisterSSE &from, u8 imm8) { xOpWrite0F(0x66, 0x173a, from, dest, imm8); }
 
 
+// =====================================================================================================
+//  AVX2 Instructions (VEX.256)
+// =====================================================================================================
+// vvvv is the second operand of the VEX helpers, register 0 encodes "unused" (1111b).
+
+__emitinline void xVMOVDQU(const xRegisterYMM &to, const xIndirectVoid &from) { xOpWriteC5(0xF3, 0x6F, to, ymm0, from); }
+__emitinline void xVMOVDQU(const xIndirectVoid &to, const xRegisterYMM &from) { xOpWriteC5(0xF3, 0x7F, from, ymm0, to); }
+
+// [AVX2] Sign/zero extend 8 bytes or 8 words of memory to 8 dwords
+__emitinline void xVPMOVSXBD(const xRegisterYMM &to, const xIndirectVoid &from) { xOpWriteC4(0x66, 0x38, 0x21, to, ymm0, from); }
+__emitinline void xVPMOVSXWD(const xRegisterYMM &to, const xIndirectVoid &from) { xOpWriteC4(0x66, 0x38, 0x23, to, ymm0, from); }
+__emitinline void xVPMOVZXBD(const xRegisterYMM &to, const xIndirectVoid &from) { xOpWriteC4(0x66, 0x38, 0x31, to, ymm0, from); }
+__emitinline void xVPMOVZXWD(const xRegisterYMM &to, const xIndirectVoid &from) { xOpWriteC4(0x66, 0x38, 0x33, to, ymm0, from); }
+
+// [AVX2] to = from1 with the dwords selected by imm8 taken from from2
+__emitinline void xVPBLENDD(const xRegisterYMM &to, const xRegisterYMM &from1, const xRegisterYMM &from2, u8 imm8)
+{
+    xOpWriteC4(0x66, 0x3A, 0x02, to, from1, from2, 0);
+    xWrite8(imm8);
+}
+
+__emitinline void xVPBLENDD(const xRegisterYMM &to, const xRegisterYMM &from1, const xIndirectVoid &from2, u8 imm8)
+{
+    xOpWriteC4(0x66, 0x3A, 0x02, to, from1, from2, 0, 1);
+    xWrite8(imm8);
+}
+
+// [AVX2] to = from1 with the 128 bit lane imm8[0] replaced by from2
+__emitinline void xVINSERTI128(const xRegisterYMM &to, const xRegisterYMM &from1, const xRegisterSSE &from2, u8 imm8)
+{
+    xOpWriteC4(0x66, 0x3A, 0x38, to, from1, from2, 0);
+    xWrite8(imm8 & 1);
+}
+
+// [AVX] Zero the upper 128 bits of all ymm registers, avoids the AVX to SSE transition penalty
+__emitinline void xVZEROUPPER()
+{
+    xWrite8(0xC5);
+    xWrite8(0xF8);
+    xWrite8(0x77);
+}
+
+
 // =====================================================================================================
 //  Ungrouped Instructions!
 // =====================================================================================================
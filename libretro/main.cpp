@@ -523,6 +523,30 @@ static bool set_hw_render(retro_hw_context_type type)
 	return environ_cb(RETRO_ENVIRONMENT_SET_HW_RENDER, &hw_render);
 }
 
+// EE main memory, for achievements and cheats.  The address is fixed once the VM memory is
+// reserved in retro_init; eeMem itself is only set when the core thread commits the memory,
+// after retro_load_game returns, but frontends don't read it before the first retro_run and
+// that waits for a frame.
+static u8* get_main_ram()
+{
+	return GetVmMemory().EEMemory().GetPtr() + offsetof(EEVM_MemoryAllocMess, Main);
+}
+
+static void set_memory_maps()
+{
+	static retro_memory_descriptor descs[1];
+	memzero(descs);
+	descs[0].flags = RETRO_MEMDESC_SYSTEM_RAM;
+	descs[0].ptr = get_main_ram();
+	descs[0].start = 0x00000000;
+	descs[0].len = Ps2MemSize::MainRam;
+
+	static retro_memory_map mmaps;
+	mmaps.descriptors = descs;
+	mmaps.num_descriptors = ArraySize(descs);
+	environ_cb(RETRO_ENVIRONMENT_SET_MEMORY_MAPS, &mmaps);
+}
+
 bool retro_load_game(const struct retro_game_info* game)
 {
 	if (Options::bios.empty())
@@ -574,6 +598,8 @@ bool retro_load_game(const struct retro_game_info* game)
 		pcsx2->SysExecute(g_Conf->CdvdSource);
 	}
 
+	set_memory_maps();
+
 	//	g_Conf->CurrentGameArgs = "";
 	g_Conf->EmuOptions.GS.FrameLimitEnable = false;
 	//	g_Conf->EmuOptions.GS.SynchronousMTGS = true;
@@ -664,49 +690,86 @@ void retro_run(void)
 	RETRO_PERFORMANCE_STOP(pcsx2_run);
 }
 
+// Fixed for the whole session, so frontends can allocate the buffer once: the VM state
+// (padded for the internals and plugins) followed by the SPU2 state.
 size_t retro_serialize_size(void)
 {
 	return Ps2MemSize::MainRam + Ps2MemSize::Scratch + Ps2MemSize::Hardware +
 		   Ps2MemSize::IopRam + Ps2MemSize::IopHardware +
 		   VU0_PROGSIZE + VU0_MEMSIZE + VU1_PROGSIZE + VU1_MEMSIZE +
-		   _8mb; // + SPU2Savestate::SizeIt();
+		   _8mb + SPU2Savestate::SizeIt();
 }
 
 bool retro_serialize(void* data, size_t size)
 {
+	const size_t spu2_size = SPU2Savestate::SizeIt();
+	if (size < retro_serialize_size())
+		return false;
+
 	GetSysExecutorThread().Rpc_TryInvokeAsync(_Core_Pause, L"AppCoreThread::Pause");
 	GetMTGS().Flush();
 	CoreThread.Pause();
 
-	VmStateBuffer buffer;
-	memSavingState saveme(buffer);
+	bool saved = true;
+	try
+	{
+		// Written in place, the frontend's buffer is the savestate buffer.
+		VmStateFixedBuffer buffer(data, size - spu2_size, L"Libretro Savestate");
+		memSavingState saveme(buffer);
 
-	saveme.FreezeAll();
+		saveme.FreezeAll();
 
-	memcpy(data, buffer.GetPtr(), buffer.GetLength());
-	SPU2Savestate::FreezeIt(*(SPU2Savestate::DataBlock*)((u8*)data + buffer.GetLength()));
+		u8* spu2 = (u8*)data + saveme.GetCurrentPos();
+		SPU2Savestate::FreezeIt(*(SPU2Savestate::DataBlock*)spu2);
+
+		// Identical states should compare equal (netplay, run-ahead), clear the padding.
+		memset(spu2 + spu2_size, 0, size - saveme.GetCurrentPos() - spu2_size);
+	}
+	catch (Exception::OutOfMemory&)
+	{
+		log_cb(RETRO_LOG_ERROR, "Savestate does not fit in %u bytes\n", (uint)size);
+		saved = false;
+	}
 
 	CoreThread.Resume();
-	return true;
+	return saved;
 }
 
 bool retro_unserialize(const void* data, size_t size)
 {
+	// Same size retro_serialize requires, anything shorter isn't one of our states.
+	if (size < retro_serialize_size())
+	{
+		log_cb(RETRO_LOG_ERROR, "Savestate is too small (%u bytes)\n", (uint)size);
+		return false;
+	}
+
 	GetSysExecutorThread().Rpc_TryInvokeAsync(_Core_Pause, L"AppCoreThread::Pause");
 	GetMTGS().Flush();
 	CoreThread.Pause();
 
-	VmStateBuffer buffer;
-	buffer.MakeRoomFor(size);
-	memcpy(buffer.GetPtr(), data, size);
+	bool loaded = false;
+	try
+	{
+		// Loading only reads the buffer, no need for a copy.
+		VmStateFixedBuffer buffer(const_cast<void*>(data), size, L"Libretro Savestate");
+		memLoadingState loadme(buffer);
 
-	memLoadingState loadme(buffer);
+		loadme.FreezeAll();
 
-	loadme.FreezeAll();
-	SPU2Savestate::ThawIt(*(SPU2Savestate::DataBlock*)loadme.GetBlockPtr());
+		loaded = loadme.GetCurrentPos() + SPU2Savestate::SizeIt() <= size;
+		if (loaded)
+			SPU2Savestate::ThawIt(*(SPU2Savestate::DataBlock*)loadme.GetBlockPtr());
+		else
+			log_cb(RETRO_LOG_ERROR, "Savestate is missing the SPU2 state\n");
+	}
+	catch (Exception::BadStream&)
+	{
+		log_cb(RETRO_LOG_ERROR, "Savestate is corrupt or truncated\n");
+	}
 
 	CoreThread.Resume();
-	return true;
+	return loaded;
 }
 
 unsigned retro_get_region(void)
@@ -721,11 +784,17 @@ unsigned retro_api_version()
 
 size_t retro_get_memory_size(unsigned id)
 {
+	if (id == RETRO_MEMORY_SYSTEM_RAM)
+		return Ps2MemSize::MainRam;
+
 	return 0;
 }
 
 void* retro_get_memory_data(unsigned id)
 {
+	if (id == RETRO_MEMORY_SYSTEM_RAM)
+		return get_main_ram();
+
 	return NULL;
 }
 
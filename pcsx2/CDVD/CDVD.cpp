@@ -376,7 +376,10 @@ static __fi void _reloadElfInfo(wxString elfpath)
 	if (!fname)
 		fname = elfpath.AfterLast(':');
 	if (fname.Matches(L"????_???.??*"))
+	{
 		DiscSerial = fname(0, 4) + L"-" + fname(5, 3) + fname(9, 2);
+		DoCDVDsetSerial(DiscSerial);
+	}
 
 	std::unique_ptr<ElfObject> elfptr(loadElf(elfpath));
 
@@ -418,6 +421,7 @@ void cdvdReloadElfInfo(wxString elfoverride)
 			wxString fname = elfpath.AfterLast('\\').AfterLast(':'); // Also catch elf paths which lack a backslash, and only have a colon.
 			wxString fname2 = fname.BeforeFirst(';');
 			DiscSerial = fname2;
+			DoCDVDsetSerial(DiscSerial);
 			Console.SetTitle(DiscSerial);
 			return;
 		}
@@ -538,6 +538,20 @@ void DoCDVDresetDiskTypeCache()
 	diskTypeCached = -1;
 }
 
+// Iso images record and replay their access trace per serial (see InputIsoFile::SetAccessTrace).
+void DoCDVDsetSerial(const wxString& serial)
+{
+	if (m_CurrentSourceType != CDVD_SourceType::Iso || serial.IsEmpty())
+		return;
+
+	wxDirName folder(GetSettingsFolder() + wxDirName(L"traces"));
+
+	if (!folder.Exists() && !folder.Mkdir())
+		return;
+
+	ISOsetAccessTrace(Path::Combine(folder, wxFileName(serial + L".lsntrace")));
+}
+
 ////////////////////////////////////////////////////////
 //
 // CDVD null interface for Run BIOS menu
@@ -27,14 +27,11 @@ const u32 sectors_per_read = 16;
 static_assert(sectors_per_read > 1 && !(sectors_per_read & (sectors_per_read - 1)),
 			  "sectors_per_read must by a power of 2");
 
-struct SectorInfo
-{
-	u32 lsn;
-	// Sectors are read in blocks, not individually
-	u8 data[2352 * sectors_per_read];
-};
+const u32 sector_block_size = 2352 * sectors_per_read;
 
-u32 g_last_sector_block_lsn;
+// End of the prefetched range, the block the reader thread handled last
+static std::atomic<u32> g_last_sector_block_lsn;
+static std::atomic<u32> s_prefetch_depth;
 
 static std::thread s_thread;
 
@@ -42,71 +39,205 @@ static std::mutex s_notify_lock;
 static std::condition_variable s_notify_cv;
 static std::mutex s_request_lock;
 static std::queue<u32> s_request_queue;
-static std::mutex s_cache_lock;
 
 static std::atomic<bool> cdvd_is_open;
 
-//bits: 12 would use 1<<12 entries, or 4096*16 sectors ~ 128MB
-#define CACHE_SIZE 12
+// --------------------------------------------------------------------------------------
+//  Sector block cache
+// --------------------------------------------------------------------------------------
+// Set associative, each set has its own lock so the EE thread fetching a block only ever
+// waits on the reader thread when both touch the same set, and then only for the tag
+// update: blocks are read from the disc straight into a reserved way, outside the lock.
+// A reserved way is invisible to lookups until it's committed, and a reset in between
+// (disc change) bumps the generation and frees the way, so the stale block is dropped.
 
-const u32 CacheSize = 1U << CACHE_SIZE;
-SectorInfo Cache[CacheSize];
+const u32 CacheWays = 4;
+const u32 CacheInvalidLsn = std::numeric_limits<u32>::max();
 
-u32 cdvdSectorHash(u32 lsn)
+struct SectorCacheSet
 {
+	std::mutex lock;
+	u32 lsn[CacheWays];
+	u32 last_use[CacheWays];
+	bool filling[CacheWays];
+	u32 clock;
+};
+
+static std::unique_ptr<SectorCacheSet[]> s_cache_sets;
+static std::unique_ptr<u8[]> s_cache_data;
+static u32 s_cache_set_bits;
+static std::atomic<u32> s_cache_generation;
+
+static std::atomic<u32> s_cache_hits;
+static std::atomic<u32> s_cache_misses;
+static std::atomic<u32> s_cache_prefetched;
+
+// Last cached block cdvdRequestSector woke the reader thread for
+static std::atomic<u32> s_last_nudge(CacheInvalidLsn);
+
+// Prefetch depth, in blocks, doubles with each request that continues a sequential run
+const u32 MinPrefetch = 2;
+const u32 MaxPrefetch = 64;
+
+static void cdvdCacheAllocate(u32 size_mb)
+{
+	// The config is clamped on load, but this is what keeps the set bits below 32.
+	size_mb = std::min(std::max(size_mb, 4u), 1024u);
+
+	const u64 blocks = std::max<u64>((u64)size_mb * _1mb / sector_block_size, CacheWays * 16);
+
+	u32 bits = 0;
+	while ((CacheWays << (bits + 1)) <= blocks)
+		bits++;
+
+	if (s_cache_sets && bits == s_cache_set_bits)
+		return;
+
+	s_cache_set_bits = bits;
+	s_cache_sets.reset(new SectorCacheSet[1U << bits]());
+	s_cache_data.reset(new u8[((size_t)CacheWays << bits) * sector_block_size]);
+}
+
+static SectorCacheSet& cdvdCacheSet(u32 lsn, u32& index)
+{
+	// Fold all the block number bits in, layers and files are far apart on DVD9s
+	u32 block = lsn / sectors_per_read;
 	u32 t = 0;
 
-	int i = 32;
-	u32 m = CacheSize - 1;
+	for (int i = 32; i > 0; i -= s_cache_set_bits)
+	{
+		t ^= block;
+		block >>= s_cache_set_bits;
+	}
+
+	index = t & ((1U << s_cache_set_bits) - 1);
+	return s_cache_sets[index];
+}
 
-	while (i >= 0)
+static u8* cdvdCacheBlock(u32 set, u32 way)
+{
+	return &s_cache_data[((size_t)set * CacheWays + way) * sector_block_size];
+}
+
+// Picks the least recently used way of the set for lsn and hides it from lookups until
+// cdvdCacheCommit.  Returns nullptr when the block is already cached or being filled.
+static u8* cdvdCacheReserve(u32 lsn, u32& set_index, u32& way, u32& generation)
+{
+	SectorCacheSet& set = cdvdCacheSet(lsn, set_index);
+	std::lock_guard<std::mutex> guard(set.lock);
+
+	generation = s_cache_generation.load(std::memory_order_relaxed);
+	way = CacheWays;
+
+	for (u32 i = 0; i < CacheWays; i++)
 	{
-		t ^= lsn & m;
-		lsn >>= CACHE_SIZE;
-		i -= CACHE_SIZE;
+		if (set.lsn[i] == lsn)
+			return nullptr;
+
+		if (set.filling[i])
+			continue;
+
+		if (way == CacheWays || set.lsn[i] == CacheInvalidLsn ||
+			(set.lsn[way] != CacheInvalidLsn && set.last_use[i] < set.last_use[way]))
+			way = i;
 	}
 
-	return t & m;
+	if (way == CacheWays)
+		return nullptr;
+
+	set.lsn[way] = CacheInvalidLsn;
+	set.filling[way] = true;
+
+	return cdvdCacheBlock(set_index, way);
+}
+
+static void cdvdCacheCommit(u32 lsn, u32 set_index, u32 way, u32 generation, bool valid)
+{
+	SectorCacheSet& set = s_cache_sets[set_index];
+	std::lock_guard<std::mutex> guard(set.lock);
+
+	// After a reset the way isn't ours anymore, it may already be reserved again.
+	if (generation != s_cache_generation.load(std::memory_order_relaxed))
+		return;
+
+	set.filling[way] = false;
+
+	if (valid)
+	{
+		set.lsn[way] = lsn;
+		set.last_use[way] = ++set.clock;
+	}
 }
 
 void cdvdCacheUpdate(u32 lsn, u8* data)
 {
-	std::lock_guard<std::mutex> guard(s_cache_lock);
-	u32 entry = cdvdSectorHash(lsn);
+	u32 set, way, generation;
 
-	memcpy(Cache[entry].data, data, 2352 * sectors_per_read);
-	Cache[entry].lsn = lsn;
+	if (u8* block = cdvdCacheReserve(lsn, set, way, generation))
+	{
+		memcpy(block, data, sector_block_size);
+		cdvdCacheCommit(lsn, set, way, generation, true);
+	}
 }
 
 bool cdvdCacheCheck(u32 lsn)
 {
-	std::lock_guard<std::mutex> guard(s_cache_lock);
-	u32 entry = cdvdSectorHash(lsn);
+	u32 index;
+	SectorCacheSet& set = cdvdCacheSet(lsn, index);
+	std::lock_guard<std::mutex> guard(set.lock);
+
+	for (u32 i = 0; i < CacheWays; i++)
+	{
+		if (set.lsn[i] == lsn)
+			return true;
+	}
 
-	return Cache[entry].lsn == lsn;
+	return false;
 }
 
 bool cdvdCacheFetch(u32 lsn, u8* data)
 {
-	std::lock_guard<std::mutex> guard(s_cache_lock);
-	u32 entry = cdvdSectorHash(lsn);
+	u32 index;
+	SectorCacheSet& set = cdvdCacheSet(lsn, index);
+	std::lock_guard<std::mutex> guard(set.lock);
 
-	if (Cache[entry].lsn == lsn)
+	for (u32 i = 0; i < CacheWays; i++)
 	{
-		memcpy(data, Cache[entry].data, 2352 * sectors_per_read);
-		return true;
+		if (set.lsn[i] == lsn)
+		{
+			set.last_use[i] = ++set.clock;
+			memcpy(data, cdvdCacheBlock(index, i), sector_block_size);
+			s_cache_hits.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
 	}
-	//printf("NOT IN CACHE\n");
+
+	s_cache_misses.fetch_add(1, std::memory_order_relaxed);
 	return false;
 }
 
 void cdvdCacheReset()
 {
-	std::lock_guard<std::mutex> guard(s_cache_lock);
-	for (u32 i = 0; i < CacheSize; i++)
+	if (!s_cache_sets)
+		return;
+
+	s_cache_generation.fetch_add(1, std::memory_order_relaxed);
+
+	for (u32 i = 0; i < (1U << s_cache_set_bits); i++)
 	{
-		Cache[i].lsn = std::numeric_limits<u32>::max();
+		SectorCacheSet& set = s_cache_sets[i];
+		std::lock_guard<std::mutex> guard(set.lock);
+
+		for (u32 way = 0; way < CacheWays; way++)
+		{
+			set.lsn[way] = CacheInvalidLsn;
+			set.last_use[way] = 0;
+			set.filling[way] = false;
+		}
+		set.clock = 0;
 	}
+
+	s_last_nudge = CacheInvalidLsn;
 }
 
 bool cdvdReadBlockOfSectors(u32 sector, u8* data)
@@ -176,8 +307,9 @@ bool cdvdUpdateDiscStatus()
 
 void cdvdThread()
 {
-	u8 buffer[2352 * sectors_per_read];
 	u32 prefetches_left = 0;
+	u32 last_request_lsn = CacheInvalidLsn;
+	u32 sequential_run = 0;
 
 	printf(" * CDVD: IO thread started...\n");
 	std::unique_lock<std::mutex> guard(s_notify_lock);
@@ -218,25 +350,47 @@ void cdvdThread()
 			if (prefetches_left == 0)
 				continue;
 
-			--prefetches_left;
+			request_lsn = g_last_sector_block_lsn + sectors_per_read;
 
-			u32 next_prefetch_lsn = g_last_sector_block_lsn + sectors_per_read;
-			request_lsn = next_prefetch_lsn;
+			if (request_lsn >= src->GetSectorCount())
+			{
+				prefetches_left = 0;
+				continue;
+			}
+		}
+		else
+		{
+			// A run continues when the request lands within what was prefetched for it
+			const u32 prefetch_end = g_last_sector_block_lsn + sectors_per_read;
+			const bool sequential = last_request_lsn != CacheInvalidLsn &&
+									request_lsn >= last_request_lsn && request_lsn <= prefetch_end;
+
+			sequential_run = sequential ? std::min(sequential_run + 1, 31U) : 0;
+			last_request_lsn = request_lsn;
+			s_prefetch_depth = std::min(MinPrefetch << std::min(sequential_run, 5U), MaxPrefetch);
 		}
 
-		// Handle request
-		if (!cdvdCacheCheck(request_lsn))
+		// Handle request, blocks already cached (or being read by the EE thread) are skipped
+		// without using up the prefetch depth.
+		u32 set, way, generation;
+
+		if (u8* block = cdvdCacheReserve(request_lsn, set, way, generation))
 		{
-			if (cdvdReadBlockOfSectors(request_lsn, buffer))
-			{
-				cdvdCacheUpdate(request_lsn, buffer);
-			}
-			else
+			const bool ok = cdvdReadBlockOfSectors(request_lsn, block);
+			cdvdCacheCommit(request_lsn, set, way, generation, ok);
+
+			if (!ok)
 			{
 				// If the read fails, further reads are likely to fail too.
 				prefetches_left = 0;
 				continue;
 			}
+
+			if (!handling_request)
+			{
+				s_cache_prefetched.fetch_add(1, std::memory_order_relaxed);
+				--prefetches_left;
+			}
 		}
 
 		g_last_sector_block_lsn = request_lsn;
@@ -252,9 +406,8 @@ void cdvdThread()
 		}
 		else
 		{
-			const u32 max_prefetches = 16;
 			u32 remaining = src->GetSectorCount() - next_prefetch_lsn;
-			prefetches_left = std::min((remaining + sectors_per_read - 1) / sectors_per_read, max_prefetches);
+			prefetches_left = std::min((remaining + sectors_per_read - 1) / sectors_per_read, s_prefetch_depth.load());
 		}
 	}
 	printf(" * CDVD: IO thread finished.\n");
@@ -264,6 +417,14 @@ bool cdvdStartThread()
 {
 	if (cdvd_is_open == false)
 	{
+		cdvdCacheAllocate(EmuConfig.CdvdDiscCacheSize);
+
+		s_cache_hits = 0;
+		s_cache_misses = 0;
+		s_cache_prefetched = 0;
+		s_prefetch_depth = MinPrefetch;
+		g_last_sector_block_lsn = 0;
+
 		cdvd_is_open = true;
 		try
 		{
@@ -286,7 +447,12 @@ void cdvdStopThread()
 	cdvd_is_open = false;
 	s_notify_cv.notify_one();
 	if (s_thread.joinable())
+	{
 		s_thread.join();
+
+		printf(" * CDVD: Cache: %u hits, %u misses, %u blocks prefetched\n",
+			   s_cache_hits.load(), s_cache_misses.load(), s_cache_prefetched.load());
+	}
 }
 
 void cdvdRequestSector(u32 sector, s32 mode)
@@ -298,7 +464,17 @@ void cdvdRequestSector(u32 sector, s32 mode)
 	sector &= ~(sectors_per_read - 1);
 
 	if (cdvdCacheCheck(sector))
-		return;
+	{
+		// Reads that keep hitting prefetched blocks never reach the reader thread, so
+		// nudge it once per block when they get within half the depth of the end.
+		const u32 end = g_last_sector_block_lsn;
+		const u32 half = (s_prefetch_depth / 2) * sectors_per_read;
+
+		if (sector == s_last_nudge || sector > end || sector + half < end)
+			return;
+
+		s_last_nudge = sector;
+	}
 
 	{
 		std::lock_guard<std::mutex> guard(s_request_lock);
@@ -82,6 +82,11 @@ s32 CALLBACK ISOopen(const char* pTitle)
 	return 0;
 }
 
+void ISOsetAccessTrace(const wxString& filename)
+{
+	iso.SetAccessTrace(filename);
+}
+
 s32 CALLBACK ISOreadSubQ(u32 lsn, cdvdSubQ* subq)
 {
 	// fake it
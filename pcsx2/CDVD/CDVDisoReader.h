@@ -21,4 +21,6 @@
 #include "IopCommon.h"
 #include "IsoFileFormats.h"
 
+extern void ISOsetAccessTrace(const wxString& filename);
+
 #endif
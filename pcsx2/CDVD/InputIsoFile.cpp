@@ -54,6 +54,12 @@ int InputIsoFile::ReadSync(u8* dst, uint lsn)
 	return m_reader->ReadSync(dst + m_blockofs, lsn, 1);
 }
 
+// Reads raw image blocks, laid out as in the read buffer.
+int InputIsoFile::ReadBlocks(u8* dst, uint lsn, uint count)
+{
+	return m_reader->ReadSync(dst, lsn, count);
+}
+
 void InputIsoFile::BeginRead2(uint lsn)
 {
 	m_current_lsn = lsn;
@@ -66,12 +72,27 @@ void InputIsoFile::BeginRead2(uint lsn)
 		return;
 	}
 
+	m_trace.Record(lsn);
+
 	if (lsn >= m_read_lsn && lsn < (m_read_lsn + m_read_count))
 	{
 		// Already buffered
 		return;
 	}
 
+	m_reads++;
+
+	if (m_prefetcher)
+	{
+		if (uint count = m_prefetcher->Fetch(m_readbuffer, lsn, MaxReadUnit))
+		{
+			m_read_lsn = lsn;
+			m_read_count = count;
+			m_prefetched_reads++;
+			return;
+		}
+	}
+
 	m_read_lsn = lsn;
 	m_read_count = 1;
 
@@ -185,6 +206,12 @@ void InputIsoFile::_init()
 	m_current_lsn = -1;
 	m_read_lsn = -1;
 	m_reader = NULL;
+
+	m_trace.Clear();
+	m_trace_filename.clear();
+	m_trace_loaded_runs = 0;
+	m_reads = 0;
+	m_prefetched_reads = 0;
 }
 
 // Tests the specified filename to see if it is a supported ISO type.  This function typically
@@ -202,7 +229,7 @@ bool InputIsoFile::Test(const wxString& srcfile)
 	return Open(srcfile, true);
 }
 
-bool InputIsoFile::Open(const wxString& srcfile, bool testOnly)
+bool InputIsoFile::Open(const wxString& srcfile, bool testOnly, bool quiet)
 {
 	Close();
 	m_filename = srcfile;
@@ -270,6 +297,9 @@ bool InputIsoFile::Open(const wxString& srcfile, bool testOnly)
 
 	m_blocks = m_reader->GetBlockCount();
 
+	if (quiet)
+		return true;
+
 	Console.WriteLn(Color_StrongBlue, L"isoFile open ok: %s", WX_STR(m_filename));
 
 	ConsoleIndentScope indent;
@@ -284,8 +314,44 @@ bool InputIsoFile::Open(const wxString& srcfile, bool testOnly)
 	return true;
 }
 
+// Keys the access trace on the game serial: the trace of the last boot (if any) drives
+// the prefetcher, and the one recorded since the image was opened replaces it on Close.
+void InputIsoFile::SetAccessTrace(const wxString& filename)
+{
+	if (!IsOpened() || filename == m_trace_filename)
+		return;
+
+	m_prefetcher.reset();
+	m_trace_filename = filename;
+	m_trace_loaded_runs = 0;
+
+	IsoAccessTrace trace;
+
+	if (!trace.Load(filename, m_blocks))
+		return;
+
+	m_trace_loaded_runs = trace.GetRunCount();
+
+	DevCon.WriteLn(L"isoFile: prefetching from access trace (%u runs): %s", m_trace_loaded_runs, WX_STR(filename));
+
+	m_prefetcher.reset(new IsoPrefetcher(m_filename, trace.GetRuns(), m_blocks, m_blocksize, m_current_lsn));
+}
+
 void InputIsoFile::Close()
 {
+	if (m_prefetcher)
+	{
+		const IsoPrefetcher::Stats stats = m_prefetcher->GetStats();
+		m_prefetcher.reset();
+
+		Console.WriteLn("isoFile: %u of %u reads served from prefetched data (%u sectors prefetched, %u used)",
+						m_prefetched_reads, m_reads, stats.sectors_prefetched, stats.sectors_served);
+	}
+
+	// A shorter trace is a session that ended early, keep the one that covers more
+	if (!m_trace_filename.IsEmpty() && m_trace.GetRunCount() > m_trace_loaded_runs)
+		m_trace.Save(m_trace_filename, m_blocks);
+
 	delete m_reader;
 	m_reader = NULL;
 
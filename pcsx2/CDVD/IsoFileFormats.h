@@ -19,6 +19,7 @@
 #include "wx/wfstream.h"
 #include "AsyncFileReader.h"
 #include "CompressedFileReader.h"
+#include "IsoPrefetcher.h"
 #include <memory>
 
 enum isoType
@@ -65,6 +66,15 @@ protected:
 	uint m_read_count;
 	u8 m_readbuffer[MaxReadUnit * CD_FRAMESIZE_RAW];
 
+	// Access trace of this session, and the prefetcher replaying the one from the last
+	// boot of the same serial (see SetAccessTrace).
+	IsoAccessTrace m_trace;
+	wxString m_trace_filename;
+	uint m_trace_loaded_runs;
+	std::unique_ptr<IsoPrefetcher> m_prefetcher;
+	uint m_reads;
+	uint m_prefetched_reads;
+
 public:
 	InputIsoFile();
 	virtual ~InputIsoFile();
@@ -81,11 +91,14 @@ public:
 	}
 
 	bool Test(const wxString& srcfile);
-	bool Open(const wxString& srcfile, bool testOnly = false);
+	bool Open(const wxString& srcfile, bool testOnly = false, bool quiet = false);
 	void Close();
 	bool Detect(bool readType = true);
 
 	int ReadSync(u8* dst, uint lsn);
+	int ReadBlocks(u8* dst, uint lsn, uint count);
+
+	void SetAccessTrace(const wxString& filename);
 
 	void BeginRead2(uint lsn);
 	int FinishRead3(u8* dest, uint mode);
@@ -0,0 +1,438 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "IsoFileFormats.h"
+#include "IsoPrefetcher.h"
+
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+
+#ifdef __POSIX__
+#include <zlib.h>
+#else
+#include <zlib/zlib.h>
+#endif
+
+// --------------------------------------------------------------------------------------
+//  IsoAccessTrace
+// --------------------------------------------------------------------------------------
+
+void IsoAccessTrace::Record(u32 lsn)
+{
+	if (!m_runs.empty())
+	{
+		IsoAccessRun& last = m_runs.back();
+
+		if (lsn >= last.lsn && lsn < last.lsn + last.count)
+			return;
+
+		if (lsn == last.lsn + last.count)
+		{
+			last.count++;
+			return;
+		}
+	}
+
+	if (m_runs.size() < MaxRuns)
+		m_runs.push_back({lsn, 1});
+}
+
+struct IsoAccessTraceHeader
+{
+	u32 magic;
+	u32 version;
+	u32 blocks;
+	u32 runs;
+	u32 size;
+	u32 compressed_size;
+};
+
+static void WriteVarint(std::vector<u8>& out, u32 value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	out.push_back(value);
+}
+
+static bool ReadVarint(const u8*& in, const u8* end, u32& value)
+{
+	value = 0;
+
+	for (int shift = 0; shift < 35 && in < end; shift += 7)
+	{
+		u8 b = *in++;
+		value |= (u32)(b & 0x7f) << shift;
+		if (!(b & 0x80))
+			return true;
+	}
+
+	return false;
+}
+
+bool IsoAccessTrace::Load(const wxString& filename, u32 blocks)
+{
+	m_runs.clear();
+
+	if (!wxFileExists(filename))
+		return false;
+
+	wxFFile file(filename, L"rb");
+	IsoAccessTraceHeader header;
+
+	if (!file.IsOpened() || file.Read(&header, sizeof(header)) != sizeof(header))
+		return false;
+
+	if (header.magic != FileMagic || header.version != FileVersion)
+	{
+		Console.Warning(L"isoFile: ignoring access trace with unknown format: %s", WX_STR(filename));
+		return false;
+	}
+
+	// Another dump of the same game, the sectors won't line up
+	if (header.blocks != blocks || header.runs > MaxRuns)
+		return false;
+
+	std::vector<u8> compressed(header.compressed_size);
+	std::vector<u8> payload(header.size);
+	uLongf size = header.size;
+
+	if (file.Read(compressed.data(), compressed.size()) != compressed.size() ||
+		uncompress(payload.data(), &size, compressed.data(), compressed.size()) != Z_OK || size != header.size)
+	{
+		Console.Warning(L"isoFile: access trace is corrupt: %s", WX_STR(filename));
+		return false;
+	}
+
+	const u8* in = payload.data();
+	const u8* end = in + payload.size();
+	u32 next = 0;
+
+	m_runs.reserve(header.runs);
+
+	for (u32 i = 0; i < header.runs; i++)
+	{
+		u32 delta, count;
+
+		if (!ReadVarint(in, end, delta) || !ReadVarint(in, end, count))
+			break;
+
+		u32 lsn = next + (u32)((s32)(delta >> 1) ^ -(s32)(delta & 1));
+
+		if (count == 0 || lsn >= blocks || count > blocks - lsn)
+			break;
+
+		m_runs.push_back({lsn, count});
+		next = lsn + count;
+	}
+
+	if (m_runs.size() != header.runs)
+	{
+		Console.Warning(L"isoFile: access trace is corrupt: %s", WX_STR(filename));
+		m_runs.clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool IsoAccessTrace::Save(const wxString& filename, u32 blocks) const
+{
+	std::vector<u8> payload;
+	u32 next = 0;
+
+	payload.reserve(m_runs.size() * 4);
+
+	for (const IsoAccessRun& run : m_runs)
+	{
+		s32 delta = (s32)(run.lsn - next);
+		WriteVarint(payload, ((u32)delta << 1) ^ (u32)(delta >> 31));
+		WriteVarint(payload, run.count);
+		next = run.lsn + run.count;
+	}
+
+	uLongf compressed_size = compressBound(payload.size());
+	std::vector<u8> compressed(compressed_size);
+
+	if (compress2(compressed.data(), &compressed_size, payload.data(), payload.size(), Z_BEST_COMPRESSION) != Z_OK)
+		return false;
+
+	IsoAccessTraceHeader header;
+	header.magic = FileMagic;
+	header.version = FileVersion;
+	header.blocks = blocks;
+	header.runs = m_runs.size();
+	header.size = payload.size();
+	header.compressed_size = compressed_size;
+
+	// Write aside and rename, a crash mid-write must not leave a truncated trace behind
+	const wxString temp = filename + L".tmp";
+
+	{
+		wxFFile file(temp, L"wb");
+
+		if (!file.IsOpened() ||
+			file.Write(&header, sizeof(header)) != sizeof(header) ||
+			file.Write(compressed.data(), compressed_size) != compressed_size)
+		{
+			Console.Warning(L"isoFile: unable to write access trace: %s", WX_STR(filename));
+			return false;
+		}
+	}
+
+	return wxRenameFile(temp, filename, true);
+}
+
+// --------------------------------------------------------------------------------------
+//  IsoPrefetcher
+// --------------------------------------------------------------------------------------
+
+IsoPrefetcher::IsoPrefetcher(const wxString& filename, const std::vector<IsoAccessRun>& runs, u32 blocks, u32 blocksize, u32 start_lsn)
+	: m_filename(filename)
+	, m_runs(runs)
+	, m_blocks(blocks)
+	, m_blocksize(blocksize)
+	, m_exit(false)
+	, m_cached_bytes(0)
+	, m_next_run(0)
+	, m_next_offset(0)
+	, m_next_seq(0)
+	, m_position(0)
+{
+	memzero(m_stats);
+
+	// The trace is keyed by serial, which is only known once the game ELF is found, so
+	// the game is usually a few reads into it already.
+	if (start_lsn < m_blocks)
+		Resync(start_lsn);
+
+	m_thread = std::thread(&IsoPrefetcher::ThreadProc, this);
+}
+
+IsoPrefetcher::~IsoPrefetcher()
+{
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		m_exit = true;
+	}
+
+	m_cv.notify_one();
+	m_thread.join();
+}
+
+// Called with m_lock held.  Moves the game position to the first run containing lsn,
+// searching forward from the current position first.
+void IsoPrefetcher::Resync(u32 lsn)
+{
+	const uint runs = m_runs.size();
+	uint found = runs;
+
+	for (uint i = m_position; i < std::min(runs, m_position + LookaheadRuns * 4); i++)
+	{
+		if (lsn >= m_runs[i].lsn && lsn < m_runs[i].lsn + m_runs[i].count)
+		{
+			found = i;
+			break;
+		}
+	}
+
+	if (found == runs)
+	{
+		for (uint i = 0; i < m_position && i < runs; i++)
+		{
+			if (lsn >= m_runs[i].lsn && lsn < m_runs[i].lsn + m_runs[i].count)
+			{
+				found = i;
+				break;
+			}
+		}
+	}
+
+	if (found == runs)
+		return;
+
+	m_position = found;
+
+	if (m_next_run < found || (m_next_run == found && m_next_offset < lsn - m_runs[found].lsn))
+	{
+		m_next_run = found;
+		m_next_offset = lsn - m_runs[found].lsn;
+	}
+	else if (m_next_run > found + LookaheadRuns)
+	{
+		// Jumped back (typically a reload of a level), start over from there
+		m_next_run = found;
+		m_next_offset = lsn - m_runs[found].lsn;
+	}
+
+	EvictBefore(found, 0);
+	m_cv.notify_one();
+}
+
+// Called with m_lock held.  Drops chunks of runs before run, or issued before seq.
+void IsoPrefetcher::EvictBefore(uint run, u64 seq)
+{
+	for (auto it = m_chunks.begin(); it != m_chunks.end();)
+	{
+		if (it->second->run < run || it->second->seq < seq)
+		{
+			m_cached_bytes -= (size_t)it->second->count * m_blocksize;
+			it = m_chunks.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+uint IsoPrefetcher::Fetch(u8* dst, u32 lsn, uint maxcount)
+{
+	std::shared_ptr<Chunk> chunk;
+
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+
+		auto it = m_chunks.upper_bound(lsn);
+
+		if (it != m_chunks.begin())
+		{
+			--it;
+
+			if (lsn < it->second->lsn + it->second->count)
+				chunk = it->second;
+		}
+
+		if (!chunk)
+		{
+			m_stats.misses++;
+			Resync(lsn);
+			return 0;
+		}
+
+		// Keep a couple of chunks behind, games re-read the last sectors of a file often enough
+		if (chunk->run > m_position)
+			m_position = chunk->run;
+
+		if (chunk->seq > 2)
+			EvictBefore(0, chunk->seq - 2);
+
+		m_cv.notify_one();
+	}
+
+	// Chunks are immutable once published, the copy doesn't need the lock
+	const uint offset = lsn - chunk->lsn;
+	const uint count = std::min(maxcount, chunk->count - offset);
+
+	memcpy(dst, chunk->data.get() + (size_t)offset * m_blocksize, (size_t)count * m_blocksize);
+
+	std::lock_guard<std::mutex> guard(m_lock);
+	m_stats.hits++;
+	m_stats.sectors_served += count;
+
+	return count;
+}
+
+IsoPrefetcher::Stats IsoPrefetcher::GetStats()
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+	return m_stats;
+}
+
+void IsoPrefetcher::ThreadProc()
+{
+	InputIsoFile iso;
+
+	try
+	{
+		iso.Open(m_filename, false, true);
+	}
+	catch (BaseException& ex)
+	{
+		Console.Warning(L"isoFile: prefetcher failed to open the image: %s", WX_STR(ex.FormatDiagnosticMessage()));
+		return;
+	}
+
+	if (iso.GetBlockCount() != m_blocks)
+		return;
+
+	const size_t chunk_bytes = (size_t)ChunkSectors * m_blocksize;
+
+	std::unique_lock<std::mutex> guard(m_lock);
+
+	while (!m_exit)
+	{
+		if (m_next_run >= m_runs.size() ||
+			m_next_run > m_position + LookaheadRuns ||
+			m_cached_bytes + chunk_bytes > BudgetBytes)
+		{
+			m_cv.wait(guard);
+			continue;
+		}
+
+		const IsoAccessRun& run = m_runs[m_next_run];
+		const uint run_index = m_next_run;
+		const u32 lsn = run.lsn + m_next_offset;
+		const u32 count = std::min<u32>(ChunkSectors, run.count - m_next_offset);
+
+		m_next_offset += count;
+
+		if (m_next_offset >= run.count)
+		{
+			m_next_run++;
+			m_next_offset = 0;
+		}
+
+		// Runs revisit the same sectors (directory records, the ELF), don't read them twice
+		auto it = m_chunks.upper_bound(lsn);
+		if (it != m_chunks.begin() && lsn + count <= std::prev(it)->second->lsn + std::prev(it)->second->count && lsn >= std::prev(it)->second->lsn)
+			continue;
+
+		std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>();
+		chunk->lsn = lsn;
+		chunk->count = count;
+		chunk->run = run_index;
+		chunk->seq = m_next_seq++;
+		chunk->data.reset(new u8[(size_t)count * m_blocksize]);
+
+		// Chunks are sized for the budget up front so the window can't overshoot it
+		m_cached_bytes += (size_t)count * m_blocksize;
+
+		guard.unlock();
+		const int ret = iso.ReadBlocks(chunk->data.get(), lsn, count);
+		guard.lock();
+
+		if (ret < 0 || run_index < m_position)
+		{
+			m_cached_bytes -= (size_t)count * m_blocksize;
+			continue;
+		}
+
+		// A chunk overlapping the start of this one (the game jumped into the middle of a
+		// run) would hide it from lookups, replace it.
+		auto old = m_chunks.find(lsn);
+		if (old != m_chunks.end())
+		{
+			m_cached_bytes -= (size_t)old->second->count * m_blocksize;
+			m_chunks.erase(old);
+		}
+
+		m_chunks[lsn] = chunk;
+		m_stats.sectors_prefetched += count;
+	}
+}
@@ -0,0 +1,139 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --------------------------------------------------------------------------------------
+//  IsoAccessTrace
+// --------------------------------------------------------------------------------------
+// Order in which a game reads the disc, as runs of consecutive sectors.  Boot and level
+// loads read the same sectors in the same order every time, so the trace recorded on one
+// boot predicts the reads of the next one.
+//
+// On disk the trace is a small header followed by a zlib compressed payload of varints
+// (zigzag delta from the end of the previous run, then the run length).  The header
+// carries the image block count so that a trace is never replayed on another dump of
+// the same serial.
+//
+struct IsoAccessRun
+{
+	u32 lsn;
+	u32 count;
+};
+
+class IsoAccessTrace
+{
+public:
+	static const u32 FileMagic = 0x544e534c; // "LSNT"
+	static const u32 FileVersion = 1;
+
+	// Enough for the boot and the first few level loads, the tail is the least reliable part anyway.
+	static const uint MaxRuns = 32768;
+
+protected:
+	std::vector<IsoAccessRun> m_runs;
+
+public:
+	void Clear() { m_runs.clear(); }
+	void Record(u32 lsn);
+
+	const std::vector<IsoAccessRun>& GetRuns() const { return m_runs; }
+	uint GetRunCount() const { return m_runs.size(); }
+
+	bool Load(const wxString& filename, u32 blocks);
+	bool Save(const wxString& filename, u32 blocks) const;
+};
+
+// --------------------------------------------------------------------------------------
+//  IsoPrefetcher
+// --------------------------------------------------------------------------------------
+// Replays an access trace on a worker thread with its own reader, keeping a bounded window
+// of chunks ahead of the game's position in the trace.  The game's reads move the position
+// forward (and resync it when they diverge), which evicts the chunks left behind.
+//
+// Chunks hold raw image blocks (m_blocksize each), in the same layout as the InputIsoFile
+// read buffer.
+//
+class IsoPrefetcher
+{
+	DeclareNoncopyableObject(IsoPrefetcher);
+
+public:
+	static const uint ChunkSectors = 128;
+	static const uint LookaheadRuns = 256;
+	static const size_t BudgetBytes = 32 * _1mb;
+
+	struct Stats
+	{
+		uint hits;
+		uint misses;
+		uint sectors_prefetched;
+		uint sectors_served;
+	};
+
+protected:
+	struct Chunk
+	{
+		u32 lsn;
+		u32 count;
+		uint run;
+		u64 seq;
+		std::unique_ptr<u8[]> data;
+	};
+
+	wxString m_filename;
+	std::vector<IsoAccessRun> m_runs;
+	u32 m_blocks;
+	u32 m_blocksize;
+
+	std::thread m_thread;
+	std::mutex m_lock;
+	std::condition_variable m_cv;
+	bool m_exit;
+
+	// Chunks by start lsn, and the worker's cursor in the trace
+	std::map<u32, std::shared_ptr<Chunk>> m_chunks;
+	size_t m_cached_bytes;
+	uint m_next_run;
+	u32 m_next_offset;
+	u64 m_next_seq;
+
+	// Game position in the trace
+	uint m_position;
+
+	Stats m_stats;
+
+public:
+	IsoPrefetcher(const wxString& filename, const std::vector<IsoAccessRun>& runs, u32 blocks, u32 blocksize, u32 start_lsn);
+	virtual ~IsoPrefetcher();
+
+	// Copies up to maxcount blocks starting at lsn, returns the number copied (0 on a miss).
+	uint Fetch(u8* dst, u32 lsn, uint maxcount);
+
+	Stats GetStats();
+
+protected:
+	void ThreadProc();
+	void Resync(u32 lsn);
+	void EvictBefore(uint run, u64 seq);
+};
@@ -454,6 +454,8 @@ struct Pcsx2Config
 			EnablePatches		:1,		// enables patch detection and application
 			EnableCheats		:1,		// enables cheat detection and application
 			EnableIPC		    :1,		// enables inter-process communication 
+			EnableRamExport		:1,		// exports EE/IOP main memory as a shared memory object (on reset)
+			EnableRewind		:1,		// keeps recent states in memory for rewinding
 			EnableWideScreenPatches		:1,
 #ifndef DISABLE_RECORDING
 			EnableRecordingTools :1,
@@ -461,9 +463,13 @@ struct Pcsx2Config
 		// when enabled uses BOOT2 injection, skipping sony bios splashes
 			UseBOOT2Injection	:1,
 			BackupSavestate		:1,
+		// saves only the main memory pages changed since the last full savestate
+			IncrementalSavestates :1,
 		// enables simulated ejection of memory cards when loading savestates
 			McdEnableEjection	:1,
 			McdFolderAutoManage	:1,
+		// index folder memory cards from the cached _pcsx2_index and open save files on first access
+			McdFolderLazyIndex	:1,
 
 			MultitapPort0_Enabled:1,
 			MultitapPort1_Enabled:1,
@@ -483,6 +489,10 @@ struct Pcsx2Config
 
 	wxFileName			BiosFilename;
 
+	u32					CdvdDiscCacheSize;	// physical disc sector cache, in MB (4 to 1024)
+	u32					RewindInterval;		// frames between two rewind states
+	u32					RewindBufferSize;	// rewind history budget, in MB
+
 	Pcsx2Config();
 	void LoadSave( IniInterface& ini );
 
@@ -503,7 +513,10 @@ struct Pcsx2Config
 			OpEqu( Gamefixes )	&&
 			OpEqu( Profiler )	&&
 			OpEqu( Trace )		&&
-			OpEqu( BiosFilename );
+			OpEqu( BiosFilename )	&&
+			OpEqu( CdvdDiscCacheSize )	&&
+			OpEqu( RewindInterval )	&&
+			OpEqu( RewindBufferSize );
 	}
 
 	bool operator !=( const Pcsx2Config& right ) const
@@ -31,6 +31,7 @@
 #include "ps2/HwInternal.h"
 
 #include "Sio.h"
+#include "SharedMemoryExport.h"
 
 #ifndef DISABLE_RECORDING
 #	include "Recording/InputRecordingControls.h"
@@ -532,6 +533,8 @@ static __fi void VSyncEnd(u32 sCycle)
 
 	g_FrameCount++;
 
+	SharedMemoryExport::OnVsync(g_FrameCount);
+	GetCoreThread().VsyncEndInThread();
 
 
 	hwIntcIrq(INTC_VBLANK_E);  // HW Irq
@@ -20,6 +20,7 @@
 #include <cstdio>
 #include "../R5900.h"
 #include "../System.h"
+#include "../Memory.h"
 
 std::vector<BreakPoint> CBreakPoints::breakPoints_;
 u32 CBreakPoints::breakSkipFirstAt_ = 0;
@@ -395,6 +396,8 @@ void CBreakPoints::Update(u32 addr)
 		resume = true;
 	}
 
+	mmap_UpdateWatchpoints();
+
 //	if (addr != 0)
 //		Cpu->Clear(addr-4,8);
 //	else
@@ -141,6 +141,8 @@ std::map<u32,DisassemblyEntry*>::iterator findDisassemblyEntry(std::map<u32,Disa
 
 void DisassemblyManager::analyze(u32 address, u32 size = 1024)
 {
+	checkSymbols();
+
 	if (!cpu->isAlive())
 		return;
 
@@ -220,6 +222,8 @@ void DisassemblyManager::analyze(u32 address, u32 size = 1024)
 
 std::vector<BranchLine> DisassemblyManager::getBranchLines(u32 start, u32 size)
 {
+	checkSymbols();
+
 	std::vector<BranchLine> result;
 	
 	auto it = findDisassemblyEntry(entries,start,false);
@@ -237,6 +241,8 @@ std::vector<BranchLine> DisassemblyManager::getBranchLines(u32 start, u32 size)
 
 void DisassemblyManager::getLine(u32 address, bool insertSymbols, DisassemblyLineInfo& dest)
 {
+	checkSymbols();
+
 	auto it = findDisassemblyEntry(entries,address,false);
 	if (it == entries.end())
 	{
@@ -269,6 +275,8 @@ void DisassemblyManager::getLine(u32 address, bool insertSymbols, DisassemblyLin
 
 u32 DisassemblyManager::getStartAddress(u32 address)
 {
+	checkSymbols();
+
 	auto it = findDisassemblyEntry(entries,address,false);
 	if (it == entries.end())
 	{
@@ -285,6 +293,8 @@ u32 DisassemblyManager::getStartAddress(u32 address)
 
 u32 DisassemblyManager::getNthPreviousAddress(u32 address, int n)
 {
+	checkSymbols();
+
 	while (cpu->isValidAddress(address))
 	{
 		auto it = findDisassemblyEntry(entries,address,false);
@@ -311,6 +321,8 @@ u32 DisassemblyManager::getNthPreviousAddress(u32 address, int n)
 
 u32 DisassemblyManager::getNthNextAddress(u32 address, int n)
 {
+	checkSymbols();
+
 	while (cpu->isValidAddress(address))
 	{
 		auto it = findDisassemblyEntry(entries,address,false);
@@ -336,6 +348,18 @@ u32 DisassemblyManager::getNthNextAddress(u32 address, int n)
 	return address+n*4;
 }
 
+// The entries are built from the symbol map, so anything cached from an older set of
+// symbols (a background scan still adding functions, say) has to be redone.
+void DisassemblyManager::checkSymbols()
+{
+	u32 version = symbolMap.GetVersion();
+	if (version == symbolVersion)
+		return;
+
+	clear();
+	symbolVersion = version;
+}
+
 void DisassemblyManager::clear()
 {
 	for (auto it = entries.begin(); it != entries.end(); it++)
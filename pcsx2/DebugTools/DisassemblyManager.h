@@ -208,8 +208,10 @@ public:
 	static int getMaxParamChars() { return maxParamChars; };
 private:
 	DisassemblyEntry* getEntry(u32 address);
+	void checkSymbols();
 	std::map<u32,DisassemblyEntry*> entries;
 	DebugInterface* cpu = NULL;
+	u32 symbolVersion = 0;
 	static int maxParamChars;
 };
 
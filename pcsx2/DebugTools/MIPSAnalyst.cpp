@@ -22,7 +22,8 @@
 #include "../R5900.h"
 #include "../R5900OpcodeTables.h"
 
-static std::vector<MIPSAnalyst::AnalyzedFunction> functions;
+#include <atomic>
+#include <thread>
 
 #define MIPS_MAKE_J(addr)   (0x08000000 | ((addr)>>2))
 #define MIPS_MAKE_JAL(addr) (0x0C000000 | ((addr)>>2))
@@ -196,7 +197,15 @@ namespace MIPSAnalyst
 		return furthestJumpbackAddr;
 	}
 
-	void ScanForFunctions(u32 startAddr, u32 endAddr, bool insertSymbols) {
+	// Functions found are passed to the sink in batches; the scan stops early when it
+	// returns false.
+	template <typename Sink>
+	static void ScanRange(u32 startAddr, u32 endAddr, Sink sink) {
+		static const size_t BatchSize = 256;
+
+		std::vector<AnalyzedFunction> functions;
+		functions.reserve(BatchSize);
+
 		AnalyzedFunction currentFunction = {startAddr};
 
 		u32 furthestBranch = 0;
@@ -204,10 +213,14 @@ namespace MIPSAnalyst
 		bool end = false;
 		bool isStraightLeaf = true;
 
-		functions.clear();
-
 		u32 addr;
 		for (addr = startAddr; addr <= endAddr; addr += 4) {
+			if (functions.size() >= BatchSize) {
+				if (!sink(functions))
+					return;
+				functions.clear();
+			}
+
 			// Use pre-existing symbol map info if available. May be more reliable.
 			SymbolInfo syminfo;
 			if (symbolMap.GetSymbolInfo(&syminfo, addr, ST_FUNCTION)) {
@@ -312,7 +325,10 @@ namespace MIPSAnalyst
 
 		currentFunction.end = addr + 4;
 		functions.push_back(currentFunction);
+		sink(functions);
+	}
 
+	static void InsertFunctions(std::vector<AnalyzedFunction>& functions, bool insertSymbols) {
 		for (auto iter = functions.begin(); iter != functions.end(); iter++) {
 			iter->size = iter->end - iter->start + 4;
 			if (insertSymbols) {
@@ -322,6 +338,70 @@ namespace MIPSAnalyst
 		}
 	}
 
+	void ScanForFunctions(u32 startAddr, u32 endAddr, bool insertSymbols) {
+		ScanRange(startAddr, endAddr, [insertSymbols](std::vector<AnalyzedFunction>& functions) {
+			InsertFunctions(functions, insertSymbols);
+			return true;
+		});
+	}
+
+	// --------------------------------------------------------------------------------------
+	//  Background scanning
+	// --------------------------------------------------------------------------------------
+	// A full scan of a large ELF takes a while, so at game start it runs on its own thread and
+	// publishes each batch of functions as it goes; the debugger picks them up through the
+	// symbol map version.  The scan only reads EE RAM (the ELF text range), it's the caller's
+	// job to cancel it before that memory or the symbol map is reset.
+	class FunctionScanner {
+	public:
+		FunctionScanner() : m_cancel(false) {}
+		~FunctionScanner() { Cancel(); }
+
+		void Start(u32 startAddr, u32 endAddr, std::function<void()> onFinished) {
+			Cancel();
+			m_cancel.store(false);
+			m_thread = std::thread([this, startAddr, endAddr, onFinished]() {
+				u64 start = GetCPUTicks();
+				ScanRange(startAddr, endAddr, [this](std::vector<AnalyzedFunction>& functions) {
+					if (m_cancel.load(std::memory_order_relaxed))
+						return false;
+					InsertFunctions(functions, true);
+					symbolMap.UpdateActiveSymbols();
+					return true;
+				});
+
+				if (m_cancel.load())
+					return;
+
+				DevCon.WriteLn("(MIPSAnalyst) Function scan of %08x-%08x done in %u ms", startAddr, endAddr,
+					(u32)((GetCPUTicks() - start) * 1000 / GetTickFrequency()));
+				if (onFinished)
+					onFinished();
+			});
+		}
+
+		void Cancel() {
+			if (!m_thread.joinable())
+				return;
+			m_cancel.store(true);
+			m_thread.join();
+		}
+
+	private:
+		std::thread m_thread;
+		std::atomic<bool> m_cancel;
+	};
+
+	static FunctionScanner scanner;
+
+	void ScanForFunctionsAsync(u32 startAddr, u32 endAddr, std::function<void()> onFinished) {
+		scanner.Start(startAddr, endAddr, onFinished);
+	}
+
+	void CancelAnalysis() {
+		scanner.Cancel();
+	}
+
 	MipsOpcodeInfo GetOpcodeInfo(DebugInterface* cpu, u32 address) {
 		MipsOpcodeInfo info;
 		memset(&info, 0, sizeof(info));
@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include <functional>
+
 class DebugInterface;
 
 
@@ -41,6 +43,12 @@ namespace MIPSAnalyst
 
 	void ScanForFunctions(u32 startAddr, u32 endAddr, bool insertSymbols);
 
+	// Same as ScanForFunctions with insertSymbols, but on a worker thread. onFinished is
+	// called from that thread once the whole range has been added to the symbol map.
+	void ScanForFunctionsAsync(u32 startAddr, u32 endAddr, std::function<void()> onFinished);
+	// Stops a running background scan and waits for it.
+	void CancelAnalysis();
+
 	enum LoadStoreLRType { LOADSTORE_NORMAL, LOADSTORE_LEFT, LOADSTORE_RIGHT };
 
 	typedef struct {
@@ -41,6 +41,7 @@ void SymbolMap::Clear() {
 	activeData.clear();
 	activeModuleEnds.clear();
 	modules.clear();
+	Invalidate();
 }
 
 
@@ -102,69 +103,157 @@ bool SymbolMap::LoadNocashSym(const char *filename) {
 	return true;
 }
 
+std::shared_ptr<const SymbolMap::Index> SymbolMap::GetIndex() const {
+	std::shared_ptr<const Index> index = std::atomic_load(&m_index);
+	if (index && index->version == GetVersion())
+		return index;
+
+	// Somebody is busy changing the symbols (a background scan, probably), keep using the
+	// old snapshot rather than waiting for them.
+	std::unique_lock<std::recursive_mutex> guard(m_lock, std::try_to_lock);
+	if (!guard.owns_lock()) {
+		if (index)
+			return index;
+		guard.lock();
+	}
+
+	index = std::atomic_load(&m_index);
+	const u32 version = GetVersion();
+	if (index && index->version == version)
+		return index;
+
+	std::shared_ptr<Index> fresh = std::make_shared<Index>();
+	fresh->version = version;
+
+	fresh->functions.reserve(activeFunctions.size());
+	for (auto it = activeFunctions.begin(); it != activeFunctions.end(); ++it) {
+		Index::Function func = { it->first, it->second.size, it->second.index };
+		fresh->functions.push_back(func);
+	}
+
+	fresh->labels.reserve(activeLabels.size());
+	for (auto it = activeLabels.begin(); it != activeLabels.end(); ++it) {
+		Index::Label label = { it->first, it->second.name };
+		fresh->labels.push_back(label);
+	}
+
+	fresh->data.reserve(activeData.size());
+	for (auto it = activeData.begin(); it != activeData.end(); ++it) {
+		Index::Data entry = { it->first, it->second.size, it->second.type };
+		fresh->data.push_back(entry);
+	}
+
+	index = fresh;
+	std::atomic_store(&m_index, index);
+	return index;
+}
+
+template <typename T>
+static const T* FindStart(const std::vector<T>& entries, u32 start) {
+	auto it = std::lower_bound(entries.begin(), entries.end(), start, [](const T& entry, u32 value) { return entry.start < value; });
+	if (it == entries.end() || it->start != start)
+		return NULL;
+	return &*it;
+}
+
+// Like the map based lookup before, only the closest symbol starting at or before the
+// address is considered.
+template <typename T>
+static const T* FindContaining(const std::vector<T>& entries, u32 address) {
+	auto it = std::upper_bound(entries.begin(), entries.end(), address, [](u32 value, const T& entry) { return value < entry.start; });
+	if (it == entries.begin())
+		return NULL;
+	--it;
+	if (it->start <= address && it->start + it->size > address)
+		return &*it;
+	return NULL;
+}
+
+const SymbolMap::Index::Function* SymbolMap::Index::FindFunction(u32 start) const {
+	return FindStart(functions, start);
+}
+
+const SymbolMap::Index::Function* SymbolMap::Index::FindFunctionContaining(u32 address) const {
+	return FindContaining(functions, address);
+}
+
+const SymbolMap::Index::Label* SymbolMap::Index::FindLabel(u32 addr) const {
+	auto it = std::lower_bound(labels.begin(), labels.end(), addr, [](const Label& label, u32 value) { return label.addr < value; });
+	if (it == labels.end() || it->addr != addr)
+		return NULL;
+	return &*it;
+}
+
+const SymbolMap::Index::Data* SymbolMap::Index::FindData(u32 start) const {
+	return FindStart(data, start);
+}
+
+const SymbolMap::Index::Data* SymbolMap::Index::FindDataContaining(u32 address) const {
+	return FindContaining(data, address);
+}
+
+bool SymbolMap::IsEmpty() const {
+	auto index = GetIndex();
+	return index->functions.empty() && index->labels.empty() && index->data.empty();
+}
+
 SymbolType SymbolMap::GetSymbolType(u32 address) const {
-	std::lock_guard<std::recursive_mutex> guard(m_lock);
-	if (activeFunctions.find(address) != activeFunctions.end())
+	auto index = GetIndex();
+	if (index->FindFunction(address) != NULL)
 		return ST_FUNCTION;
-	if (activeData.find(address) != activeData.end())
+	if (index->FindData(address) != NULL)
 		return ST_DATA;
 	return ST_NONE;
 }
 
 bool SymbolMap::GetSymbolInfo(SymbolInfo *info, u32 address, SymbolType symmask) const {
-	u32 functionAddress = INVALID_ADDRESS;
-	u32 dataAddress = INVALID_ADDRESS;
-
-	if (symmask & ST_FUNCTION)
-		functionAddress = GetFunctionStart(address);
-
-	if (symmask & ST_DATA)
-		dataAddress = GetDataStart(address);
-
-	if (functionAddress == INVALID_ADDRESS || dataAddress == INVALID_ADDRESS) {
-		if (functionAddress != INVALID_ADDRESS) {
-			if (info != NULL) {
-				info->type = ST_FUNCTION;
-				info->address = functionAddress;
-				info->size = GetFunctionSize(functionAddress);
-			}
-
-			return true;
-		}
-		
-		if (dataAddress != INVALID_ADDRESS) {
-			if (info != NULL) {
-				info->type = ST_DATA;
-				info->address = dataAddress;
-				info->size = GetDataSize(dataAddress);
-			}
+	auto index = GetIndex();
+	const Index::Function* func = (symmask & ST_FUNCTION) ? index->FindFunctionContaining(address) : NULL;
+	const Index::Data* data = (symmask & ST_DATA) ? index->FindDataContaining(address) : NULL;
 
-			return true;
+	// if both exist, return the function
+	if (func != NULL) {
+		if (info != NULL) {
+			info->type = ST_FUNCTION;
+			info->address = func->start;
+			info->size = func->size;
 		}
 
-		return false;
+		return true;
 	}
 
-	// if both exist, return the function
-	if (info != NULL) {
-		info->type = ST_FUNCTION;
-		info->address = functionAddress;
-		info->size = GetFunctionSize(functionAddress);
+	if (data != NULL) {
+		if (info != NULL) {
+			info->type = ST_DATA;
+			info->address = data->start;
+			info->size = data->size;
+		}
+
+		return true;
 	}
 
-	return true;
+	return false;
 }
 
 u32 SymbolMap::GetNextSymbolAddress(u32 address, SymbolType symmask) {
-	std::lock_guard<std::recursive_mutex> guard(m_lock);
-	const auto functionEntry = symmask & ST_FUNCTION ? activeFunctions.upper_bound(address) : activeFunctions.end();
-	const auto dataEntry = symmask & ST_DATA ? activeData.upper_bound(address) : activeData.end();
+	auto index = GetIndex();
+	u32 funcAddress = 0xFFFFFFFF;
+	u32 dataAddress = 0xFFFFFFFF;
 
-	if (functionEntry == activeFunctions.end() && dataEntry == activeData.end())
-		return INVALID_ADDRESS;
+	if (symmask & ST_FUNCTION) {
+		auto it = std::upper_bound(index->functions.begin(), index->functions.end(), address, [](u32 value, const Index::Function& func) { return value < func.start; });
+		if (it != index->functions.end())
+			funcAddress = it->start;
+	}
+
+	if (symmask & ST_DATA) {
+		auto it = std::upper_bound(index->data.begin(), index->data.end(), address, [](u32 value, const Index::Data& entry) { return value < entry.start; });
+		if (it != index->data.end())
+			dataAddress = it->start;
+	}
 
-	u32 funcAddress = (functionEntry != activeFunctions.end()) ? functionEntry->first : 0xFFFFFFFF;
-	u32 dataAddress = (dataEntry != activeData.end()) ? dataEntry->first : 0xFFFFFFFF;
+	if (funcAddress == 0xFFFFFFFF && dataAddress == 0xFFFFFFFF)
+		return INVALID_ADDRESS;
 
 	if (funcAddress <= dataAddress)
 		return funcAddress;
@@ -173,20 +262,20 @@ u32 SymbolMap::GetNextSymbolAddress(u32 address, SymbolType symmask) {
 }
 
 std::string SymbolMap::GetDescription(unsigned int address) const {
-	std::lock_guard<std::recursive_mutex> guard(m_lock);
-	const char* labelName = NULL;
+	auto index = GetIndex();
+	const Index::Label* label = NULL;
 
-	u32 funcStart = GetFunctionStart(address);
-	if (funcStart != INVALID_ADDRESS) {
-		labelName = GetLabelName(funcStart);
+	const Index::Function* func = index->FindFunctionContaining(address);
+	if (func != NULL) {
+		label = index->FindLabel(func->start);
 	} else {
-		u32 dataStart = GetDataStart(address);
-		if (dataStart != INVALID_ADDRESS)
-			labelName = GetLabelName(dataStart);
+		const Index::Data* data = index->FindDataContaining(address);
+		if (data != NULL)
+			label = index->FindLabel(data->start);
 	}
 
-	if (labelName != NULL)
-		return labelName;
+	if (label != NULL)
+		return label->name;
 
 	char descriptionTemp[256];
 	sprintf(descriptionTemp, "(%08x)", address);
@@ -194,30 +283,29 @@ std::string SymbolMap::GetDescription(unsigned int address) const {
 }
 
 std::vector<SymbolEntry> SymbolMap::GetAllSymbols(SymbolType symmask) {
+	auto index = GetIndex();
 	std::vector<SymbolEntry> result;
 
 	if (symmask & ST_FUNCTION) {
-		std::lock_guard<std::recursive_mutex> guard(m_lock);
-		for (auto it = activeFunctions.begin(); it != activeFunctions.end(); it++) {
+		for (auto it = index->functions.begin(); it != index->functions.end(); it++) {
 			SymbolEntry entry;
-			entry.address = it->first;
-			entry.size = GetFunctionSize(entry.address);
-			const char* name = GetLabelName(entry.address);
-			if (name != NULL)
-				entry.name = name;
+			entry.address = it->start;
+			entry.size = it->size;
+			const Index::Label* label = index->FindLabel(entry.address);
+			if (label != NULL)
+				entry.name = label->name;
 			result.push_back(entry);
 		}
 	}
 
 	if (symmask & ST_DATA) {
-		std::lock_guard<std::recursive_mutex> guard(m_lock);
-		for (auto it = activeData.begin(); it != activeData.end(); it++) {
+		for (auto it = index->data.begin(); it != index->data.end(); it++) {
 			SymbolEntry entry;
-			entry.address = it->first;
-			entry.size = GetDataSize(entry.address);
-			const char* name = GetLabelName(entry.address);
-			if (name != NULL)
-				entry.name = name;
+			entry.address = it->start;
+			entry.size = it->size;
+			const Index::Label* label = index->FindLabel(entry.address);
+			if (label != NULL)
+				entry.name = label->name;
 			result.push_back(entry);
 		}
 	}
@@ -324,6 +412,7 @@ std::vector<LoadedModuleInfo> SymbolMap::getAllModules() const {
 
 void SymbolMap::AddFunction(const char* name, u32 address, u32 size, int moduleIndex) {
 	std::lock_guard<std::recursive_mutex> guard(m_lock);
+	Invalidate();
 
 	if (moduleIndex == -1) {
 		moduleIndex = GetModuleIndex(address);
@@ -368,56 +457,35 @@ void SymbolMap::AddFunction(const char* name, u32 address, u32 size, int moduleI
 }
 
 u32 SymbolMap::GetFunctionStart(u32 address) const {
-	std::lock_guard<std::recursive_mutex> guard(m_lock);
-	auto it = activeFunctions.upper_bound(address);
-	if (it == activeFunctions.end()) {
-		// check last element
-		auto rit = activeFunctions.rbegin();
-		if (rit != activeFunctions.rend()) {
-			u32 start = rit->first;
-			u32 size = rit->second.size;
-			if (start <= address && start+size > address)
-				return start;
-		}
-		// otherwise there's no function that contains this address
+	auto index = GetIndex();
+	const Index::Function* func = index->FindFunctionContaining(address);
+	if (func == NULL)
 		return INVALID_ADDRESS;
-	}
-
-	if (it != activeFunctions.begin()) {
-		it--;
-		u32 start = it->first;
-		u32 size = it->second.size;
-		if (start <= address && start+size > address)
-			return start;
-	}
 
-	return INVALID_ADDRESS;
+	return func->start;
 }
 
 u32 SymbolMap::GetFunctionSize(u32 startAddress) const {
-	std::lock_guard<std::recursive_mutex> guard(m_lock);
-	auto it = activeFunctions.find(startAddress);
-	if (it == activeFunctions.end())
+	auto index = GetIndex();
+	const Index::Function* func = index->FindFunction(startAddress);
+	if (func == NULL)
 		return INVALID_ADDRESS;
 
-	return it->second.size;
+	return func->size;
 }
 
 int SymbolMap::GetFunctionNum(u32 address) const {
-	std::lock_guard<std::recursive_mutex> guard(m_lock);
-	u32 start = GetFunctionStart(address);
-	if (start == INVALID_ADDRESS)
-		return INVALID_ADDRESS;
-
-	auto it = activeFunctions.find(start);
-	if (it == activeFunctions.end())
+	auto index = GetIndex();
+	const Index::Function* func = index->FindFunctionContaining(address);
+	if (func == NULL)
 		return INVALID_ADDRESS;
 
-	return it->second.index;
+	return func->index;
 }
 
 void SymbolMap::AssignFunctionIndices() {
 	std::lock_guard<std::recursive_mutex> guard(m_lock);
+	Invalidate();
 	int index = 0;
 	for (auto mod = activeModuleEnds.begin(), modend = activeModuleEnds.end(); mod != modend; ++mod) {
 		int moduleIndex = mod->second.index;
@@ -432,6 +500,7 @@ void SymbolMap::AssignFunctionIndices() {
 void SymbolMap::UpdateActiveSymbols() {
 	// return;   (slow in debug mode)
 	std::lock_guard<std::recursive_mutex> guard(m_lock);
+	Invalidate();
 	std::map<int, u32> activeModuleIndexes;
 	for (auto it = activeModuleEnds.begin(), end = activeModuleEnds.end(); it != end; ++it) {
 		activeModuleIndexes[it->second.index] = it->second.start;
@@ -490,6 +559,7 @@ bool SymbolMap::SetFunctionSize(u32 startAddress, u32 newSize) {
 
 bool SymbolMap::RemoveFunction(u32 startAddress, bool removeName) {
 	std::lock_guard<std::recursive_mutex> guard(m_lock);
+	Invalidate();
 
 	auto it = activeFunctions.find(startAddress);
 	if (it == activeFunctions.end())
@@ -519,6 +589,7 @@ bool SymbolMap::RemoveFunction(u32 startAddress, bool removeName) {
 
 void SymbolMap::AddLabel(const char* name, u32 address, int moduleIndex) {
 	std::lock_guard<std::recursive_mutex> guard(m_lock);
+	Invalidate();
 
 	if (moduleIndex == -1) {
 		moduleIndex = GetModuleIndex(address);
@@ -563,6 +634,7 @@ void SymbolMap::AddLabel(const char* name, u32 address, int moduleIndex) {
 
 void SymbolMap::SetLabelName(const char* name, u32 address, bool updateImmediately) {
 	std::lock_guard<std::recursive_mutex> guard(m_lock);
+	Invalidate();
 	auto labelInfo = activeLabels.find(address);
 	if (labelInfo == activeLabels.end()) {
 		AddLabel(name, address);
@@ -601,18 +673,18 @@ const char *SymbolMap::GetLabelNameRel(u32 relAddress, int moduleIndex) const {
 }
 
 std::string SymbolMap::GetLabelString(u32 address) const {
-	std::lock_guard<std::recursive_mutex> guard(m_lock);
-	const char *label = GetLabelName(address);
+	auto index = GetIndex();
+	const Index::Label* label = index->FindLabel(address);
 	if (label == NULL)
 		return "";
-	return label;
+	return label->name;
 }
 
 bool SymbolMap::GetLabelValue(const char* name, u32& dest) {
-	std::lock_guard<std::recursive_mutex> guard(m_lock);
-	for (auto it = activeLabels.begin(); it != activeLabels.end(); it++) {
-		if (strcasecmp(name, it->second.name) == 0) {
-			dest = it->first;
+	auto index = GetIndex();
+	for (auto it = index->labels.begin(); it != index->labels.end(); it++) {
+		if (strcasecmp(name, it->name.c_str()) == 0) {
+			dest = it->addr;
 			return true;
 		}
 	}
@@ -622,6 +694,7 @@ bool SymbolMap::GetLabelValue(const char* name, u32& dest) {
 
 void SymbolMap::AddData(u32 address, u32 size, DataType type, int moduleIndex) {
 	std::lock_guard<std::recursive_mutex> guard(m_lock);
+	Invalidate();
 
 	if (moduleIndex == -1) {
 		moduleIndex = GetModuleIndex(address);
@@ -665,47 +738,25 @@ void SymbolMap::AddData(u32 address, u32 size, DataType type, int moduleIndex) {
 }
 
 u32 SymbolMap::GetDataStart(u32 address) const {
-	std::lock_guard<std::recursive_mutex> guard(m_lock);
-	auto it = activeData.upper_bound(address);
-	if (it == activeData.end())
-	{
-		// check last element
-		auto rit = activeData.rbegin();
-
-		if (rit != activeData.rend())
-		{
-			u32 start = rit->first;
-			u32 size = rit->second.size;
-			if (start <= address && start+size > address)
-				return start;
-		}
-		// otherwise there's no data that contains this address
+	auto index = GetIndex();
+	const Index::Data* data = index->FindDataContaining(address);
+	if (data == NULL)
 		return INVALID_ADDRESS;
-	}
-
-	if (it != activeData.begin()) {
-		it--;
-		u32 start = it->first;
-		u32 size = it->second.size;
-		if (start <= address && start+size > address)
-			return start;
-	}
-
-	return INVALID_ADDRESS;
+	return data->start;
 }
 
 u32 SymbolMap::GetDataSize(u32 startAddress) const {
-	std::lock_guard<std::recursive_mutex> guard(m_lock);
-	auto it = activeData.find(startAddress);
-	if (it == activeData.end())
+	auto index = GetIndex();
+	const Index::Data* data = index->FindData(startAddress);
+	if (data == NULL)
 		return INVALID_ADDRESS;
-	return it->second.size;
+	return data->size;
 }
 
 DataType SymbolMap::GetDataType(u32 startAddress) const {
-	std::lock_guard<std::recursive_mutex> guard(m_lock);
-	auto it = activeData.find(startAddress);
-	if (it == activeData.end())
+	auto index = GetIndex();
+	const Index::Data* data = index->FindData(startAddress);
+	if (data == NULL)
 		return DATATYPE_NONE;
-	return it->second.type;
+	return data->type;
 }
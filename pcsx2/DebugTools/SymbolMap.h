@@ -20,6 +20,8 @@
 #include <map>
 #include <string>
 #include <mutex>
+#include <memory>
+#include <atomic>
 
 #include "Pcsx2Types.h"
 
@@ -55,7 +57,7 @@ enum DataType {
 
 class SymbolMap {
 public:
-	SymbolMap() {}
+	SymbolMap() : m_version(0) {}
 	void Clear();
 	void SortSymbols();
 
@@ -95,7 +97,10 @@ public:
 	static const u32 INVALID_ADDRESS = (u32)-1;
 
 	void UpdateActiveSymbols();
-	bool IsEmpty() const { return activeFunctions.empty() && activeLabels.empty() && activeData.empty(); };
+	bool IsEmpty() const;
+
+	// Changes whenever the active symbols change, so views can tell when to refresh.
+	u32 GetVersion() const { return m_version.load(std::memory_order_acquire); }
 private:
 	void AssignFunctionIndices();
 	const char *GetLabelName(u32 address) const;
@@ -146,6 +151,45 @@ private:
 	std::vector<ModuleEntry> modules;
 
 	mutable std::recursive_mutex m_lock;
+
+	// Flat, sorted copy of the active symbols for lookups. Readers don't take m_lock: they
+	// grab the current snapshot and keep using it even if it's replaced meanwhile. It is
+	// rebuilt by the first lookup after a change (see Invalidate()).
+	struct Index {
+		struct Function {
+			u32 start;
+			u32 size;
+			int index;
+		};
+
+		struct Label {
+			u32 addr;
+			std::string name;
+		};
+
+		struct Data {
+			u32 start;
+			u32 size;
+			DataType type;
+		};
+
+		u32 version;
+		std::vector<Function> functions;
+		std::vector<Label> labels;
+		std::vector<Data> data;
+
+		const Function* FindFunction(u32 start) const;
+		const Function* FindFunctionContaining(u32 address) const;
+		const Label* FindLabel(u32 addr) const;
+		const Data* FindData(u32 start) const;
+		const Data* FindDataContaining(u32 address) const;
+	};
+
+	std::shared_ptr<const Index> GetIndex() const;
+	void Invalidate() { m_version.fetch_add(1, std::memory_order_release); }
+
+	mutable std::shared_ptr<const Index> m_index;
+	std::atomic<u32> m_version;
 };
 
 extern SymbolMap symbolMap;
@@ -0,0 +1,338 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "DirtyPageTracker.h"
+
+#include <algorithm>
+#include <iterator>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+DirtyPageTracker g_DirtyPages;
+
+#ifdef __linux__
+// pagemap entry bit set when the page was written since the last clear_refs "4"
+static const u64 PagemapSoftDirty = 1ULL << 55;
+#endif
+
+static u64 HashPage(const u8* src)
+{
+	return DirtyPageTracker::HashMemory(src, DirtyPageTracker::PageSize);
+}
+
+DirtyPageTracker::DirtyPageTracker()
+{
+	memzero(m_regions);
+	for (Checkpoint& checkpoint : m_checkpoints)
+	{
+		checkpoint.set = false;
+		checkpoint.generation = 0;
+	}
+	m_valid = false;
+	m_generation = 0;
+	m_probed = false;
+	m_soft_dirty = false;
+#ifdef __linux__
+	m_pagemap = -1;
+	m_clear_refs = -1;
+#endif
+}
+
+DirtyPageTracker::~DirtyPageTracker()
+{
+#ifdef __linux__
+	if (m_pagemap >= 0)
+		close(m_pagemap);
+	if (m_clear_refs >= 0)
+		close(m_clear_refs);
+#endif
+}
+
+void DirtyPageTracker::SetRegion(RegionId region, u8* base, uint size)
+{
+	m_regions[region].base = base;
+	m_regions[region].size = size;
+	Invalidate();
+}
+
+void DirtyPageTracker::MergePages(const std::vector<u32>& a, const std::vector<u32>& b, std::vector<u32>& out)
+{
+	out.clear();
+	out.reserve(a.size() + b.size());
+	std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+}
+
+void DirtyPageTracker::CopyPages(u8* dst, const u8* src, uint size, const std::vector<u32>* pages)
+{
+	if (!pages)
+	{
+		memcpy(dst, src, size);
+		return;
+	}
+
+	for (u32 page : *pages)
+		memcpy(dst + page * PageSize, src + page * PageSize, PageSize);
+}
+
+u64 DirtyPageTracker::HashMemory(const u8* src, uint size, u64 seed)
+{
+	// FNV-1a over 64 bit words, plenty to tell memory changed.
+	const u64* words = (const u64*)src;
+	u64 hash = 0xcbf29ce484222325ULL ^ seed;
+	for (uint i = 0; i < size / sizeof(u64); i++)
+		hash = (hash ^ words[i]) * 0x100000001b3ULL;
+	for (uint i = size & ~(sizeof(u64) - 1); i < size; i++)
+		hash = (hash ^ src[i]) * 0x100000001b3ULL;
+	return hash;
+}
+
+#ifdef __linux__
+bool DirtyPageTracker::ClearSoftDirty()
+{
+	return pwrite(m_clear_refs, "4", 1, 0) == 1;
+}
+
+bool DirtyPageTracker::ReadSoftDirty(const u8* base, uint pages)
+{
+	m_entries.resize(pages);
+	const size_t bytes = pages * sizeof(u64);
+	return pread(m_pagemap, m_entries.data(), bytes, ((uptr)base / PageSize) * sizeof(u64)) == (ssize_t)bytes;
+}
+
+void DirtyPageTracker::Probe()
+{
+	m_probed = true;
+
+	if (sysconf(_SC_PAGESIZE) != PageSize)
+		return;
+
+	m_pagemap = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+	m_clear_refs = open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC);
+	if (m_pagemap >= 0 && m_clear_refs >= 0)
+	{
+		// Kernels built without CONFIG_MEM_SOFT_DIRTY take the write and never set the bit.
+		void* page = mmap(NULL, PageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (page != MAP_FAILED)
+		{
+			*(volatile u8*)page = 1;
+			if (ClearSoftDirty() && ReadSoftDirty((u8*)page, 1) && !(m_entries[0] & PagemapSoftDirty))
+			{
+				*(volatile u8*)page = 2;
+				m_soft_dirty = ReadSoftDirty((u8*)page, 1) && (m_entries[0] & PagemapSoftDirty);
+			}
+			munmap(page, PageSize);
+		}
+	}
+
+	if (!m_soft_dirty)
+	{
+		if (m_pagemap >= 0)
+			close(m_pagemap);
+		if (m_clear_refs >= 0)
+			close(m_clear_refs);
+		m_pagemap = m_clear_refs = -1;
+	}
+}
+#else
+bool DirtyPageTracker::ClearSoftDirty()
+{
+	return false;
+}
+
+bool DirtyPageTracker::ReadSoftDirty(const u8* base, uint pages)
+{
+	return false;
+}
+
+void DirtyPageTracker::Probe()
+{
+	m_probed = true;
+}
+#endif
+
+void DirtyPageTracker::Reset()
+{
+	if (!m_probed)
+	{
+		Probe();
+		DevCon.WriteLn("(DirtyPageTracker) Tracking writes with %s", m_soft_dirty ? "soft-dirty bits" : "page hashes");
+	}
+
+	if (m_soft_dirty)
+	{
+		if (ClearSoftDirty())
+		{
+			m_valid = true;
+			return;
+		}
+		Console.Warning("(DirtyPageTracker) Could not clear soft-dirty bits, using page hashes.");
+		m_soft_dirty = false;
+	}
+
+	for (uint i = 0; i < Region_Count; i++)
+	{
+		const u8* base = GetRegionPtr((RegionId)i);
+		const uint pages = GetRegionSize((RegionId)i) / PageSize;
+
+		m_hashes[i].resize(pages);
+		for (uint page = 0; page < pages; page++)
+			m_hashes[i][page] = HashPage(base + page * PageSize);
+	}
+	m_valid = true;
+}
+
+void DirtyPageTracker::Collect(RegionId region, std::vector<u32>& pages)
+{
+	const u8* base = GetRegionPtr(region);
+	const uint count = GetRegionSize(region) / PageSize;
+
+	if (m_valid && m_soft_dirty)
+	{
+		if (ReadSoftDirty(base, count))
+		{
+			for (uint page = 0; page < count; page++)
+			{
+				if (m_entries[page] & PagemapSoftDirty)
+					pages.push_back(page);
+			}
+			return;
+		}
+		// Lost track, the caller gets everything this time.
+		Console.Warning("(DirtyPageTracker) Could not read soft-dirty bits.");
+		Invalidate();
+	}
+
+	if (m_valid && !m_soft_dirty)
+	{
+		const std::vector<u64>& hashes = m_hashes[region];
+		for (uint page = 0; page < count; page++)
+		{
+			if (HashPage(base + page * PageSize) != hashes[page])
+				pages.push_back(page);
+		}
+		return;
+	}
+
+	for (uint page = 0; page < count; page++)
+		pages.push_back(page);
+}
+
+void DirtyPageTracker::Mark(CheckpointId id)
+{
+	// The others lose what was written so far when the tracking is reset, they keep it.
+	std::vector<u32> pages, merged;
+	for (uint region = 0; region < Region_Count; region++)
+	{
+		bool collected = false;
+		for (uint i = 0; i < Checkpoint_Count; i++)
+		{
+			if (i == id || !IsValid((CheckpointId)i))
+				continue;
+
+			if (!collected)
+			{
+				pages.clear();
+				Collect((RegionId)region, pages);
+				collected = true;
+			}
+
+			std::vector<u32>& kept = m_checkpoints[i].pages[region];
+			MergePages(kept, pages, merged);
+			kept.swap(merged);
+		}
+	}
+
+	Reset();
+
+	Checkpoint& checkpoint = m_checkpoints[id];
+	checkpoint.set = true;
+	checkpoint.generation = m_generation;
+	for (std::vector<u32>& kept : checkpoint.pages)
+		kept.clear();
+}
+
+void DirtyPageTracker::Release(CheckpointId id)
+{
+	Checkpoint& checkpoint = m_checkpoints[id];
+	checkpoint.set = false;
+	for (std::vector<u32>& kept : checkpoint.pages)
+	{
+		kept.clear();
+		kept.shrink_to_fit();
+	}
+}
+
+void DirtyPageTracker::Collect(CheckpointId id, RegionId region, std::vector<u32>& pages)
+{
+	pages.clear();
+	if (!IsValid(id))
+	{
+		const uint count = GetRegionSize(region) / PageSize;
+		for (uint page = 0; page < count; page++)
+			pages.push_back(page);
+		return;
+	}
+
+	Collect(region, pages);
+
+	if (!m_checkpoints[id].pages[region].empty())
+	{
+		std::vector<u32> merged;
+		MergePages(m_checkpoints[id].pages[region], pages, merged);
+		pages.swap(merged);
+	}
+}
+
+// --------------------------------------------------------------------------------------
+//  DirtyPageSwapChain  (implementations)
+// --------------------------------------------------------------------------------------
+DirtyPageSwapChain::DirtyPageSwapChain(DirtyPageTracker& tracker, DirtyPageTracker::CheckpointId checkpoint)
+	: m_tracker(tracker)
+{
+	m_checkpoint = checkpoint;
+	m_tracked = false;
+}
+
+bool DirtyPageSwapChain::Next()
+{
+	// Pages written since the last save.  The older copy holds the save before that, so it
+	// needs those and the ones written in between.
+	const bool tracked = m_tracker.IsValid(m_checkpoint);
+	const bool in_place = tracked && m_tracked;
+	for (uint i = 0; i < DirtyPageTracker::Region_Count; i++)
+	{
+		const DirtyPageTracker::RegionId region = (DirtyPageTracker::RegionId)i;
+
+		m_prev_dirty[i].swap(m_dirty[i]);
+		m_tracker.Collect(m_checkpoint, region, m_dirty[i]);
+		if (in_place)
+			DirtyPageTracker::MergePages(m_dirty[i], m_prev_dirty[i], m_copy[i]);
+	}
+	m_tracker.Mark(m_checkpoint);
+
+	m_tracked = tracked;
+	return in_place;
+}
+
+void DirtyPageSwapChain::Reset()
+{
+	m_tracked = false;
+	m_tracker.Release(m_checkpoint);
+}
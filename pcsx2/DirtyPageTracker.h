@@ -0,0 +1,190 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+
+// --------------------------------------------------------------------------------------
+//  DirtyPageTracker
+// --------------------------------------------------------------------------------------
+// Finds the 4KB pages of EE and IOP main memory written since a checkpoint, so that
+// consecutive saves only write what changed (see memIncrementalSavingState, and the
+// incremental savestates of SysState.cpp).
+//
+// On Linux this uses the kernel's soft-dirty bits: Reset() clears them through
+// /proc/self/clear_refs, and the kernel sets them again on the first write to each page,
+// whoever does the write (recompiled code, DMA, plugins).  Collecting them is a read of
+// /proc/self/pagemap.  Write-protecting the pages ourselves isn't an option, the EE
+// recompiler already uses page protection on main memory to catch self-modifying code.
+//
+// Elsewhere, or when the kernel lacks soft-dirty support, a page is dirty when its hash
+// changed since Reset().  That costs a pass over the memory on both ends, but is still
+// much cheaper than saving all of it.
+//
+// Each user of the tracker (rewind captures, the savestate chain) has its own checkpoint:
+// Mark() starts it over, and Collect() gives the pages written since.  Marking one
+// checkpoint resets the tracking underneath, so the pages written until then are folded
+// into the other checkpoints first.
+//
+// Tracking is lost when the memory is reset or decommitted; every checkpoint then reports
+// all pages dirty until it is marked again.
+//
+class DirtyPageTracker
+{
+	DeclareNoncopyableObject(DirtyPageTracker);
+
+public:
+	static const uint PageSize = 4096;
+
+	enum RegionId
+	{
+		Region_EEMain = 0,
+		Region_IOPMain,
+		Region_Count
+	};
+
+	enum CheckpointId
+	{
+		Checkpoint_Rewind = 0,		// last rewind capture
+		Checkpoint_Savestate,		// base of the savestate chain
+		Checkpoint_Count
+	};
+
+protected:
+	struct Region
+	{
+		u8* base;
+		uint size;
+	};
+
+	struct Checkpoint
+	{
+		bool set;
+		uint generation;
+		std::vector<u32> pages[Region_Count];	// written before the last Reset()
+	};
+
+	Region m_regions[Region_Count];
+	Checkpoint m_checkpoints[Checkpoint_Count];
+	bool m_valid;
+	uint m_generation;
+	bool m_probed;
+	bool m_soft_dirty;
+
+#ifdef __linux__
+	int m_pagemap;
+	int m_clear_refs;
+	std::vector<u64> m_entries;
+#endif
+
+	std::vector<u64> m_hashes[Region_Count];
+
+public:
+	DirtyPageTracker();
+	virtual ~DirtyPageTracker();
+
+	bool IsValid() const { return m_valid; }
+	// Bumped every time tracking is lost.
+	uint GetGeneration() const { return m_generation; }
+
+	// Sets the memory tracked for a region; base must be page aligned.  Drops the tracking.
+	void SetRegion(RegionId region, u8* base, uint size);
+
+	void Invalidate()
+	{
+		m_valid = false;
+		m_generation++;
+	}
+
+	// True when the checkpoint was marked and tracking wasn't lost since.
+	bool IsValid(CheckpointId id) const
+	{
+		return m_valid && m_checkpoints[id].set && m_checkpoints[id].generation == m_generation;
+	}
+
+	// Marks every page clean for this checkpoint; the VM must not be running.
+	void Mark(CheckpointId id);
+
+	// Forgets the checkpoint, so that marking the others doesn't keep its pages anymore.
+	void Release(CheckpointId id);
+
+	// Sets pages to the index of every page of the region written since the checkpoint was
+	// marked, ascending; all of them when the checkpoint isn't valid.
+	void Collect(CheckpointId id, RegionId region, std::vector<u32>& pages);
+
+	u8* GetRegionPtr(RegionId region) const { return m_regions[region].base; }
+	uint GetRegionSize(RegionId region) const { return m_regions[region].size; }
+
+	// Union of two ascending page lists, ascending.
+	static void MergePages(const std::vector<u32>& a, const std::vector<u32>& b, std::vector<u32>& out);
+
+	// Copies the listed pages of a region from src to dst, or all of it for a NULL list.
+	static void CopyPages(u8* dst, const u8* src, uint size, const std::vector<u32>* pages);
+
+	// Hash of a whole block of memory, chained through seed.
+	static u64 HashMemory(const u8* src, uint size, u64 seed = 0);
+
+protected:
+	void Reset();
+	void Collect(RegionId region, std::vector<u32>& pages);
+
+	void Probe();
+	bool ReadSoftDirty(const u8* base, uint pages);
+	bool ClearSoftDirty();
+};
+
+// --------------------------------------------------------------------------------------
+//  DirtyPageSwapChain
+// --------------------------------------------------------------------------------------
+// Pages to write when the tracked memory is saved alternately into two copies, as the
+// rewind buffer does with its two states.  Each save goes over the older copy, which lacks
+// the pages written since it was saved: those of the last two intervals.
+//
+class DirtyPageSwapChain
+{
+	DeclareNoncopyableObject(DirtyPageSwapChain);
+
+protected:
+	DirtyPageTracker& m_tracker;
+	DirtyPageTracker::CheckpointId m_checkpoint;
+
+	std::vector<u32> m_dirty[DirtyPageTracker::Region_Count];
+	std::vector<u32> m_prev_dirty[DirtyPageTracker::Region_Count];
+	std::vector<u32> m_copy[DirtyPageTracker::Region_Count];
+
+	// m_dirty covers every difference between the two copies
+	bool m_tracked;
+
+public:
+	DirtyPageSwapChain(DirtyPageTracker& tracker, DirtyPageTracker::CheckpointId checkpoint);
+	virtual ~DirtyPageSwapChain() = default;
+
+	// Call before each save, the VM must not be running.  Returns false when the older copy
+	// must be written whole.
+	bool Next();
+
+	// Both copies are stale, the next two saves are whole.
+	void Reset();
+
+	// Pages to write into the older copy, valid when Next() returned true.
+	const std::vector<u32>& GetCopyPages(DirtyPageTracker::RegionId region) const { return m_copy[region]; }
+
+	// Pages written between the two copies, valid when IsTracked().
+	const std::vector<u32>& GetDirtyPages(DirtyPageTracker::RegionId region) const { return m_dirty[region]; }
+	bool IsTracked() const { return m_tracked; }
+};
+
+extern DirtyPageTracker g_DirtyPages;
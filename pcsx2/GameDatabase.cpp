@@ -16,6 +16,18 @@
 #include "PrecompiledHeader.h"
 #include "GameDatabase.h"
 
+#include <algorithm>
+#include <wx/ffile.h>
+
+#ifdef _WIN32
+#include <wx/msw/wrapwin.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 BaseGameDatabaseImpl::BaseGameDatabaseImpl()
 	: gHash( 9900 )
 	, m_baseKey( L"Serial" )
@@ -27,12 +39,24 @@ BaseGameDatabaseImpl::BaseGameDatabaseImpl()
 bool BaseGameDatabaseImpl::findGame(Game_Data& dest, const wxString& id) {
 
 	GameDataHash::const_iterator iter( gHash.find(id) );
-	if( iter == gHash.end() ) {
-		dest.clear();
-		return false;
+	if( iter != gHash.end() ) {
+		dest = iter->second;
+		return true;
 	}
-	dest = iter->second;
-	return true;
+
+	GameDataView view;
+	if( m_compiled.findGame(view, id.utf8_str()) ) {
+		view.copyTo(dest);
+		return true;
+	}
+
+	dest.clear();
+	return false;
+}
+
+// Same as above without copying anything, only games in the compiled image have views.
+bool BaseGameDatabaseImpl::findGame(GameDataView& dest, const wxString& id) {
+	return m_compiled.findGame(dest, id.utf8_str());
 }
 
 Game_Data* BaseGameDatabaseImpl::createNewGame( const wxString& id )
@@ -74,3 +98,289 @@ void Game_Data::writeString(const wxString& key, const wxString& value) {
 		kList.push_back(key_pair(key, value));
 	}
 }
+
+// --------------------------------------------------------------------------------------
+//  GameDataView  (implementations)
+// --------------------------------------------------------------------------------------
+
+// Keys compare case-insensitively, like key_pair::CompareKey (keys are plain ASCII).
+static bool KeyEquals(const char* a, const char* b) {
+	for (; *a && *b; a++, b++) {
+		if (tolower((u8)*a) != tolower((u8)*b))
+			return false;
+	}
+	return *a == *b;
+}
+
+const char* GameDataView::find(const char* key) const {
+	for (u32 i = 0; i < m_count; i++) {
+		if (KeyEquals(getKey(i), key))
+			return getValue(i);
+	}
+	return NULL;
+}
+
+const char* GameDataView::getString(const char* key) const {
+	const char* value = find(key);
+	return value ? value : "";
+}
+
+int GameDataView::getInt(const char* key) const {
+	return (int)strtoul(getString(key), NULL, 10);
+}
+
+void GameDataView::copyTo(Game_Data& dest) const {
+	dest.clear();
+	dest.id = fromUTF8(getId());
+	dest.kList.reserve(m_count);
+	for (u32 i = 0; i < m_count; i++)
+		dest.kList.push_back(key_pair(fromUTF8(getKey(i)), fromUTF8(getValue(i))));
+}
+
+// --------------------------------------------------------------------------------------
+//  CompiledGameDatabase  (implementations)
+// --------------------------------------------------------------------------------------
+
+CompiledGameDatabase::CompiledGameDatabase()
+	: m_image(NULL)
+	, m_size(0)
+	, m_mapping(NULL)
+#ifdef _WIN32
+	, m_handle(NULL)
+#endif
+{
+}
+
+CompiledGameDatabase::~CompiledGameDatabase()
+{
+	Close();
+}
+
+void CompiledGameDatabase::Close()
+{
+	if (m_mapping) {
+#ifdef _WIN32
+		UnmapViewOfFile(m_mapping);
+		CloseHandle((HANDLE)m_handle);
+		m_handle = NULL;
+#else
+		munmap(m_mapping, m_size);
+#endif
+		m_mapping = NULL;
+	}
+
+	m_buffer.clear();
+	m_buffer.shrink_to_fit();
+	m_image = NULL;
+	m_size = 0;
+}
+
+// Only the header and section sizes are checked, string and pair references are bounds
+// checked when they're read.
+bool CompiledGameDatabase::Validate(u64 source_size, s64 source_time) const
+{
+	if (m_size < sizeof(Header))
+		return false;
+
+	const Header& h = header();
+
+	if (h.magic != FileMagic || h.version != FileVersion)
+		return false;
+
+	if (h.source_size != source_size || h.source_time != source_time)
+		return false;
+
+	const u64 size = sizeof(Header) + (u64)h.games * sizeof(Game) + (u64)h.pairs * 8 + h.strings_size;
+
+	// The string table ends with a NUL so that no string can run past the image
+	return size == m_size && h.strings_size > 0 && m_image[m_size - 1] == 0;
+}
+
+bool CompiledGameDatabase::Open(const wxString& file, u64 source_size, s64 source_time)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE handle = CreateFileW(file.wc_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (handle == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	HANDLE mapping = NULL;
+	if (GetFileSizeEx(handle, &size) && size.QuadPart > 0)
+		mapping = CreateFileMapping(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(handle);
+
+	if (!mapping)
+		return false;
+
+	m_mapping = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!m_mapping) {
+		CloseHandle(mapping);
+		return false;
+	}
+	m_handle = mapping;
+	m_size = (size_t)size.QuadPart;
+#else
+	int fd = open(file.utf8_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	void* mapping = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && st.st_size > 0)
+		mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (mapping == MAP_FAILED)
+		return false;
+
+	m_mapping = mapping;
+	m_size = st.st_size;
+#endif
+
+	m_image = (const u8*)m_mapping;
+
+	if (!Validate(source_size, source_time)) {
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void CompiledGameDatabase::Build(const GameDataHash& games, u64 source_size, s64 source_time)
+{
+	Close();
+
+	std::vector<const Game_Data*> sorted;
+	std::vector<std::string> ids;
+
+	sorted.reserve(games.size());
+	ids.reserve(games.size());
+
+	for (const auto& game : games)
+		sorted.push_back(&game.second);
+
+	std::vector<u32> order(sorted.size());
+	for (const Game_Data* game : sorted)
+		ids.push_back(std::string(game->id.utf8_str()));
+	for (u32 i = 0; i < order.size(); i++)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), [&](u32 a, u32 b) { return ids[a] < ids[b]; });
+
+	std::unordered_map<std::string, u32> interned;
+	std::string strings;
+	std::vector<Game> records;
+	std::vector<u32> pairs;
+
+	auto intern = [&](const std::string& str) -> u32 {
+		auto it = interned.find(str);
+		if (it != interned.end())
+			return it->second;
+
+		u32 offset = strings.size();
+		strings.append(str.c_str(), str.size() + 1);
+		interned.emplace(str, offset);
+		return offset;
+	};
+
+	// Offset 0 is the empty string, out of range references read as it too
+	intern(std::string());
+
+	records.reserve(order.size());
+
+	for (u32 index : order) {
+		const Game_Data& game = *sorted[index];
+
+		Game record;
+		record.id = intern(ids[index]);
+		record.first_pair = pairs.size() / 2;
+		record.pair_count = game.kList.size();
+
+		for (const key_pair& pair : game.kList) {
+			pairs.push_back(intern(std::string(pair.key.utf8_str())));
+			pairs.push_back(intern(std::string(pair.value.utf8_str())));
+		}
+
+		records.push_back(record);
+	}
+
+	// Pad the table so that the image size stays a multiple of 4, the padding is NULs
+	strings.resize((strings.size() + 3) & ~(size_t)3, '\0');
+
+	Header h;
+	h.magic = FileMagic;
+	h.version = FileVersion;
+	h.source_size = source_size;
+	h.source_time = source_time;
+	h.games = records.size();
+	h.pairs = pairs.size() / 2;
+	h.strings_size = strings.size();
+	h.reserved = 0;
+
+	m_buffer.resize(sizeof(Header) + records.size() * sizeof(Game) + pairs.size() * 4 + strings.size());
+
+	u8* out = m_buffer.data();
+	memcpy(out, &h, sizeof(h));
+	out += sizeof(h);
+	memcpy(out, records.data(), records.size() * sizeof(Game));
+	out += records.size() * sizeof(Game);
+	memcpy(out, pairs.data(), pairs.size() * 4);
+	out += pairs.size() * 4;
+	memcpy(out, strings.data(), strings.size());
+
+	m_image = m_buffer.data();
+	m_size = m_buffer.size();
+}
+
+bool CompiledGameDatabase::Save(const wxString& file) const
+{
+	if (!IsOk())
+		return false;
+
+	// Written aside and renamed, a partial file would only fail validation but still
+	// cost a text parse on every start until it's replaced.
+	const wxString temp = file + L".tmp";
+
+	{
+		wxFFile out(temp, L"wb");
+		if (!out.IsOpened() || out.Write(m_image, m_size) != m_size)
+			return false;
+	}
+
+	return wxRenameFile(temp, file, true);
+}
+
+bool CompiledGameDatabase::findGame(GameDataView& dest, const char* id) const
+{
+	dest = GameDataView();
+
+	if (!IsOk())
+		return false;
+
+	const Header& h = header();
+	const Game* first = games();
+	const Game* last = first + h.games;
+	const char* table = strings();
+
+	auto str = [&](u32 offset) { return offset < h.strings_size ? table + offset : ""; };
+
+	const Game* it = std::lower_bound(first, last, id, [&](const Game& game, const char* key) {
+		return strcmp(str(game.id), key) < 0;
+	});
+
+	if (it == last || strcmp(str(it->id), id) != 0)
+		return false;
+
+	if (it->first_pair > h.pairs || it->pair_count > h.pairs - it->first_pair)
+		return false;
+
+	dest.m_strings = table;
+	dest.m_strings_size = h.strings_size;
+	dest.m_pairs = pairs() + (size_t)it->first_pair * 2;
+	dest.m_count = it->pair_count;
+	dest.m_id = it->id;
+
+	return true;
+}
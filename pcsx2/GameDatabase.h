@@ -123,6 +123,122 @@ struct Game_Data
 	}
 };
 
+using GameDataHash = std::unordered_map<wxString, Game_Data, StringHash>;
+
+// --------------------------------------------------------------------------------------
+//  GameDataView
+// --------------------------------------------------------------------------------------
+// A game's (key, value) pairs inside a compiled database image.  Strings are UTF-8 and
+// point into the image, so a view stays valid for as long as the database is loaded and
+// reading it never allocates.  Missing keys read as empty strings.
+class GameDataView
+{
+	friend class CompiledGameDatabase;
+
+protected:
+	const char*	m_strings;
+	u32			m_strings_size;
+	const u32*	m_pairs;		// key, value string offsets
+	u32			m_count;
+	u32			m_id;
+
+	const char* str(u32 offset) const {
+		return offset < m_strings_size ? m_strings + offset : "";
+	}
+
+	const char* find(const char* key) const;
+
+public:
+	GameDataView()
+		: m_strings(NULL), m_strings_size(0), m_pairs(NULL), m_count(0), m_id(0) {}
+
+	bool IsOk() const { return m_strings != NULL; }
+
+	const char* getId() const { return str(m_id); }
+	u32 getCount() const { return m_count; }
+	const char* getKey(u32 i) const { return str(m_pairs[i * 2 + 0]); }
+	const char* getValue(u32 i) const { return str(m_pairs[i * 2 + 1]); }
+
+	bool keyExists(const char* key) const { return find(key) != NULL; }
+	const char* getString(const char* key) const;
+	int getInt(const char* key) const;
+	bool getBool(const char* key) const { return getInt(key) != 0; }
+
+	void copyTo(Game_Data& dest) const;
+};
+
+// --------------------------------------------------------------------------------------
+//  CompiledGameDatabase
+// --------------------------------------------------------------------------------------
+// Binary form of the text game database: a sorted serial index and (key, value) pairs
+// referencing an interned string table.  The text file stays the source of truth, its size
+// and modification time are stored in the header and a mismatch makes Open fail so the
+// caller recompiles.  Loading is a file mapping and a header check, no parsing.
+//
+// Layout (native endian, every section 4-byte aligned):
+//   Header
+//   Game   [games]   (sorted by id, byte-wise)
+//   u32[2] [pairs]   (key, value)
+//   char   [strings] (NUL terminated)
+class CompiledGameDatabase
+{
+	DeclareNoncopyableObject(CompiledGameDatabase);
+
+public:
+	static const u32 FileMagic = 0x31424447; // "GDB1"
+	static const u32 FileVersion = 1;
+
+	struct Header
+	{
+		u32 magic;
+		u32 version;
+		u64 source_size;
+		s64 source_time;
+		u32 games;
+		u32 pairs;
+		u32 strings_size;
+		u32 reserved;
+	};
+
+	struct Game
+	{
+		u32 id;
+		u32 first_pair;
+		u32 pair_count;
+	};
+
+protected:
+	const u8*		m_image;
+	size_t			m_size;
+	std::vector<u8>	m_buffer;		// image built in memory, when not mapped
+
+	void*			m_mapping;
+#ifdef _WIN32
+	void*			m_handle;
+#endif
+
+	const Header& header() const { return *(const Header*)m_image; }
+	const Game* games() const { return (const Game*)(m_image + sizeof(Header)); }
+	const u32* pairs() const { return (const u32*)(games() + header().games); }
+	const char* strings() const { return (const char*)(pairs() + (size_t)header().pairs * 2); }
+
+	bool Validate(u64 source_size, s64 source_time) const;
+
+public:
+	CompiledGameDatabase();
+	virtual ~CompiledGameDatabase();
+
+	bool IsOk() const { return m_image != NULL; }
+	u32 getGameCount() const { return IsOk() ? header().games : 0; }
+
+	bool Open(const wxString& file, u64 source_size, s64 source_time);
+	void Build(const GameDataHash& games, u64 source_size, s64 source_time);
+	bool Save(const wxString& file) const;
+	void Close();
+
+	bool findGame(GameDataView& dest, const char* id) const;
+};
+
 // --------------------------------------------------------------------------------------
 //  IGameDatabase
 // --------------------------------------------------------------------------------------
@@ -133,11 +249,10 @@ public:
 
 	virtual wxString getBaseKey() const=0;
 	virtual bool findGame(Game_Data& dest, const wxString& id)=0;
+	virtual bool findGame(GameDataView& dest, const wxString& id)=0;
 	virtual Game_Data* createNewGame( const wxString& id )=0;
 };
 
-using GameDataHash = std::unordered_map<wxString, Game_Data, StringHash>;
-
 // --------------------------------------------------------------------------------------
 //  BaseGameDatabaseImpl 
 // --------------------------------------------------------------------------------------
@@ -147,6 +262,10 @@ protected:
 	GameDataHash	gHash;			// hash table of game serials matched to their gList indexes!
 	wxString		m_baseKey;
 
+	// Once loaded the database is served from the compiled image, gHash only holds
+	// games parsed from text that haven't been compiled yet.
+	CompiledGameDatabase m_compiled;
+
 public:
 	BaseGameDatabaseImpl();
 	virtual ~BaseGameDatabaseImpl() = default;
@@ -155,7 +274,10 @@ public:
 	void setBaseKey( const wxString& key ) { m_baseKey = key; }
 
 	bool findGame(Game_Data& dest, const wxString& id);
+	bool findGame(GameDataView& dest, const wxString& id);
 	Game_Data* createNewGame( const wxString& id );
+
+	u32 getGameCount() const { return gHash.size() + m_compiled.getGameCount(); }
 };
 
 extern IGameDatabase* AppHost_GetGameDatabase();
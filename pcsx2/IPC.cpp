@@ -27,15 +27,23 @@
 #include <WinSock2.h>
 #include <windows.h>
 #else
-#define read_portable(a, b, c) (read(a, b, c))
-#define write_portable(a, b, c) (write(a, b, c))
-#define close_portable(a) (close(a))
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <fcntl.h>
+// a peer going away must fail the send, not raise SIGPIPE and kill the emulator.
+// macOS has no MSG_NOSIGNAL, SO_NOSIGPIPE is set on each connection instead.
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#define read_portable(a, b, c) (read(a, b, c))
+#define write_portable(a, b, c) (send(a, b, c, MSG_NOSIGNAL))
+#define close_portable(a) (close(a))
 #endif
 
 #include "Common.h"
+#include "Counters.h"
 #include "Memory.h"
+#include "vtlb.h"
 #include "System/SysThreads.h"
 #include "svnrev.h"
 #include "IPC.h"
@@ -116,6 +124,8 @@ SocketIPC::SocketIPC(SysCoreThread* vm)
 	// we save a handle of the main vm object
 	m_vm = vm;
 
+	m_event_thread = std::thread(&SocketIPC::EventThread, this);
+
 	// we start the thread
 	Start();
 }
@@ -178,6 +188,10 @@ void SocketIPC::ExecuteTaskInThread()
 #endif
 			setsockopt(m_msgsock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof tv);
 			setsockopt(m_msgsock, SOL_SOCKET, SO_SNDTIMEO, (const char*)&tv, sizeof tv);
+#ifdef __APPLE__
+			int nosigpipe = 1;
+			setsockopt(m_msgsock, SOL_SOCKET, SO_NOSIGPIPE, &nosigpipe, sizeof nosigpipe);
+#endif
 
 
 			// either int or ssize_t depending on the platform, so we have to
@@ -213,6 +227,7 @@ void SocketIPC::ExecuteTaskInThread()
 				}
 			}
 			SocketIPC::IPCBuffer res;
+			m_new_subscriptions.clear();
 
 			// we remove 4 bytes to get the message size out of the IPC command
 			// size in ParseCommand
@@ -221,10 +236,39 @@ void SocketIPC::ExecuteTaskInThread()
 			else
 				res = ParseCommand(&m_ipc_buffer[4], m_ret_buffer, (u32)end_length - 4);
 
-			// we don't care about the error value as we will reset the
-			// connection after that anyways
-			if (write_portable(m_msgsock, res.buffer, res.size) < 0)
+			// bulk replies are too big for a single write, keep going until
+			// everything is sent. we don't care about the error value as we
+			// will reset the connection after that anyways
+			int sent = 0;
+			while (sent < res.size)
 			{
+				auto tmp_length = write_portable(m_msgsock, &res.buffer[sent], res.size - sent);
+				if (tmp_length <= 0)
+					break;
+				sent += tmp_length;
+			}
+
+			// subscribed connections stay open, the event thread owns them from now on
+			if (sent == res.size && res.buffer[4] == IPC_OK && !m_new_subscriptions.empty())
+			{
+				// a stalled client must not hold up the others, events are sent
+				// without blocking.
+#ifdef _WIN32
+				u_long nonblocking = 1;
+				ioctlsocket(m_msgsock, FIONBIO, &nonblocking);
+#else
+				fcntl(m_msgsock, F_SETFL, fcntl(m_msgsock, F_GETFL, 0) | O_NONBLOCK);
+#endif
+				std::unique_ptr<Subscriber> sub(new Subscriber());
+				sub->sock = m_msgsock;
+				sub->ranges.swap(m_new_subscriptions);
+				sub->sent = 0;
+				sub->blocked = false;
+				sub->dead = false;
+
+				std::lock_guard<std::mutex> lock(m_subscribers_lock);
+				m_subscribers.push_back(std::move(sub));
+				continue;
 			}
 		}
 		close_portable(m_msgsock);
@@ -232,6 +276,141 @@ void SocketIPC::ExecuteTaskInThread()
 	return;
 }
 
+void SocketIPC::OnVsyncEnd()
+{
+	std::lock_guard<std::mutex> lock(m_subscribers_lock);
+	if (m_subscribers.empty())
+		return;
+
+	// event format:
+	//         size (4 byte)
+	//         |           IPC_EVENT (1 byte)
+	//         |           |  frame (4 byte)
+	//         |           |  |           number of changed ranges (4 byte)
+	//         |           |  |           |
+	// format: SS SS SS SS 01 FF FF FF FF NN NN NN NN
+	// followed, for each changed range, by its subscription id (4 byte), its
+	// size (4 byte) and its whole contents.
+	std::vector<char> current;
+	bool queued = false;
+	for (auto& sub : m_subscribers)
+	{
+		if (sub->dead)
+			continue;
+
+		// try again what the socket couldn't take last time
+		if (sub->blocked)
+		{
+			sub->blocked = false;
+			queued = true;
+		}
+
+		std::vector<char> event(13);
+		u32 changed = 0;
+		for (u32 id = 0; id < sub->ranges.size(); id++)
+		{
+			Subscription& range = sub->ranges[id];
+			current.resize(range.size);
+			ReadRange(range.address, range.size, current.data());
+			if (range.sent && memcmp(current.data(), range.shadow.data(), range.size) == 0)
+				continue;
+
+			range.shadow.swap(current);
+			range.sent = true;
+
+			const size_t pos = event.size();
+			event.resize(pos + 8 + range.size);
+			ToArray<u32>(event.data(), id, pos);
+			ToArray<u32>(event.data(), range.size, pos + 4);
+			memcpy(&event[pos + 8], range.shadow.data(), range.size);
+			changed++;
+		}
+
+		if (changed == 0)
+			continue;
+
+		if (sub->pending.size() >= MAX_PENDING_EVENTS)
+		{
+			Console.Warning("IPC: Subscriber is not keeping up, disconnecting it.");
+			sub->dead = true;
+			queued = true;
+			continue;
+		}
+
+		ToArray<u32>(event.data(), (u32)event.size(), 0);
+		event[4] = IPC_EVENT;
+		ToArray<u32>(event.data(), g_FrameCount, 5);
+		ToArray<u32>(event.data(), changed, 9);
+		sub->pending.push_back(std::move(event));
+		queued = true;
+	}
+
+	if (queued)
+		m_event_cv.notify_one();
+}
+
+static bool SendWouldBlock()
+{
+#ifdef _WIN32
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+	return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+void SocketIPC::EventThread()
+{
+	std::unique_lock<std::mutex> lock(m_subscribers_lock);
+	while (!m_event_exit)
+	{
+		// close the connections that went away, send what the others can take
+		// right now. a full socket is retried on the next frame, and a client
+		// that stays behind is dropped by OnVsyncEnd.
+		for (size_t i = 0; i < m_subscribers.size();)
+		{
+			Subscriber& sub = *m_subscribers[i];
+			if (sub.dead)
+			{
+				close_portable(sub.sock);
+				m_subscribers.erase(m_subscribers.begin() + i);
+				continue;
+			}
+
+			while (!sub.pending.empty() && !sub.dead && !sub.blocked)
+			{
+				std::vector<char>& event = sub.pending.front();
+				auto tmp_length = write_portable(sub.sock, &event[sub.sent], event.size() - sub.sent);
+				if (tmp_length <= 0)
+				{
+					if (tmp_length < 0 && SendWouldBlock())
+						sub.blocked = true;
+					else
+						sub.dead = true;
+					break;
+				}
+
+				sub.sent += tmp_length;
+				if (sub.sent == event.size())
+				{
+					sub.pending.pop_front();
+					sub.sent = 0;
+				}
+			}
+			i++;
+		}
+
+		bool work = false;
+		for (auto& sub : m_subscribers)
+			work |= sub->dead || (!sub->pending.empty() && !sub->blocked);
+		if (!work)
+			m_event_cv.wait(lock);
+	}
+
+	for (auto& sub : m_subscribers)
+		close_portable(sub->sock);
+	m_subscribers.clear();
+}
+
 SocketIPC::~SocketIPC()
 {
 	m_end = true;
@@ -242,6 +421,15 @@ SocketIPC::~SocketIPC()
 #endif
 	close_portable(m_sock);
 	close_portable(m_msgsock);
+	if (m_event_thread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_subscribers_lock);
+			m_event_exit = true;
+		}
+		m_event_cv.notify_one();
+		m_event_thread.join();
+	}
 	delete[] m_ret_buffer;
 	delete[] m_ipc_buffer;
 	// destroy the thread
@@ -252,6 +440,56 @@ SocketIPC::~SocketIPC()
 	DESTRUCTOR_CATCHALL
 }
 
+void SocketIPC::ReadRange(u32 address, u32 size, char* dst)
+{
+	using namespace vtlb_private;
+
+	while (size > 0)
+	{
+		const u32 page_left = VTLB_PAGE_SIZE - (address & VTLB_PAGE_MASK);
+		const u32 chunk = std::min(size, page_left);
+		const auto vmv = vtlbdata.vmap[address >> VTLB_PAGE_BITS];
+
+		if (!vmv.isHandler(address))
+			memcpy(dst, reinterpret_cast<void*>(vmv.assumePtr(address)), chunk);
+		else
+		{
+			for (u32 i = 0; i < chunk; i++)
+				dst[i] = memRead8(address + i);
+		}
+
+		address += chunk;
+		dst += chunk;
+		size -= chunk;
+	}
+}
+
+void SocketIPC::WriteRange(u32 address, u32 size, const char* src)
+{
+	using namespace vtlb_private;
+
+	while (size > 0)
+	{
+		const u32 page_left = VTLB_PAGE_SIZE - (address & VTLB_PAGE_MASK);
+		const u32 chunk = std::min(size, page_left);
+		const auto vmv = vtlbdata.vmap[address >> VTLB_PAGE_BITS];
+
+		// recompiled code on these pages is taken care of by the page protection,
+		// same as for a guest store.
+		if (!vmv.isHandler(address))
+			memcpy(reinterpret_cast<void*>(vmv.assumePtr(address)), src, chunk);
+		else
+		{
+			for (u32 i = 0; i < chunk; i++)
+				memWrite8(address + i, src[i]);
+		}
+
+		address += chunk;
+		src += chunk;
+		size -= chunk;
+	}
+}
+
 SocketIPC::IPCBuffer SocketIPC::ParseCommand(char* buf, char* ret_buffer, u32 buf_size)
 {
 	u32 ret_cnt = 5;
@@ -383,6 +621,108 @@ SocketIPC::IPCBuffer SocketIPC::ParseCommand(char* buf, char* ret_buffer, u32 bu
 				ret_cnt += 256;
 				break;
 			}
+			// bulk messages
+			//         IPC Message event (1 byte)
+			//         |  Memory address (4 byte)
+			//         |  |           size (4 byte)
+			//         |  |           |           data (size bytes, MsgWriteRange only)
+			//         |  |           |           |
+			// format: XX YY YY YY YY SS SS SS SS ZZ ...
+			// reply of MsgReadRange: the size bytes read, written directly in the reply.
+			//
+			// MsgReadScatter takes a count (4 byte) followed by count address/size
+			// pairs, and replies with the ranges one after the other.
+			case MsgReadRange:
+			{
+				if (!m_vm->HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 8, ret_cnt, 0, buf_size))
+					goto error;
+				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+				const u32 size = FromArray<u32>(&buf[buf_cnt], 4);
+				if (size > MAX_IPC_BULK_SIZE || !SafetyChecks(buf_cnt, 8, ret_cnt, size, buf_size))
+					goto error;
+				ReadRange(a, size, &ret_buffer[ret_cnt]);
+				ret_cnt += size;
+				buf_cnt += 8;
+				break;
+			}
+			case MsgWriteRange:
+			{
+				if (!m_vm->HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 8, ret_cnt, 0, buf_size))
+					goto error;
+				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+				const u32 size = FromArray<u32>(&buf[buf_cnt], 4);
+				if (size > MAX_IPC_BULK_SIZE || !SafetyChecks(buf_cnt, 8 + size, ret_cnt, 0, buf_size))
+					goto error;
+				WriteRange(a, size, &buf[buf_cnt + 8]);
+				buf_cnt += 8 + size;
+				break;
+			}
+			case MsgReadScatter:
+			{
+				if (!m_vm->HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 4, ret_cnt, 0, buf_size))
+					goto error;
+				const u32 count = FromArray<u32>(&buf[buf_cnt], 0);
+				buf_cnt += 4;
+				if (count > (buf_size - buf_cnt) / 8)
+					goto error;
+
+				// validate the whole list first so that a bad entry doesn't leave half a reply
+				u64 total = 0;
+				for (u32 i = 0; i < count; i++)
+					total += FromArray<u32>(&buf[buf_cnt], i * 8 + 4);
+				if (total > MAX_IPC_BULK_SIZE || !SafetyChecks(buf_cnt, count * 8, ret_cnt, (int)total, buf_size))
+					goto error;
+
+				for (u32 i = 0; i < count; i++)
+				{
+					const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+					const u32 size = FromArray<u32>(&buf[buf_cnt], 4);
+					ReadRange(a, size, &ret_buffer[ret_cnt]);
+					ret_cnt += size;
+					buf_cnt += 8;
+				}
+				break;
+			}
+			// subscription message
+			//         IPC Message event (1 byte)
+			//         |  Memory address (4 byte)
+			//         |  |           size (4 byte)
+			//         |  |           |
+			// format: XX YY YY YY YY SS SS SS SS
+			// reply: the subscription id (4 byte).
+			//
+			// Once the reply is sent the connection stays open and gets an IPC_EVENT
+			// message (see OnVsyncEnd) at the end of each vsync where one of its
+			// ranges changed, starting with the first vsync after subscribing.
+			case MsgSubscribe:
+			{
+				if (!m_vm->HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 8, ret_cnt, 4, buf_size))
+					goto error;
+				Subscription range;
+				range.address = FromArray<u32>(&buf[buf_cnt], 0);
+				range.size = FromArray<u32>(&buf[buf_cnt], 4);
+				range.sent = false;
+
+				u64 total = range.size;
+				for (const Subscription& other : m_new_subscriptions)
+					total += other.size;
+				if (range.size == 0 || total > MAX_IPC_BULK_SIZE)
+					goto error;
+
+				ToArray<u32>(ret_buffer, (u32)m_new_subscriptions.size(), ret_cnt);
+				m_new_subscriptions.push_back(std::move(range));
+				ret_cnt += 4;
+				buf_cnt += 8;
+				break;
+			}
 			default:
 			{
 			error:
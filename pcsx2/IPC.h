@@ -24,6 +24,12 @@
 
 #include "Utilities/PersistentThread.h"
 #include "System/SysThreads.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #ifdef _WIN32
 #include <WinSock2.h>
 #include <windows.h>
@@ -54,17 +60,23 @@ protected:
 #endif
 
 
+	/**
+	 * Maximum size of the data moved by bulk commands in a single message.
+	 * Enough for the whole EE main memory in one MsgReadRange.
+	 */
+#define MAX_IPC_BULK_SIZE (32 * 1024 * 1024)
+
 	/**
 	 * Maximum memory used by an IPC message request.
-	 * Equivalent to 50,000 Write64 requests.
+	 * Equivalent to 50,000 Write64 requests, plus a full bulk write.
 	 */
-#define MAX_IPC_SIZE 650000
+#define MAX_IPC_SIZE (650000 + MAX_IPC_BULK_SIZE)
 
 	/**
 	 * Maximum memory used by an IPC message reply.
-	 * Equivalent to 50,000 Read64 replies.
+	 * Equivalent to 50,000 Read64 replies, plus a full bulk read.
 	 */
-#define MAX_IPC_RETURN_SIZE 450000
+#define MAX_IPC_RETURN_SIZE (450000 + MAX_IPC_BULK_SIZE)
 
 	/**
 	 * IPC return buffer.
@@ -96,6 +108,10 @@ protected:
 		MsgWrite32 = 6,         /**< Write 32 bit value to memory. */
 		MsgWrite64 = 7,         /**< Write 64 bit value to memory. */
 		MsgVersion = 8,         /**< Returns PCSX2 version. */
+		MsgReadRange = 9,       /**< Read a contiguous range of memory. */
+		MsgWriteRange = 10,     /**< Write a contiguous range of memory. */
+		MsgReadScatter = 11,    /**< Read a list of ranges of memory. */
+		MsgSubscribe = 12,      /**< Send a range of memory every frame it changes. */
 		MsgUnimplemented = 0xFF /**< Unimplemented IPC message. */
 	};
 
@@ -119,9 +135,60 @@ protected:
 	enum IPCResult : unsigned char
 	{
 		IPC_OK = 0,     /**< IPC command successfully completed. */
+		IPC_EVENT = 1,  /**< Frame event sent to a subscribed connection. */
 		IPC_FAIL = 0xFF /**< IPC command failed to complete. */
 	};
 
+	/**
+	 * A memory range a client subscribed to.
+	 * shadow holds the contents last sent, to diff against.
+	 */
+	struct Subscription
+	{
+		u32 address;
+		u32 size;
+		std::vector<char> shadow;
+		bool sent;
+	};
+
+	/**
+	 * A connection kept open after a MsgSubscribe.
+	 * Frame events are queued by the core thread and sent by the event thread.
+	 * The socket is non-blocking: sent is how much of the front event went out,
+	 * blocked is set while the socket is full.
+	 */
+	struct Subscriber
+	{
+#ifdef _WIN32
+		SOCKET sock;
+#else
+		int sock;
+#endif
+		std::vector<Subscription> ranges;
+		std::deque<std::vector<char>> pending;
+		size_t sent;
+		bool blocked;
+		bool dead;
+	};
+
+	/**
+	 * Maximum number of frame events queued for a subscriber.
+	 * A client that falls further behind than this gets disconnected.
+	 */
+	static const size_t MAX_PENDING_EVENTS = 8;
+
+	// Subscriptions of the message being parsed, registered once the reply is sent.
+	std::vector<Subscription> m_new_subscriptions;
+
+	std::vector<std::unique_ptr<Subscriber>> m_subscribers;
+	std::mutex m_subscribers_lock;
+	std::condition_variable m_event_cv;
+	std::thread m_event_thread;
+	bool m_event_exit = false;
+
+	// Thread sending the frame events to subscribers.
+	void EventThread();
+
 	// handle to the main vm thread
 	SysCoreThread* m_vm;
 
@@ -138,6 +205,14 @@ protected:
 	 */
 	IPCBuffer ParseCommand(char* buf, char* ret_buffer, u32 buf_size);
 
+	/**
+	 * Copies EE memory from/to an IPC buffer.
+	 * Pages mapped to host memory are copied directly, the rest goes through
+	 * the usual memory handlers.
+	 */
+	static void ReadRange(u32 address, u32 size, char* dst);
+	static void WriteRange(u32 address, u32 size, const char* src);
+
 	/**
 	 * Formats an IPC buffer
 	 * ret_buffer: return buffer to use. 
@@ -196,4 +271,10 @@ public:
 	SocketIPC(SysCoreThread* vm);
 	virtual ~SocketIPC();
 
+	/**
+	 * Diffs the subscribed ranges and queues the frame events.
+	 * Called by the core thread at the end of each vsync.
+	 */
+	void OnVsyncEnd();
+
 }; // class SocketIPC
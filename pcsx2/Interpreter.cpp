@@ -83,6 +83,8 @@ void intMemcheck(u32 op, u32 bits, bool store)
 
 		if (check.result == 0)
 			continue;
+		if (mmap_IsPageWatchpoint(check.start, check.end))
+			continue;
 		if ((check.cond & MEMCHECK_WRITE) == 0 && store)
 			continue;
 		if ((check.cond & MEMCHECK_READ) == 0 && !store)
@@ -502,6 +504,9 @@ static void intEventTest()
 {
 	// Perform counters, ints, and IOP updates:
 	_cpuEventTest_Shared();
+
+	if (mmap_CheckWatchpoints())
+		intBreakpoint(true);
 }
 
 static void intExecute()
@@ -48,6 +48,8 @@ BIOS
 #include "SPU2/spu2.h"
 
 #include "Utilities/PageFaultSource.h"
+#include "DebugTools/Breakpoints.h"
+#include "System/SysThreads.h"
 
 #ifdef ENABLECACHE
 #include "Cache.h"
@@ -905,6 +907,73 @@ struct vtlb_PageProtectionInfo
 
 static __aligned16 vtlb_PageProtectionInfo m_PageProtectInfo[Ps2MemSize::MainRam >> 12];
 
+// ===========================================================================================
+//  Memory Watchpoints
+// ===========================================================================================
+// Memchecks on main RAM are implemented by protecting the host pages that cover them, so
+// only accesses to those pages take the slow (page fault) path instead of recompiled code
+// checking every load and store against every memcheck.  Write watches make the page
+// read-only, read watches take away all access.
+//
+// The fault handler records a hit if the access falls in a watched range of the right kind
+// (reads and writes are told apart by the fault context), unprotects the page and has the
+// faulting instruction single-stepped; the page is re-armed from the trap right after that
+// one access, so every later access faults again.  Hits are logged, or break, at the next
+// event test.  Caveat: the pc of the faulting instruction isn't known under the recompiler,
+// so hits report the pc the EE last stored, which is the start of the block.
+// Accesses from other threads (debugger, IPC) re-arm the same way but record no hits, as
+// with inline memchecks; while such an access is being stepped an EE access to the same
+// page goes unnoticed.  Memchecks outside main RAM (scratchpad, hardware registers) are
+// still checked inline.
+
+enum mmap_WatchFlags
+{
+	Watch_Read		= 0x01,
+	Watch_Write		= 0x02,
+	Watch_Disarmed	= 0x04,		// unprotected while the faulting access is single-stepped
+};
+
+struct mmap_WatchRange
+{
+	u32 begin;		// offsets into eeMem->Main, never crossing a page
+	u32 end;
+	u32 start;		// guest address of begin
+	MemCheckCondition cond;
+	MemCheckResult result;
+};
+
+struct mmap_WatchHit
+{
+	u32 addr;
+	u32 pc;
+	u8 access;		// Watch_Read or Watch_Write
+	MemCheckResult result;
+};
+
+static u8 m_PageWatchInfo[Ps2MemSize::MainRam >> 12];
+static std::vector<mmap_WatchRange> m_WatchRanges;
+static std::vector<u32> m_WatchedPages;
+static std::vector<std::pair<u32, u32>> m_WatchedChecks;
+static uint m_InlineMemchecks = 0;
+
+// written by the fault handler, consumed by the event test (both on the EE thread)
+static mmap_WatchHit m_WatchHits[32];
+static uint m_WatchHitCount = 0;
+
+// Applies the protection a ram page needs for block tracking and any armed watchpoint.
+static void mmap_ProtectRamPage( uint rampage )
+{
+	const u8 watch = (m_PageWatchInfo[rampage] & Watch_Disarmed) ? 0 : m_PageWatchInfo[rampage];
+
+	PageProtectionMode mode = PageAccess_ReadWrite();
+	if( watch & Watch_Read )
+		mode = PageAccess_None();
+	else if( (watch & Watch_Write) || m_PageProtectInfo[rampage].Mode == ProtMode_Write )
+		mode = PageAccess_ReadOnly();
+
+	HostSys::MemProtect( &eeMem->Main[rampage<<12], __pagesize, mode );
+}
+
 
 // returns:
 //  ProtMode_NotRequired - unchecked block (resides in ROM, thus is integrity is constant)
@@ -951,7 +1020,7 @@ void mmap_MarkCountedRamPage( u32 paddr )
 	);
 
 	m_PageProtectInfo[rampage].Mode = ProtMode_Write;
-	HostSys::MemProtect( &eeMem->Main[rampage<<12], __pagesize, PageAccess_ReadOnly() );
+	mmap_ProtectRamPage( rampage );
 }
 
 // offset - offset of address relative to psM.
@@ -968,11 +1037,51 @@ static __fi void mmap_ClearCpuBlock( uint offset )
 	pxAssertMsg( m_PageProtectInfo[rampage].Mode != ProtMode_Manual,
 		"Attempted to clear a block that is already under manual protection." );
 
-	HostSys::MemProtect( &eeMem->Main[rampage<<12], __pagesize, PageAccess_ReadWrite() );
 	m_PageProtectInfo[rampage].Mode = ProtMode_Manual;
+	mmap_ProtectRamPage( rampage );
 	Cpu->Clear( m_PageProtectInfo[rampage].ReverseRamMap, 0x400 );
 }
 
+// Records the memchecks hit by an access at the given offset into eeMem->Main.
+static void mmap_WatchpointFault( uptr offset, bool write )
+{
+	// Other threads (the debugger reading memory, for instance) don't hit memchecks.
+	if( !GetCoreThread().IsSelf() ) return;
+
+	const u8 access = write ? Watch_Write : Watch_Read;
+	const MemCheckCondition cond = write ? MEMCHECK_WRITE : MEMCHECK_READ;
+	bool hit = false;
+
+	for( const mmap_WatchRange& range : m_WatchRanges )
+	{
+		if( offset < range.begin || offset >= range.end ) continue;
+		if( !(range.cond & cond) ) continue;
+
+		if( m_WatchHitCount < ArraySize(m_WatchHits) )
+		{
+			mmap_WatchHit& rec = m_WatchHits[m_WatchHitCount];
+			rec.addr = range.start + (offset - range.begin);
+			rec.pc = cpuRegs.pc;
+			rec.access = access;
+			rec.result = range.result;
+		}
+		++m_WatchHitCount;
+		hit = true;
+	}
+
+	// get to the event test (which reports the hits) at the end of this block
+	if( hit ) cpuSetNextEventDelta( 0 );
+}
+
+// Runs from the single step trap right after the access that disarmed the page.
+static void mmap_RearmWatchpoint( uptr rampage )
+{
+	if( !(m_PageWatchInfo[rampage] & Watch_Disarmed) ) return;
+
+	m_PageWatchInfo[rampage] &= ~Watch_Disarmed;
+	mmap_ProtectRamPage( rampage );
+}
+
 void mmap_PageFaultHandler::OnPageFaultEvent( const PageFaultInfo& info, bool& handled )
 {
 	pxAssert( eeMem );
@@ -981,6 +1090,21 @@ void mmap_PageFaultHandler::OnPageFaultEvent( const PageFaultInfo& info, bool& h
 	uptr offset = info.addr - (uptr)eeMem->Main;
 	if( offset >= Ps2MemSize::MainRam ) return;
 
+	const uint rampage = offset >> 12;
+	const u8 watch = m_PageWatchInfo[rampage];
+	if( watch != 0 && !(watch & Watch_Disarmed) )
+	{
+		mmap_WatchpointFault( offset, info.write );
+
+		// If the page also holds recompiled code, the access may have been a write to it; in
+		// that case it faults again on the block tracking protection and is handled below.
+		m_PageWatchInfo[rampage] |= Watch_Disarmed;
+		mmap_ProtectRamPage( rampage );
+		Source_PageFault->RequestStep( mmap_RearmWatchpoint, rampage );
+		handled = true;
+		return;
+	}
+
 	mmap_ClearCpuBlock( offset );
 	handled = true;
 }
@@ -994,4 +1118,133 @@ void mmap_ResetBlockTracking()
 	//DbgCon.WriteLn( "vtlb/mmap: Block Tracking reset..." );
 	memzero( m_PageProtectInfo );
 	if (eeMem) HostSys::MemProtect( eeMem->Main, Ps2MemSize::MainRam, PageAccess_ReadWrite() );
+
+	// and put the watchpoints back
+	if (eeMem)
+	{
+		for( u32 rampage : m_WatchedPages )
+		{
+			m_PageWatchInfo[rampage] &= ~Watch_Disarmed;
+			mmap_ProtectRamPage( rampage );
+		}
+	}
+}
+
+// Splits a memcheck into page sized pieces of main RAM; fails if any part of it lies outside.
+static bool mmap_GetWatchRanges( const MemCheck& check, std::vector<mmap_WatchRange>& ranges )
+{
+	const u32 start = standardizeBreakpointAddress( check.start );
+	const u32 end = standardizeBreakpointAddress( check.end );
+	if( end <= start || end - start > Ps2MemSize::MainRam ) return false;
+
+	const size_t first = ranges.size();
+	for( u32 addr = start; addr < end; )
+	{
+		const u32 next = std::min( (addr & ~0xfff) + 0x1000, end );
+		const uptr offset = (uptr)PSM( addr ) - (uptr)eeMem->Main;
+		if( PSM( addr ) == NULL || offset >= Ps2MemSize::MainRam )
+		{
+			ranges.resize( first );
+			return false;
+		}
+
+		mmap_WatchRange range = { (u32)offset, (u32)offset + (next - addr), addr, check.cond, check.result };
+		ranges.push_back( range );
+		addr = next;
+	}
+
+	return true;
+}
+
+// Rebuilds the page watchpoints from the current memchecks.  Must be called with the EE paused.
+void mmap_UpdateWatchpoints()
+{
+	const std::vector<MemCheck> checks = CBreakPoints::GetMemChecks();
+
+	// drop the old watches first
+	std::vector<u32> oldPages;
+	oldPages.swap( m_WatchedPages );
+	for( u32 rampage : oldPages )
+		m_PageWatchInfo[rampage] = 0;
+
+	m_WatchRanges.clear();
+	m_WatchedChecks.clear();
+	m_WatchHitCount = 0;
+	m_InlineMemchecks = 0;
+
+	for( const MemCheck& check : checks )
+	{
+		if( check.result == 0 ) continue;
+
+		if( !eeMem || !mmap_GetWatchRanges( check, m_WatchRanges ) )
+		{
+			++m_InlineMemchecks;
+			continue;
+		}
+		m_WatchedChecks.push_back( std::make_pair( check.start, check.end ) );
+	}
+
+	for( const mmap_WatchRange& range : m_WatchRanges )
+	{
+		const uint rampage = range.begin >> 12;
+		if( m_PageWatchInfo[rampage] == 0 )
+			m_WatchedPages.push_back( rampage );
+		if( range.cond & MEMCHECK_READ )
+			m_PageWatchInfo[rampage] |= Watch_Read;
+		if( range.cond & MEMCHECK_WRITE )
+			m_PageWatchInfo[rampage] |= Watch_Write;
+	}
+
+	if( !eeMem ) return;
+
+	for( u32 rampage : oldPages )
+		mmap_ProtectRamPage( rampage );
+	for( u32 rampage : m_WatchedPages )
+		mmap_ProtectRamPage( rampage );
+
+	if( !m_WatchedPages.empty() )
+		DevCon.WriteLn( "(mmap) Watching %u pages for %u memchecks, %u checked inline.", (uint)m_WatchedPages.size(), (uint)m_WatchedChecks.size(), m_InlineMemchecks );
+}
+
+// True if the memcheck is handled by page protection and needs no checks in the code.
+bool mmap_IsPageWatchpoint( u32 start, u32 end )
+{
+	for( const auto& check : m_WatchedChecks )
+	{
+		if( check.first == start && check.second == end ) return true;
+	}
+	return false;
+}
+
+uint mmap_GetInlineMemcheckCount()
+{
+	return m_InlineMemchecks;
+}
+
+// Called from the event test: logs the hits recorded by the fault handler.
+// Returns true if emulation should break.
+bool mmap_CheckWatchpoints()
+{
+	if( m_WatchHitCount == 0 ) return false;
+
+	bool doBreak = false;
+	const uint count = std::min<uint>( m_WatchHitCount, ArraySize(m_WatchHits) );
+	for( uint i = 0; i < count; ++i )
+	{
+		const mmap_WatchHit& hit = m_WatchHits[i];
+		if( hit.result & MEMCHECK_LOG )
+		{
+			if( hit.access == Watch_Write )
+				DevCon.WriteLn( "Hit store breakpoint @0x%x (block @0x%x)", hit.addr, hit.pc );
+			else
+				DevCon.WriteLn( "Hit load breakpoint @0x%x (block @0x%x)", hit.addr, hit.pc );
+		}
+		if( hit.result & MEMCHECK_BREAK )
+			doBreak = true;
+	}
+	if( m_WatchHitCount > count )
+		DevCon.WriteLn( "... and %u more breakpoint hits", m_WatchHitCount - count );
+
+	m_WatchHitCount = 0;
+	return doBreak;
 }
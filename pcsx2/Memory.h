@@ -128,6 +128,11 @@ extern vtlb_ProtectionMode mmap_GetRamPageInfo( u32 paddr );
 extern void mmap_MarkCountedRamPage( u32 paddr );
 extern void mmap_ResetBlockTracking();
 
+extern void mmap_UpdateWatchpoints();
+extern bool mmap_IsPageWatchpoint( u32 start, u32 end );
+extern uint mmap_GetInlineMemcheckCount();
+extern bool mmap_CheckWatchpoints();
+
 #define memRead8 vtlb_memRead<mem8_t>
 #define memRead16 vtlb_memRead<mem16_t>
 #define memRead32 vtlb_memRead<mem32_t>
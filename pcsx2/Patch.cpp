@@ -133,19 +133,20 @@ void TrimPatches(wxString& s)
 
 // This routine loads patches from the game database (but not the config/game fixes/hacks)
 // Returns number of patches loaded
-int LoadPatchesFromGamesDB(const wxString& crc, const Game_Data& game)
+int LoadPatchesFromGamesDB(const wxString& crc, const GameDataView& game)
 {
 	bool patchFound = false;
 	wxString patch;
 
 	if (game.IsOk())
 	{
-		if (game.sectionExists(L"patches", crc)) {
-			patch = game.getSection(L"patches", crc);
+		const wxString section(L"[patches" + wxString(crc.empty() ? L"" : L" = ") + crc + L"]");
+		if (game.keyExists(section.utf8_str())) {
+			patch = fromUTF8(game.getString(section.utf8_str()));
 			patchFound = true;
 		}
-		else if (game.keyExists(L"[patches]")) {
-			patch = game.getString(L"[patches]");
+		else if (game.keyExists("[patches]")) {
+			patch = fromUTF8(game.getString("[patches]"));
 			patchFound = true;
 		}
 	}
@@ -102,7 +102,7 @@ namespace PatchFunc
 // The following LoadPatchesFrom* functions:
 // - do not reset/unload previously loaded patches (use ForgetLoadedPatches() for that)
 // - do not actually patch the emulation memory (that happens at ApplyLoadedPatches(...) )
-extern int  LoadPatchesFromGamesDB(const wxString& name, const Game_Data& game);
+extern int  LoadPatchesFromGamesDB(const wxString& name, const GameDataView& game);
 extern int  LoadPatchesFromDir(wxString name, const wxDirName& folderName, const wxString& friendlyName);
 extern int  LoadPatchesFromZip(wxString gameCRC, const wxString& cheatsArchiveFilename);
 
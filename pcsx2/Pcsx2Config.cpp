@@ -428,8 +428,12 @@ Pcsx2Config::Pcsx2Config()
 	// Set defaults for fresh installs / reset settings
 	McdEnableEjection = true;
 	McdFolderAutoManage = true;
+	McdFolderLazyIndex = true;
 	EnablePatches = true;
 	BackupSavestate = true;
+	CdvdDiscCacheSize = 128;
+	RewindInterval = 30;
+	RewindBufferSize = 256;
 }
 
 void Pcsx2Config::LoadSave( IniInterface& ini )
@@ -442,6 +446,8 @@ void Pcsx2Config::LoadSave( IniInterface& ini )
 	IniBitBool( EnablePatches );
 	IniBitBool( EnableCheats );
 	IniBitBool( EnableIPC );
+	IniBitBool( EnableRamExport );
+	IniBitBool( EnableRewind );
 	IniBitBool( EnableWideScreenPatches );
 #ifndef DISABLE_RECORDING
 	IniBitBool( EnableRecordingTools );
@@ -450,11 +456,19 @@ void Pcsx2Config::LoadSave( IniInterface& ini )
 	IniBitBool( HostFs );
 
 	IniBitBool( BackupSavestate );
+	IniBitBool( IncrementalSavestates );
 	IniBitBool( McdEnableEjection );
 	IniBitBool( McdFolderAutoManage );
+	IniBitBool( McdFolderLazyIndex );
 	IniBitBool( MultitapPort0_Enabled );
 	IniBitBool( MultitapPort1_Enabled );
 
+	IniEntry( CdvdDiscCacheSize );
+	if (ini.IsLoading())
+		CdvdDiscCacheSize = std::min(std::max(CdvdDiscCacheSize, 4u), 1024u);
+	IniEntry( RewindInterval );
+	IniEntry( RewindBufferSize );
+
 	// Process various sub-components:
 
 	Speedhacks		.LoadSave( ini );
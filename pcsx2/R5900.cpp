@@ -783,7 +783,8 @@ int isBreakpointNeeded(u32 addr)
 
 int isMemcheckNeeded(u32 pc)
 {
-	if (CBreakPoints::GetNumMemchecks() == 0)
+	// memchecks on main RAM are handled by page protection, see mmap_UpdateWatchpoints()
+	if (mmap_GetInlineMemcheckCount() == 0)
 		return 0;
 	
 	u32 addr = pc;
@@ -51,6 +51,8 @@ void SaveStateBase::InputRecordingFreeze()
 			// Explicitly set the frame change tracking variable as to not
 			// detect saving or loading a savestate as a frame being drawn
 			g_InputRecordingControls.SetFrameCountTracker(g_FrameCount);
+			// Get the frames recorded so far on their way to the file
+			g_InputRecording.GetInputRecordingData().Flush();
 
 			if (IsLoading())
 				g_InputRecording.SetFrameCounter(g_FrameCount);
@@ -373,11 +375,11 @@ wxString InputRecording::resolveGameName()
 	{
 		if (IGameDatabase* GameDB = AppHost_GetGameDatabase())
 		{
-			Game_Data game;
+			GameDataView game;
 			if (GameDB->findGame(game, gameKey))
 			{
-				gameName = game.getString("Name");
-				gameName += L" (" + game.getString("Region") + L")";
+				gameName = fromUTF8(game.getString("Name"));
+				gameName += L" (" + fromUTF8(game.getString("Region")) + L")";
 			}
 		}
 	}
@@ -24,6 +24,15 @@
 #include "InputRecordingFile.h"
 #include "Utilities/InputRecordingLogger.h"
 
+#ifdef _WIN32
+#include <wx/msw/wrapwin.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 void InputRecordingFileHeader::Init()
 {
 	memset(author, 0, ArraySize(author));
@@ -58,12 +67,40 @@ bool InputRecordingFile::Close()
 	{
 		return false;
 	}
+
+	// The writer drains the queue before exiting
+	if (writerThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(bufferLock);
+			queueCurrentChunk();
+			writerExit = true;
+		}
+		writerWake.notify_one();
+		writerThread.join();
+	}
+	writerExit = false;
+	fileFrames = 0;
+
+	unmapFile();
 	fclose(recordingFile);
 	recordingFile = nullptr;
 	filename = "";
 	return true;
 }
 
+void InputRecordingFile::Flush(bool wait)
+{
+	if (recordingFile == nullptr)
+	{
+		return;
+	}
+	std::unique_lock<std::mutex> lock(bufferLock);
+	queueCurrentChunk();
+	if (wait)
+		writerDone.wait(lock, [this]() { return writeQueue.empty(); });
+}
+
 const wxString &InputRecordingFile::GetFilename()
 {
 	return filename;
@@ -91,13 +128,9 @@ bool InputRecordingFile::FromSaveState()
 
 void InputRecordingFile::IncrementUndoCount()
 {
+	std::lock_guard<std::mutex> lock(bufferLock);
 	undoCount++;
-	if (recordingFile == nullptr)
-	{
-		return;
-	}
-	fseek(recordingFile, seekpointUndoCount, SEEK_SET);
-	fwrite(&undoCount, 4, 1, recordingFile);
+	headerDirty = true;
 }
 
 bool InputRecordingFile::open(const wxString path, bool newRecording)
@@ -110,6 +143,7 @@ bool InputRecordingFile::open(const wxString path, bool newRecording)
 			totalFrames = 0;
 			undoCount = 0;
 			header.Init();
+			writerThread = std::thread(&InputRecordingFile::writerProc, this);
 			return true;
 		}
 	}
@@ -118,6 +152,13 @@ bool InputRecordingFile::open(const wxString path, bool newRecording)
 		if (verifyRecordingFileHeader())
 		{
 			filename = path;
+			if (fseek(recordingFile, 0, SEEK_END) == 0)
+			{
+				const long blocks = ftell(recordingFile) - getRecordingBlockSeekPoint(0);
+				fileFrames = blocks > 0 ? (blocks + inputBytesPerFrame - 1) / inputBytesPerFrame : 0;
+			}
+			mapFile(path);
+			writerThread = std::thread(&InputRecordingFile::writerProc, this);
 			return true;
 		}
 		Close();
@@ -164,13 +205,8 @@ bool InputRecordingFile::ReadKeyBuffer(u8 &result, const uint &frame, const uint
 		return false;
 	}
 
-	long seek = getRecordingBlockSeekPoint(frame) + controllerInputBytes * port + bufIndex;
-	if (fseek(recordingFile, seek, SEEK_SET) != 0 || fread(&result, 1, 1, recordingFile) != 1)
-	{
-		return false;
-	}
-
-	return true;
+	std::lock_guard<std::mutex> lock(bufferLock);
+	return readFrame(frame, controllerInputBytes * port + bufIndex, 1, &result);
 }
 
 void InputRecordingFile::SetTotalFrames(long frame)
@@ -179,9 +215,9 @@ void InputRecordingFile::SetTotalFrames(long frame)
 	{
 		return;
 	}
+	std::lock_guard<std::mutex> lock(bufferLock);
 	totalFrames = frame;
-	fseek(recordingFile, seekpointTotalFrames, SEEK_SET);
-	fwrite(&totalFrames, 4, 1, recordingFile);
+	headerDirty = true;
 }
 
 bool InputRecordingFile::WriteHeader()
@@ -190,6 +226,7 @@ bool InputRecordingFile::WriteHeader()
 	{
 		return false;
 	}
+	std::lock_guard<std::mutex> lock(fileLock);
 	rewind(recordingFile);
 	if (fwrite(&header, sizeof(InputRecordingFileHeader), 1, recordingFile) != 1
 		|| fwrite(&totalFrames, 4, 1, recordingFile) != 1
@@ -208,14 +245,31 @@ bool InputRecordingFile::WriteKeyBuffer(const uint &frame, const uint port, cons
 		return false;
 	}
 
-	long seek = getRecordingBlockSeekPoint(frame) + 18 * port + bufIndex;
+	std::lock_guard<std::mutex> lock(bufferLock);
 
-	if (fseek(recordingFile, seek, SEEK_SET) != 0 || fwrite(&buf, 1, 1, recordingFile) != 1)
+	// Start a new chunk when the frames stop being consecutive (a savestate was loaded)
+	// or when the current one is big enough
+	long chunkFrames = currentChunk.data.size() / inputBytesPerFrame;
+	const long nextFrame = currentChunk.firstFrame + chunkFrames;
+	if (chunkFrames > 0 && ((long)frame < currentChunk.firstFrame || (long)frame > nextFrame ||
+							((long)frame == nextFrame && chunkFrames >= framesPerChunk)))
 	{
-		return false;
+		queueCurrentChunk();
+		chunkFrames = 0;
 	}
 
-	fflush(recordingFile);
+	if (chunkFrames == 0)
+		currentChunk.firstFrame = frame;
+
+	if ((long)frame == currentChunk.firstFrame + chunkFrames)
+	{
+		// Keep what's already recorded for the bytes of this frame that won't be written
+		u8 previous[inputBytesPerFrame] = {};
+		readFrame(frame, 0, inputBytesPerFrame, previous);
+		currentChunk.data.insert(currentChunk.data.end(), previous, previous + inputBytesPerFrame);
+	}
+
+	currentChunk.data[(frame - currentChunk.firstFrame) * inputBytesPerFrame + controllerInputBytes * port + bufIndex] = buf;
 	return true;
 }
 
@@ -224,6 +278,153 @@ long InputRecordingFile::getRecordingBlockSeekPoint(const long &frame)
 	return headerSize + sizeof(bool) + frame * inputBytesPerFrame;
 }
 
+void InputRecordingFile::queueCurrentChunk()
+{
+	if (currentChunk.data.empty() && !headerDirty)
+	{
+		return;
+	}
+	currentChunk.totalFrames = totalFrames;
+	currentChunk.undoCount = undoCount;
+	writeQueue.push_back(std::move(currentChunk));
+	currentChunk = FrameChunk();
+	headerDirty = false;
+	writerWake.notify_one();
+}
+
+bool InputRecordingFile::readFrame(long frame, uint offset, uint size, u8* dst)
+{
+	// Newest data first: the chunk being recorded, then the ones waiting for the writer
+	auto fromChunk = [&](const FrameChunk& chunk) {
+		const long frames = chunk.data.size() / inputBytesPerFrame;
+		if (frame < chunk.firstFrame || frame >= chunk.firstFrame + frames)
+			return false;
+		memcpy(dst, &chunk.data[(frame - chunk.firstFrame) * inputBytesPerFrame + offset], size);
+		return true;
+	};
+
+	if (fromChunk(currentChunk))
+		return true;
+	for (auto it = writeQueue.rbegin(); it != writeQueue.rend(); ++it)
+	{
+		if (fromChunk(*it))
+			return true;
+	}
+
+	if (frame >= fileFrames)
+		return false;
+
+	const long seek = getRecordingBlockSeekPoint(frame) + offset;
+	if (mappedData != nullptr && (size_t)seek + size <= mappedSize)
+	{
+		memcpy(dst, mappedData + seek, size);
+		return true;
+	}
+
+	// Written after the file was mapped
+	std::lock_guard<std::mutex> lock(fileLock);
+	return fseek(recordingFile, seek, SEEK_SET) == 0 && fread(dst, size, 1, recordingFile) == 1;
+}
+
+void InputRecordingFile::writerProc()
+{
+	std::unique_lock<std::mutex> lock(bufferLock);
+	while (true)
+	{
+		writerWake.wait(lock, [this]() { return writerExit || !writeQueue.empty(); });
+		if (writeQueue.empty())
+			break;
+
+		// The chunk stays in the queue, and readable, until it's in the file.
+		// Only the front is ever removed, by this thread.
+		const FrameChunk& chunk = writeQueue.front();
+		lock.unlock();
+
+		bool ok = true;
+		{
+			std::lock_guard<std::mutex> file(fileLock);
+			if (!chunk.data.empty())
+			{
+				ok = fseek(recordingFile, getRecordingBlockSeekPoint(chunk.firstFrame), SEEK_SET) == 0
+					&& fwrite(chunk.data.data(), chunk.data.size(), 1, recordingFile) == 1;
+			}
+			ok = ok && fseek(recordingFile, seekpointTotalFrames, SEEK_SET) == 0
+				&& fwrite(&chunk.totalFrames, 4, 1, recordingFile) == 1
+				&& fwrite(&chunk.undoCount, 4, 1, recordingFile) == 1;
+			fflush(recordingFile);
+		}
+		if (!ok)
+			inputRec::consoleLog(fmt::format("Input recording file write failed. Error - {}", strerror(errno)));
+
+		lock.lock();
+		if (!chunk.data.empty())
+			fileFrames = std::max(fileFrames, chunk.firstFrame + (long)(chunk.data.size() / inputBytesPerFrame));
+		writeQueue.pop_front();
+		writerDone.notify_all();
+	}
+}
+
+void InputRecordingFile::mapFile(const wxString& path)
+{
+#ifdef _WIN32
+	HANDLE handle = CreateFileW(path.wc_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (handle == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER size;
+	HANDLE mapping = NULL;
+	if (GetFileSizeEx(handle, &size) && size.QuadPart > 0)
+		mapping = CreateFileMapping(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(handle);
+
+	if (!mapping)
+		return;
+
+	mappedData = (const u8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!mappedData)
+	{
+		CloseHandle(mapping);
+		return;
+	}
+	mappingHandle = mapping;
+	mappedSize = (size_t)size.QuadPart;
+#else
+	int fd = ::open(path.utf8_str(), O_RDONLY);
+	if (fd < 0)
+		return;
+
+	// Shared, so that frames re-recorded over the mapped range show up in it
+	struct stat st;
+	void* mapping = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && st.st_size > 0)
+		mapping = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (mapping == MAP_FAILED)
+		return;
+
+	mappedData = (const u8*)mapping;
+	mappedSize = st.st_size;
+#endif
+}
+
+void InputRecordingFile::unmapFile()
+{
+	if (mappedData == nullptr)
+	{
+		return;
+	}
+#ifdef _WIN32
+	UnmapViewOfFile(mappedData);
+	CloseHandle((HANDLE)mappingHandle);
+	mappingHandle = nullptr;
+#else
+	munmap((void*)mappedData, mappedSize);
+#endif
+	mappedData = nullptr;
+	mappedSize = 0;
+}
+
 bool InputRecordingFile::verifyRecordingFileHeader()
 {
 	if (recordingFile == nullptr)
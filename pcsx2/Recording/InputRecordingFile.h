@@ -21,6 +21,12 @@
 
 #include "PadData.h"
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 // NOTE / TODOs for Version 2
 // - Move fromSavestate, undoCount, and total frames into the header
 
@@ -47,6 +53,10 @@ struct InputRecordingSavestate
 };
 
 // Handles all operations on the input recording file
+//
+// Frames being recorded are kept in memory and written out in large chunks by a
+// background thread, and a recording being replayed is read through a memory mapping
+// of the file, so that neither costs any file I/O on the emulation thread per frame.
 class InputRecordingFile
 {
 public:
@@ -55,6 +65,9 @@ public:
 	// Closes the underlying input recording file, writing the header and 
 	// prepares for a possible new recording to be started
 	bool Close();
+	// Hands the frames recorded so far to the background writer.
+	// Wait also blocks until they are in the file
+	void Flush(bool wait = false);
 	// Retrieve the input recording's filename (not the path)
 	const wxString &GetFilename();
 	// Retrieve the input recording's header which contains high-level metadata on the recording
@@ -95,6 +108,8 @@ private:
 	static const int seekpointTotalFrames = sizeof(InputRecordingFileHeader);
 	static const int seekpointUndoCount = sizeof(InputRecordingFileHeader) + 4;
 	static const int seekpointSaveStateHeader = seekpointUndoCount + 4;
+	// Ten seconds of input at 60fps, written at once
+	static const long framesPerChunk = 600;
 
 	InputRecordingFileHeader header;
 	wxString filename = "";
@@ -105,10 +120,49 @@ private:
 	long totalFrames = 0;
 	unsigned long undoCount = 0;
 
+	// Run of consecutive frames written since the last flush
+	struct FrameChunk
+	{
+		long firstFrame = 0;
+		std::vector<u8> data;
+		// header values at the time of the flush
+		long totalFrames = 0;
+		unsigned long undoCount = 0;
+	};
+
+	// bufferLock protects the current chunk, the queue of chunks waiting for the
+	// writer and fileFrames. fileLock protects recordingFile.
+	std::mutex bufferLock;
+	std::mutex fileLock;
+	std::condition_variable writerWake;
+	std::condition_variable writerDone;
+	std::thread writerThread;
+	bool writerExit = false;
+	FrameChunk currentChunk;
+	std::deque<FrameChunk> writeQueue;
+	bool headerDirty = false;
+	// Number of frames present in the file
+	long fileFrames = 0;
+
+	// Read-only mapping of the file, as it was when it was opened
+	const u8* mappedData = nullptr;
+	size_t mappedSize = 0;
+#ifdef _WIN32
+	void* mappingHandle = nullptr;
+#endif
+
 	// Calculates the position of the current frame in the input recording
 	long getRecordingBlockSeekPoint(const long& frame);
 	bool open(const wxString path, bool newRecording);
 	bool verifyRecordingFileHeader();
+
+	void mapFile(const wxString& path);
+	void unmapFile();
+	void queueCurrentChunk();
+	// Reads part of a frame from wherever its latest data is, bufferLock must be held.
+	// Returns false if the frame was never recorded
+	bool readFrame(long frame, uint offset, uint size, u8* dst);
+	void writerProc();
 };
 
 #endif
@@ -0,0 +1,272 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "Common.h"
+#include "SaveState.h"
+#include "System/SysThreads.h"
+#include "RewindBuffer.h"
+
+#ifdef _WIN32
+#include <zlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+RewindBuffer g_RewindBuffer;
+
+// Captures between two stats lines in the dev console
+static const uint StatsInterval = 300;
+
+RewindBuffer::RewindBuffer()
+	: m_pages(g_DirtyPages, DirtyPageTracker::Checkpoint_Rewind)
+{
+	m_states[0].Name = L"RewindState0";
+	m_states[1].Name = L"RewindState1";
+	m_current = 0;
+	m_current_size = 0;
+	m_has_current = false;
+	memzero(m_region_offset);
+	m_delta_bytes = 0;
+	m_frames = 0;
+	m_total_ticks = 0;
+	m_total_snapshot_bytes = 0;
+	memzero(m_stats);
+}
+
+void RewindBuffer::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	m_deltas.clear();
+	m_delta_bytes = 0;
+	m_has_current = false;
+	m_pages.Reset();
+	m_current_size = 0;
+	m_frames = 0;
+
+	// Keep the state buffers around, they're the same size for the next game.
+	m_xor.clear();
+	m_xor.shrink_to_fit();
+}
+
+void RewindBuffer::OnVsync()
+{
+	if (!EmuConfig.EnableRewind)
+	{
+		if (m_has_current)
+			Clear();
+		return;
+	}
+
+	if (++m_frames < std::max<u32>(EmuConfig.RewindInterval, 1))
+		return;
+	m_frames = 0;
+
+	Capture();
+}
+
+void RewindBuffer::Capture()
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	const u64 start = GetCPUTicks();
+
+	// The other state buffer holds the capture before last.
+	const bool in_place = m_pages.Next() && m_has_current;
+	const bool tracked = m_pages.IsTracked() && m_has_current;
+
+	VmStateBuffer& newer_buf = m_states[m_current ^ 1];
+	memIncrementalSavingState saveme(newer_buf,
+		in_place ? &m_pages.GetCopyPages(DirtyPageTracker::Region_EEMain) : NULL,
+		in_place ? &m_pages.GetCopyPages(DirtyPageTracker::Region_IOPMain) : NULL);
+	saveme.FreezeAll();
+	const uint newer_size = saveme.GetCurrentPos();
+	m_region_offset[DirtyPageTracker::Region_EEMain] = saveme.GetEEMainOffset();
+	m_region_offset[DirtyPageTracker::Region_IOPMain] = saveme.GetIOPMainOffset();
+
+	size_t snapshot_bytes = newer_size;
+	if (m_has_current)
+	{
+		// Backward delta: what it takes to get the current state back from the new one.
+		const u8* older = m_states[m_current].GetPtr();
+		const u8* newer = newer_buf.GetPtr();
+
+		Delta delta;
+		delta.size = m_current_size;
+		m_xor.clear();
+
+		for (uint offset = 0; offset < m_current_size; offset += PageSize)
+		{
+			const uint len = std::min(PageSize, m_current_size - offset);
+			const uint common = offset < newer_size ? std::min(len, newer_size - offset) : 0;
+			if (tracked && common == len && IsCleanPage(offset))
+				continue;
+			if (common == len && memcmp(older + offset, newer + offset, len) == 0)
+				continue;
+
+			delta.pages.push_back(offset / PageSize);
+
+			const size_t pos = m_xor.size();
+			m_xor.resize(pos + len);
+			u8* dst = &m_xor[pos];
+			for (uint i = 0; i < common; i++)
+				dst[i] = older[offset + i] ^ newer[offset + i];
+			// past the end of the new state, XOR against zeroes
+			memcpy(dst + common, older + offset + common, len - common);
+		}
+
+		uLongf packed = compressBound(m_xor.size());
+		delta.data.resize(packed);
+		if (!m_xor.empty() && compress2(delta.data.data(), &packed, m_xor.data(), m_xor.size(), Z_BEST_SPEED) != Z_OK)
+		{
+			// The chain is broken without this delta, start over from the new state.
+			Console.Error("(Rewind) Could not compress a snapshot, history cleared.");
+			m_deltas.clear();
+			m_delta_bytes = 0;
+		}
+		else
+		{
+			delta.data.resize(m_xor.empty() ? 0 : packed);
+			delta.data.shrink_to_fit();
+
+			snapshot_bytes = delta.GetMemoryUsage();
+			m_delta_bytes += snapshot_bytes;
+			m_deltas.push_back(std::move(delta));
+		}
+	}
+
+	m_current ^= 1;
+	m_current_size = newer_size;
+	m_has_current = true;
+
+	// Both state buffers count against the budget.
+	Trim(std::max<size_t>((size_t)EmuConfig.RewindBufferSize * _1mb, 2 * (size_t)newer_size) - 2 * newer_size);
+
+	const u64 ticks = GetCPUTicks() - start;
+	m_total_ticks += ticks;
+	m_total_snapshot_bytes += snapshot_bytes;
+
+	m_stats.captures++;
+	m_stats.snapshots = m_deltas.size() + 1;
+	m_stats.bytes = m_delta_bytes + m_states[0].GetSizeInBytes() + m_states[1].GetSizeInBytes();
+	m_stats.state_size = newer_size;
+	m_stats.last_capture_ms = ticks * 1000.0 / GetTickFrequency();
+	m_stats.avg_capture_ms = m_total_ticks * 1000.0 / GetTickFrequency() / m_stats.captures;
+	m_stats.last_snapshot_bytes = snapshot_bytes;
+	m_stats.avg_snapshot_bytes = m_total_snapshot_bytes / m_stats.captures;
+
+	if (m_stats.captures % StatsInterval == 0)
+	{
+		DevCon.WriteLn(Color_Gray, "(Rewind) %u states in %.1f MB, capture %.2f ms avg, %u KB per snapshot avg (state is %u KB)",
+			m_stats.snapshots, m_stats.bytes / (double)_1mb, m_stats.avg_capture_ms,
+			(uint)(m_stats.avg_snapshot_bytes / _1kb), m_stats.state_size / _1kb);
+	}
+}
+
+// True for a state page in EE or IOP main memory that wasn't written since the last capture.
+bool RewindBuffer::IsCleanPage(uint offset) const
+{
+	for (uint i = 0; i < DirtyPageTracker::Region_Count; i++)
+	{
+		const uint begin = m_region_offset[i];
+		const uint size = g_DirtyPages.GetRegionSize((DirtyPageTracker::RegionId)i);
+		if (offset < begin || offset >= begin + size)
+			continue;
+
+		const std::vector<u32>& dirty = m_pages.GetDirtyPages((DirtyPageTracker::RegionId)i);
+		return !std::binary_search(dirty.begin(), dirty.end(), (offset - begin) / PageSize);
+	}
+	return false;
+}
+
+void RewindBuffer::RestoreDelta(const Delta& delta)
+{
+	VmStateBuffer& buf = m_states[m_current];
+
+	buf.MakeRoomFor(delta.size);
+	if (delta.size > m_current_size)
+		memset(buf.GetPtr(m_current_size), 0, delta.size - m_current_size);
+
+	size_t raw = 0;
+	for (u32 page : delta.pages)
+		raw += std::min(PageSize, delta.size - page * PageSize);
+
+	m_xor.resize(raw);
+	uLongf unpacked = raw;
+	if (raw && (uncompress(m_xor.data(), &unpacked, delta.data.data(), delta.data.size()) != Z_OK || unpacked != raw))
+		pxFailRel("(Rewind) Corrupted snapshot in the rewind buffer");
+
+	const u8* src = m_xor.data();
+	u8* dst = buf.GetPtr();
+	for (u32 page : delta.pages)
+	{
+		const uint offset = page * PageSize;
+		const uint len = std::min(PageSize, delta.size - offset);
+		for (uint i = 0; i < len; i++)
+			dst[offset + i] ^= src[i];
+		src += len;
+	}
+
+	m_current_size = delta.size;
+}
+
+bool RewindBuffer::Rewind()
+{
+	pxAssertDev(GetCoreThread().IsPaused(), "CoreThread is not paused; cannot rewind.");
+
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	if (!m_has_current)
+		return false;
+
+	const u64 start = GetCPUTicks();
+
+	memLoadingState loadme(m_states[m_current]);
+	loadme.FreezeAll();
+
+	// The oldest state stays, rewinding further just reloads it.
+	if (!m_deltas.empty())
+	{
+		RestoreDelta(m_deltas.back());
+		m_delta_bytes -= m_deltas.back().GetMemoryUsage();
+		m_deltas.pop_back();
+	}
+
+	// Next capture is a full interval from here, and a whole one: the other state
+	// buffer is stale now.
+	m_frames = 0;
+	m_pages.Reset();
+	m_stats.snapshots = m_deltas.size() + 1;
+
+	Console.WriteLn(Color_StrongBlue, "(Rewind) Restored state in %.2f ms, %u left",
+		(GetCPUTicks() - start) * 1000.0 / GetTickFrequency(), (uint)m_deltas.size());
+	return true;
+}
+
+RewindBuffer::Stats RewindBuffer::GetStats()
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_stats;
+}
+
+void RewindBuffer::Trim(size_t budget)
+{
+	while (!m_deltas.empty() && m_delta_bytes > budget)
+	{
+		m_delta_bytes -= m_deltas.front().GetMemoryUsage();
+		m_deltas.pop_front();
+	}
+}
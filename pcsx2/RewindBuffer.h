@@ -0,0 +1,118 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "System.h"
+#include "DirtyPageTracker.h"
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// --------------------------------------------------------------------------------------
+//  RewindBuffer
+// --------------------------------------------------------------------------------------
+// Keeps the recent history of the virtual machine in memory, one state every
+// EmuConfig.RewindInterval frames, within EmuConfig.RewindBufferSize megabytes.
+//
+// Only the newest state is kept whole.  Each older state is stored as the list of 4KB pages
+// that differ from the state that follows it, XORed against that state and deflated.  Most
+// of a state doesn't change over a few frames, so a snapshot costs a small fraction of a
+// full state.  Rewinding loads the newest state, then rebuilds the one before it from the
+// newest delta, so that the next rewind goes further back.  When over budget, the oldest
+// deltas are dropped.
+//
+// Captures are incremental: DirtyPageTracker tells which pages of EE and IOP main memory
+// were written since the last capture, and only those are copied into the state buffer
+// (which still holds the capture before last) and compared against the newest state.
+//
+// States are captured by the core thread at vsync, at the same point the VM stops for a
+// regular savestate.  Rewind() loads a state and must be called with the VM paused.
+//
+class RewindBuffer
+{
+	DeclareNoncopyableObject(RewindBuffer);
+
+public:
+	static const uint PageSize = 4096;
+
+	struct Stats
+	{
+		uint snapshots;			// states that can be rewound to
+		size_t bytes;			// memory held by the buffer
+		uint state_size;		// size of one uncompressed state
+		u64 captures;
+		double last_capture_ms;
+		double avg_capture_ms;
+		size_t last_snapshot_bytes;
+		size_t avg_snapshot_bytes;
+	};
+
+protected:
+	struct Delta
+	{
+		uint size;					// size of the state this delta rebuilds
+		std::vector<u32> pages;		// pages that differ from the following state, ascending
+		std::vector<u8> data;		// deflated XOR of those pages
+
+		size_t GetMemoryUsage() const { return sizeof(Delta) + pages.size() * sizeof(u32) + data.size(); }
+	};
+
+	std::mutex m_lock;
+
+	// The newest state, and the one being captured
+	VmStateBuffer m_states[2];
+	uint m_current;
+	uint m_current_size;
+	bool m_has_current;
+
+	// Main memory pages to write into the state buffer being captured
+	DirtyPageSwapChain m_pages;
+	// offsets of EE and IOP main memory in a state
+	uint m_region_offset[DirtyPageTracker::Region_Count];
+
+	std::deque<Delta> m_deltas;
+	size_t m_delta_bytes;
+	std::vector<u8> m_xor;
+
+	uint m_frames;
+
+	u64 m_total_ticks;
+	u64 m_total_snapshot_bytes;
+	Stats m_stats;
+
+public:
+	RewindBuffer();
+	virtual ~RewindBuffer() = default;
+
+	void Clear();
+
+	// Called by the core thread at every vsync, captures a state when one is due.
+	void OnVsync();
+
+	// Loads the newest state and steps back the history.  Returns false if there's nothing to load.
+	bool Rewind();
+
+	Stats GetStats();
+
+protected:
+	void Capture();
+	bool IsCleanPage(uint offset) const;
+	void RestoreDelta(const Delta& delta);
+	void Trim(size_t budget);
+};
+
+extern RewindBuffer g_RewindBuffer;
@@ -27,6 +27,7 @@
 
 #include "Elfheader.h"
 #include "Counters.h"
+#include "DirtyPageTracker.h"
 
 #include "Utilities/SafeArray.inl"
 #include "SPU2/spu2.h"
@@ -37,6 +38,9 @@ using namespace R5900;
 static void PreLoadPrep()
 {
 	SysClearExecutionCache();
+
+	// Memory no longer matches any state saved before, the next incremental save is whole.
+	g_DirtyPages.Invalidate();
 }
 
 static void PostLoadPrep()
@@ -318,7 +322,51 @@ memLoadingState::memLoadingState( const SafeArray<u8>* load_from )
 // Loading of state data from a memory buffer...
 void memLoadingState::FreezeMem( void* data, int size )
 {
+	PrepBlock( size );
+
 	const u8* const src = m_memory->GetPtr(m_idx);
 	m_idx += size;
 	memcpy( data, src, size );
 }
+
+// --------------------------------------------------------------------------------------
+//  memIncrementalSavingState  (implementations)
+// --------------------------------------------------------------------------------------
+memIncrementalSavingState::memIncrementalSavingState( VmStateBuffer& save_to, const std::vector<u32>* ee_pages, const std::vector<u32>* iop_pages )
+	: memSavingState( save_to )
+{
+	m_ee_pages = ee_pages;
+	m_iop_pages = iop_pages;
+	m_ee_offset = 0;
+	m_iop_offset = 0;
+}
+
+// Same layout as SaveStateBase::FreezeMainMemory.
+SaveStateBase& memIncrementalSavingState::FreezeMainMemory()
+{
+	vu1Thread.WaitVU(); // Finish VU1 just in-case...
+	m_memory->MakeRoomFor( m_idx + MainMemorySizeInBytes );
+
+	m_ee_offset = m_idx;
+	FreezePages(eeMem->Main,	Ps2MemSize::MainRam, m_ee_pages);
+	FreezeMem(eeMem->Scratch,	Ps2MemSize::Scratch);
+	FreezeMem(eeHw,				Ps2MemSize::Hardware);
+
+	m_iop_offset = m_idx;
+	FreezePages(iopMem->Main,	Ps2MemSize::IopRam, m_iop_pages);
+	FreezeMem(iopHw,			Ps2MemSize::IopHardware);
+
+	FreezeMem(vuRegs[0].Micro,	VU0_PROGSIZE);
+	FreezeMem(vuRegs[0].Mem,	VU0_MEMSIZE);
+
+	FreezeMem(vuRegs[1].Micro,	VU1_PROGSIZE);
+	FreezeMem(vuRegs[1].Mem,	VU1_MEMSIZE);
+
+	return *this;
+}
+
+void memIncrementalSavingState::FreezePages( u8* src, uint size, const std::vector<u32>* pages )
+{
+	DirtyPageTracker::CopyPages(m_memory->GetPtr(m_idx), src, size, pages);
+	m_idx += size;
+}
@@ -162,6 +162,34 @@ protected:
 	void InputRecordingFreeze();
 };
 
+// --------------------------------------------------------------------------------------
+//  VmStateFixedBuffer
+// --------------------------------------------------------------------------------------
+// A VmStateBuffer over memory owned by the caller (a libretro frontend's savestate buffer,
+// for example), so memSavingState writes and memLoadingState reads it in place.  It never
+// reallocates: a state that doesn't fit throws Exception::OutOfMemory.
+//
+class VmStateFixedBuffer : public VmStateBuffer
+{
+public:
+	VmStateFixedBuffer( void* mem, uint size, const wxChar* name = L"Fixed Savestate Buffer" )
+		: VmStateBuffer( name, (u8*)mem, size )
+	{
+	}
+
+	virtual ~VmStateFixedBuffer()
+	{
+		// not ours to free.
+		m_ptr = NULL;
+	}
+
+protected:
+	u8* _virtual_realloc( int newsize )
+	{
+		return (newsize <= m_size) ? m_ptr : NULL;
+	}
+};
+
 // --------------------------------------------------------------------------------------
 //  Saving and Loading Specialized Implementations...
 // --------------------------------------------------------------------------------------
@@ -201,3 +229,34 @@ public:
 	bool IsFinished() const { return m_idx >= m_memory->GetSizeInBytes(); }
 };
 
+// --------------------------------------------------------------------------------------
+//  memIncrementalSavingState
+// --------------------------------------------------------------------------------------
+// Saves a full state into a buffer that already holds an earlier state of this VM, writing
+// only the given pages of EE and IOP main memory and leaving the others as they are.  The
+// result is a regular state that memLoadingState loads.  The caller gets the pages from
+// DirtyPageSwapChain and must make sure they cover every page written since the state that
+// is in the buffer; a NULL list writes the whole region.
+//
+class memIncrementalSavingState : public memSavingState
+{
+protected:
+	const std::vector<u32>* m_ee_pages;
+	const std::vector<u32>* m_iop_pages;
+
+	uint m_ee_offset;
+	uint m_iop_offset;
+
+public:
+	virtual ~memIncrementalSavingState() = default;
+	memIncrementalSavingState( VmStateBuffer& save_to, const std::vector<u32>* ee_pages, const std::vector<u32>* iop_pages );
+
+	SaveStateBase& FreezeMainMemory();
+
+	// Where EE and IOP main memory went in the state.
+	uint GetEEMainOffset() const { return m_ee_offset; }
+	uint GetIOPMainOffset() const { return m_iop_offset; }
+
+protected:
+	void FreezePages( u8* src, uint size, const std::vector<u32>* pages );
+};
@@ -0,0 +1,176 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "Common.h"
+#include "IopMem.h"
+#include "SharedMemoryExport.h"
+
+#include <atomic>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace SharedMemoryExport
+{
+	static const u32 HeaderSize = 4096;
+
+	static const u32 EEOffset = HeaderSize;
+	static const u32 IOPOffset = EEOffset + Ps2MemSize::MainRam;
+	static const u32 ObjectSize = IOPOffset + Ps2MemSize::IopRam;
+
+	static Header* s_header = NULL;
+
+#ifndef _WIN32
+	static int s_fd = -1;
+	// "/pcsx2_ram.<pid>", so that several instances don't share one object.
+	static char s_name[32];
+	// The whole object, mapped once more for the copies done while (re)mapping.
+	static u8* s_view = NULL;
+
+	// Replaces the mapping at dst with the given part of the object, keeping the contents.
+	static bool MapShared(u8* dst, u32 offset, u32 size)
+	{
+		memcpy(s_view + offset, dst, size);
+		return mmap(dst, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, s_fd, offset) != MAP_FAILED;
+	}
+
+	static bool MapPrivate(u8* dst, u32 size)
+	{
+		if (mmap(dst, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED)
+			return false;
+		memcpy(dst, s_view + (dst == eeMem->Main ? EEOffset : IOPOffset), size);
+		return true;
+	}
+
+	static void Close()
+	{
+		if (s_view)
+			munmap(s_view, ObjectSize);
+		if (s_fd >= 0)
+		{
+			// only unlink what we created, the name may belong to someone else on failure
+			close(s_fd);
+			shm_unlink(s_name);
+		}
+
+		s_view = NULL;
+		s_fd = -1;
+		s_header = NULL;
+	}
+
+	void Attach()
+	{
+		// Memory reset only clears the ranges, they stay mapped on the object.  Decommitting
+		// them goes through Detach first.
+		if (s_header)
+			return;
+
+		snprintf(s_name, sizeof(s_name), "/pcsx2_ram.%d", (int)getpid());
+		s_fd = shm_open(s_name, O_CREAT | O_EXCL | O_RDWR, 0600);
+		if (s_fd < 0)
+		{
+			Console.Error("(SharedMemoryExport) Could not create %s: %s", s_name, strerror(errno));
+			return;
+		}
+		if (ftruncate(s_fd, ObjectSize) != 0)
+		{
+			Console.Error("(SharedMemoryExport) Could not size %s: %s", s_name, strerror(errno));
+			Close();
+			return;
+		}
+
+		void* view = mmap(NULL, ObjectSize, PROT_READ | PROT_WRITE, MAP_SHARED, s_fd, 0);
+		if (view == MAP_FAILED)
+		{
+			Console.Error("(SharedMemoryExport) Could not map %s: %s", s_name, strerror(errno));
+			Close();
+			return;
+		}
+		s_view = (u8*)view;
+
+		if (!MapShared(eeMem->Main, EEOffset, Ps2MemSize::MainRam) || !MapShared(iopMem->Main, IOPOffset, Ps2MemSize::IopRam))
+		{
+			// MAP_FIXED failing leaves the old mapping alone, put back whatever got replaced.
+			Console.Error("(SharedMemoryExport) Could not remap guest memory: %s", strerror(errno));
+			MapPrivate(eeMem->Main, Ps2MemSize::MainRam);
+			MapPrivate(iopMem->Main, Ps2MemSize::IopRam);
+			Close();
+			return;
+		}
+
+		s_header = (Header*)s_view;
+		s_header->ee_offset = EEOffset;
+		s_header->ee_size = Ps2MemSize::MainRam;
+		s_header->iop_offset = IOPOffset;
+		s_header->iop_size = Ps2MemSize::IopRam;
+		s_header->frame = 0;
+		s_header->vsync_count = 0;
+		s_header->version = HeaderVersion;
+		std::atomic_thread_fence(std::memory_order_release);
+		s_header->magic = HeaderMagic;
+
+		Console.WriteLn(Color_StrongBlue, "(SharedMemoryExport) Guest memory exported as %s", s_name);
+	}
+
+	void Detach()
+	{
+		if (!s_header)
+			return;
+
+		// readers still attached to the object see a dead header
+		s_header->magic = 0;
+
+		if (eeMem && iopMem)
+		{
+			if (!MapPrivate(eeMem->Main, Ps2MemSize::MainRam) || !MapPrivate(iopMem->Main, Ps2MemSize::IopRam))
+				pxFailRel("(SharedMemoryExport) Could not move guest memory out of the shared object");
+		}
+
+		Close();
+		Console.WriteLn(Color_StrongBlue, "(SharedMemoryExport) Guest memory export closed");
+	}
+#else
+	void Attach()
+	{
+		static bool warned = false;
+		if (!warned)
+			Console.Warning("(SharedMemoryExport) Exporting guest memory is not supported on Windows.");
+		warned = true;
+	}
+
+	void Detach()
+	{
+	}
+#endif
+
+	bool IsAttached()
+	{
+		return s_header != NULL;
+	}
+
+	void OnVsync(u32 frame)
+	{
+		if (!s_header)
+			return;
+
+		s_header->frame = frame;
+		std::atomic_thread_fence(std::memory_order_release);
+		s_header->vsync_count = s_header->vsync_count + 1;
+	}
+}
@@ -0,0 +1,63 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// --------------------------------------------------------------------------------------
+//  SharedMemoryExport
+// --------------------------------------------------------------------------------------
+// Exposes the EE and IOP main memory as a named POSIX shared memory object, so that
+// external tools can read it with no copy through the IPC socket.  The object is named
+// /pcsx2_ram.<pid> after the emulator process, and the name is printed to the console when
+// the export opens.  The guest memory itself lives in the shared object: the EE/IOP main
+// memory ranges are remapped on top of it the first time the VM memory is reset.
+//
+// Layout of the object: a one page header, then EE main memory, then IOP main memory,
+// at the offsets given in the header.
+//
+// The header's vsync counter is bumped by the core at the end of every vsync.  It only
+// tells a reader that a frame boundary went by: the EE and IOP write memory all through
+// the frame, so nothing here makes a copy consistent, even one that saw no vsync.
+//
+// Not available on Windows, where the guest memory can't be remapped in place.
+//
+namespace SharedMemoryExport
+{
+	static const u32 HeaderMagic = 0x4d325350; // "PS2M"
+	static const u32 HeaderVersion = 1;
+
+	struct Header
+	{
+		u32 magic;
+		u32 version;
+		u32 ee_offset;
+		u32 ee_size;
+		u32 iop_offset;
+		u32 iop_size;
+		// both are updated at vsync end, vsync_count after the frame number
+		volatile u32 frame;
+		volatile u32 vsync_count;
+	};
+
+	// Moves the guest main memory into the shared object (creating it as needed).
+	// Called after the VM memory has been reset, while the VM isn't running.
+	extern void Attach();
+	// Moves the guest main memory back to private memory and removes the object.
+	extern void Detach();
+
+	extern bool IsAttached();
+
+	extern void OnVsync(u32 frame);
+}
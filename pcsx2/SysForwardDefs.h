@@ -25,3 +25,4 @@ class SysCoreThread;
 class CpuInitializerSet;
 
 struct Game_Data;
+class GameDataView;
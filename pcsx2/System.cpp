@@ -19,6 +19,8 @@
 #include "VUmicro.h"
 #include "newVif.h"
 #include "MTVU.h"
+#include "SharedMemoryExport.h"
+#include "DirtyPageTracker.h"
 
 #include "Elfheader.h"
 
@@ -355,7 +357,7 @@ static wxString GetMemoryErrorVM()
 
 namespace HostMemoryMap {
 	// For debuggers
-	uptr EEmem, IOPmem, VUmem, EErec, IOPrec, VIF0rec, VIF1rec, mVU0rec, mVU1rec, bumpAllocator;
+	uptr EEmem, IOPmem, VUmem, EErec, IOPrec, VIF0rec, VIF1rec, VIFrecShared, mVU0rec, mVU1rec, bumpAllocator;
 }
 
 /// Attempts to find a spot near static variables for the main memory
@@ -404,6 +406,7 @@ SysMainMemory::SysMainMemory()
 	HostMemoryMap::IOPrec  = base + HostMemoryMap::IOPrecOffset;
 	HostMemoryMap::VIF0rec = base + HostMemoryMap::VIF0recOffset;
 	HostMemoryMap::VIF1rec = base + HostMemoryMap::VIF1recOffset;
+	HostMemoryMap::VIFrecShared = base + HostMemoryMap::VIFrecSharedOffset;
 	HostMemoryMap::mVU0rec = base + HostMemoryMap::mVU0recOffset;
 	HostMemoryMap::mVU1rec = base + HostMemoryMap::mVU1recOffset;
 	HostMemoryMap::bumpAllocator = base + HostMemoryMap::bumpAllocatorOffset;
@@ -454,6 +457,14 @@ void SysMainMemory::ResetAll()
 	m_iop.Reset();
 	m_vu.Reset();
 
+	if (EmuConfig.EnableRamExport)
+		SharedMemoryExport::Attach();
+	else
+		SharedMemoryExport::Detach();
+
+	g_DirtyPages.SetRegion(DirtyPageTracker::Region_EEMain, eeMem->Main, Ps2MemSize::MainRam);
+	g_DirtyPages.SetRegion(DirtyPageTracker::Region_IOPMain, iopMem->Main, Ps2MemSize::IopRam);
+
 	// Note: newVif is reset as part of other VIF structures.
 }
 
@@ -470,6 +481,9 @@ void SysMainMemory::DecommitAll()
 	// to the ring. Let's call it an extra safety valve :)
 	vu1Thread.Reset();
 
+	SharedMemoryExport::Detach();
+	g_DirtyPages.Invalidate();
+
 	m_ee.Decommit();
 	m_iop.Decommit();
 	m_vu.Decommit();
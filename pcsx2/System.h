@@ -67,6 +67,9 @@ namespace HostMemoryMap
 	// newVif1 recompiler code cache area (32mb)
 	static const u32 VIF1recOffset = 0x18000000;
 
+	// newVif recompiler code cache shared by VIF0 and VIF1 (32mb)
+	static const u32 VIFrecSharedOffset = 0x1A000000;
+
 	// microVU1 recompiler code cache area (32 or 64mb)
 	static const u32 mVU0recOffset = 0x1C000000;
 
@@ -97,6 +100,7 @@ public:
 
 	const VirtualMemoryManagerPtr& MainMemory()    { return m_mainMemory; }
 	VirtualMemoryBumpAllocator&    BumpAllocator() { return m_bumpAllocator; }
+	eeMemoryReserve&               EEMemory()      { return m_ee; }
 
 	virtual void ReserveAll();
 	virtual void CommitAll();
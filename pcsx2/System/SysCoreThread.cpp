@@ -23,6 +23,7 @@
 #include "GS.h"
 #include "Elfheader.h"
 #include "Patch.h"
+#include "RewindBuffer.h"
 #include "SysThreads.h"
 #include "MTVU.h"
 #include "IPC.h"
@@ -136,6 +137,8 @@ void SysCoreThread::SetElfOverride(const wxString& elf)
 void SysCoreThread::ResetQuick()
 {
 	Suspend();
+	MIPSAnalyst::CancelAnalysis();
+	g_RewindBuffer.Clear();
 
 	m_resetVirtualMachine = true;
 	m_hasActiveMachine = false;
@@ -248,17 +251,26 @@ void SysCoreThread::VsyncInThread()
 {
 	ApplyLoadedPatches(PPT_CONTINUOUSLY);
 	ApplyLoadedPatches(PPT_COMBINED_0_1);
+
+	g_RewindBuffer.OnVsync();
+}
+
+void SysCoreThread::VsyncEndInThread()
+{
+	if (m_IpcState == ON)
+		m_socketIpc->OnVsyncEnd();
 }
 
 void SysCoreThread::GameStartingInThread()
 {
 	GetMTGS().SendGameCRC(ElfCRC);
 
-	MIPSAnalyst::ScanForFunctions(ElfTextRange.first, ElfTextRange.first + ElfTextRange.second, true);
-	symbolMap.UpdateActiveSymbols();
+	// The debugger gets the functions as they're found, no need to hold up the game for it.
+	MIPSAnalyst::ScanForFunctionsAsync(ElfTextRange.first, ElfTextRange.first + ElfTextRange.second, []() {
 #ifndef __LIBRETRO__
-	sApp.PostAppMethod(&Pcsx2App::resetDebugger);
+		sApp.PostAppMethod(&Pcsx2App::resetDebugger);
 #endif
+	});
 
 	ApplyLoadedPatches(PPT_ONCE_ON_LOAD);
 	ApplyLoadedPatches(PPT_COMBINED_0_1);
@@ -338,6 +350,8 @@ void SysCoreThread::OnResumeInThread(bool isSuspended)
 void SysCoreThread::OnCleanupInThread()
 {
 	m_ExecMode = ExecMode_Closing;
+	MIPSAnalyst::CancelAnalysis();
+	g_RewindBuffer.Clear();
 
 	m_hasActiveMachine = false;
 	m_resetVirtualMachine = true;
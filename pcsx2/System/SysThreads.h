@@ -347,6 +347,7 @@ public:
 
 	virtual bool StateCheckInThread();
 	virtual void VsyncInThread();
+	virtual void VsyncEndInThread();
 	virtual void GameStartingInThread();
 
 	virtual void ApplySettings( const Pcsx2Config& src );
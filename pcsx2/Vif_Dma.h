@@ -111,6 +111,9 @@ extern void vif1Interrupt();
 extern void vif1VUFinish();
 extern void vif1Reset();
 
+// Dev builds: check the VIF unpack recompiler against the interpreter on the next VIF0 reset.
+extern void dVifRequestSelfTest();
+
 typedef int __fastcall FnType_VifCmdHandler(int pass, const u32 *data);
 typedef FnType_VifCmdHandler* Fnptr_VifCmdHandler;
 
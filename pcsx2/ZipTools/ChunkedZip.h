@@ -0,0 +1,116 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <wx/ffile.h>
+#include <vector>
+
+// --------------------------------------------------------------------------------------
+//  ChunkedZipWriter / ChunkedZipReader
+// --------------------------------------------------------------------------------------
+// Zip archives whose deflated entries are compressed and decompressed in parallel.
+//
+// Each deflated entry is cut into ChunkSize pieces, and every piece is deflated on its own
+// (fresh compressor, flushed to a byte boundary), so the pieces concatenate into the single
+// deflate stream any zip reader expects.  The compressed size of each piece is recorded in
+// a private extra field of the entry's central directory record, which is what lets the
+// reader inflate the pieces in parallel.  Archives written by anything else (older PCSX2
+// savestates included) are read one entry per thread instead.
+//
+// Both sides work on memory buffers; savestates are small enough for that.
+//
+class ChunkedZipWriter
+{
+	DeclareNoncopyableObject(ChunkedZipWriter);
+
+public:
+	static const uint ChunkSize = _1mb;
+
+protected:
+	struct Entry
+	{
+		wxString name;
+		bool deflate;
+		const u8* src;
+		uint size;
+		std::vector<u8> stored;		// copy of the data of stored entries
+
+		u32 crc;
+		std::vector<std::vector<u8>> chunks;
+	};
+
+	wxString m_filename;
+	wxFFile m_file;
+	std::vector<Entry> m_entries;
+	uint m_threads;
+
+public:
+	ChunkedZipWriter(const wxString& filename);
+	virtual ~ChunkedZipWriter() = default;
+
+	wxString GetFilename() const { return m_filename; }
+	uint GetThreadCount() const { return m_threads; }
+
+	// Stored entries are copied; deflated entries are referenced and must stay valid
+	// until Close().
+	void AddStored(const wxString& name, const void* data, uint size);
+	void AddDeflated(const wxString& name, const void* data, uint size);
+
+	// Compresses everything and writes the archive.
+	void Close();
+
+protected:
+	void Write(const void* data, size_t size);
+};
+
+class ChunkedZipReader
+{
+	DeclareNoncopyableObject(ChunkedZipReader);
+
+public:
+	struct Entry
+	{
+		wxString name;
+		u16 method;
+		u32 crc;
+		uint packed_size;
+		uint size;
+		uint offset;				// of the compressed data in the archive
+		uint chunk_size;
+		std::vector<u32> chunks;	// compressed size of each chunk, when known
+
+		std::vector<u8> data;		// filled by ExtractAll()
+	};
+
+protected:
+	wxString m_filename;
+	std::vector<u8> m_archive;
+	std::vector<Entry> m_entries;
+
+public:
+	// Reads the archive and its directory, throws Exception::SaveStateLoadError on failure.
+	ChunkedZipReader(const wxString& filename);
+	virtual ~ChunkedZipReader() = default;
+
+	const Entry* Find(const wxString& name) const;
+	const std::vector<Entry>& GetEntries() const { return m_entries; }
+
+	// Decompresses every entry, throws Exception::SaveStateLoadError on failure.
+	void ExtractAll();
+
+protected:
+	void ParseDirectory();
+};
@@ -17,7 +17,7 @@
 
 #include "Utilities/PersistentThread.h"
 #include "Utilities/pxStreams.h"
-#include "wx/zipstrm.h"
+#include "ChunkedZip.h"
 
 using namespace Threading;
 
@@ -148,11 +148,12 @@ class BaseCompressThread
 	typedef pxThread _parent;
 
 protected:
-	pxOutputStream*					m_gzfp;
+	ChunkedZipWriter*				m_writer;
 	ArchiveEntryList*				m_src_list;
 	bool							m_PendingSaveFlag;
 	
 	wxString						m_final_filename;
+	u64								m_start_ticks;
 
 public:
 	virtual ~BaseCompressThread();
@@ -169,15 +170,17 @@ public:
 		return *this;
 	}
 
-	BaseCompressThread& SetOutStream( pxOutputStream* out )
+	// Entries already added to the writer (version, screenshot) are written first.
+	BaseCompressThread& SetWriter( ChunkedZipWriter* writer )
 	{
-		m_gzfp = out;
+		m_writer = writer;
 		return *this;
 	}
 
-	BaseCompressThread& SetOutStream( pxOutputStream& out )
+	// Start of the save, for the time reported once the file is written.
+	BaseCompressThread& SetStartTime( u64 ticks )
 	{
-		m_gzfp = &out;
+		m_start_ticks = ticks;
 		return *this;
 	}
 
@@ -187,7 +190,7 @@ public:
 		return *this;
 	}
 
-	wxString GetStreamName() const { return m_gzfp->GetStreamName(); }
+	wxString GetStreamName() const { return m_writer->GetFilename(); }
 
 	BaseCompressThread& SetTargetFilename(const wxString& filename)
 	{
@@ -198,9 +201,10 @@ public:
 protected:
 	BaseCompressThread()
 	{
-		m_gzfp				= NULL;
+		m_writer			= NULL;
 		m_src_list			= NULL;
 		m_PendingSaveFlag	= false;
+		m_start_ticks		= GetCPUTicks();
 	}
 
 	void SetPendingSave();
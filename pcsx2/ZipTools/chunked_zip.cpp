@@ -0,0 +1,505 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "Plugins.h"
+#include "ChunkedZip.h"
+
+#include <atomic>
+#include <ctime>
+#include <thread>
+
+#ifdef _WIN32
+#include <zlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+static const u32 LocalHeaderSig = 0x04034b50;
+static const u32 CentralHeaderSig = 0x02014b50;
+static const u32 EndOfDirectorySig = 0x06054b50;
+
+static const u16 MethodStore = 0;
+static const u16 MethodDeflate = 8;
+static const u16 FlagEncrypted = 0x0001;
+static const u16 FlagUTF8 = 0x0800;
+
+// Extra field with the compressed size of each chunk: u32 chunk size, u32 count, u32 sizes[count]
+static const u16 ChunkTableId = 0x5850; // "PX"
+
+static u16 ReadU16(const u8* src)
+{
+	u16 value;
+	memcpy(&value, src, sizeof(value));
+	return value;
+}
+
+static u32 ReadU32(const u8* src)
+{
+	u32 value;
+	memcpy(&value, src, sizeof(value));
+	return value;
+}
+
+static void PushU16(std::vector<u8>& dst, u16 value)
+{
+	dst.insert(dst.end(), (u8*)&value, (u8*)&value + sizeof(value));
+}
+
+static void PushU32(std::vector<u8>& dst, u32 value)
+{
+	dst.insert(dst.end(), (u8*)&value, (u8*)&value + sizeof(value));
+}
+
+// Runs func(0) .. func(count - 1) on up to the given number of threads.  func must not throw.
+template <typename F>
+static void ParallelFor(uint count, uint threads, const F& func)
+{
+	std::atomic<uint> next(0);
+	auto work = [&]() {
+		for (uint i; (i = next++) < count;)
+			func(i);
+	};
+
+	std::vector<std::thread> workers;
+	for (uint i = 1; i < std::min(count, threads); i++)
+		workers.emplace_back(work);
+	work();
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+static uint GetChunkCount(uint size, uint chunk_size)
+{
+	return std::max(1u, (size + chunk_size - 1) / chunk_size);
+}
+
+static bool DeflateChunk(const u8* src, uint size, bool last, std::vector<u8>& dst)
+{
+	z_stream strm = {};
+	if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+
+	// Room for the sync flush marker, so that a single call does it all.
+	dst.resize(deflateBound(&strm, size) + 16);
+	strm.next_in = (Bytef*)src;
+	strm.avail_in = size;
+	strm.next_out = dst.data();
+	strm.avail_out = dst.size();
+
+	const int res = deflate(&strm, last ? Z_FINISH : Z_SYNC_FLUSH);
+	const bool ok = last ? res == Z_STREAM_END : (res == Z_OK && strm.avail_in == 0 && strm.avail_out != 0);
+
+	dst.resize(strm.total_out);
+	deflateEnd(&strm);
+	return ok;
+}
+
+static bool InflateRaw(const u8* src, uint packed_size, u8* dst, uint size)
+{
+	z_stream strm = {};
+	if (inflateInit2(&strm, -MAX_WBITS) != Z_OK)
+		return false;
+
+	strm.next_in = (Bytef*)src;
+	strm.avail_in = packed_size;
+	strm.next_out = dst;
+	strm.avail_out = size;
+
+	// Chunks other than the last end on a sync flush, not on the end of the stream.
+	const int res = inflate(&strm, Z_SYNC_FLUSH);
+	const bool ok = (res == Z_STREAM_END || res == Z_OK || res == Z_BUF_ERROR) && strm.avail_out == 0;
+
+	inflateEnd(&strm);
+	return ok;
+}
+
+// --------------------------------------------------------------------------------------
+//  ChunkedZipWriter  (implementations)
+// --------------------------------------------------------------------------------------
+ChunkedZipWriter::ChunkedZipWriter(const wxString& filename)
+	: m_filename(filename)
+{
+	if (!m_file.Open(filename, L"wb"))
+		throw Exception::CannotCreateStream(filename);
+
+	// The emulator keeps running while states are saved, leave it a core.  The core count
+	// is 0 when unknown, count that as two.
+	m_threads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+}
+
+void ChunkedZipWriter::AddStored(const wxString& name, const void* data, uint size)
+{
+	Entry entry;
+	entry.name = name;
+	entry.deflate = false;
+	entry.stored.assign((const u8*)data, (const u8*)data + size);
+	entry.size = size;
+	entry.crc = 0;
+	m_entries.push_back(std::move(entry));
+	m_entries.back().src = m_entries.back().stored.data();
+}
+
+void ChunkedZipWriter::AddDeflated(const wxString& name, const void* data, uint size)
+{
+	Entry entry;
+	entry.name = name;
+	entry.deflate = true;
+	entry.src = (const u8*)data;
+	entry.size = size;
+	entry.crc = 0;
+	entry.chunks.resize(GetChunkCount(size, ChunkSize));
+	m_entries.push_back(std::move(entry));
+}
+
+void ChunkedZipWriter::Write(const void* data, size_t size)
+{
+	if (size && m_file.Write(data, size) != size)
+		throw Exception::BadStream(m_filename).SetDiagMsg(L"Failed to write to the archive.");
+}
+
+void ChunkedZipWriter::Close()
+{
+	struct Task
+	{
+		uint entry;
+		uint chunk;
+		u32 crc;
+		bool ok;
+	};
+
+	std::vector<Task> tasks;
+	for (uint i = 0; i < m_entries.size(); i++)
+	{
+		const uint chunks = m_entries[i].deflate ? m_entries[i].chunks.size() : 1;
+		for (uint chunk = 0; chunk < chunks; chunk++)
+			tasks.push_back({i, chunk, 0, true});
+	}
+
+	ParallelFor(tasks.size(), m_threads, [&](uint i) {
+		Task& task = tasks[i];
+		Entry& entry = m_entries[task.entry];
+		const uint offset = task.chunk * ChunkSize;
+		const uint size = entry.deflate ? std::min(ChunkSize, entry.size - offset) : entry.size;
+
+		task.crc = crc32(0, entry.src + offset, size);
+		if (entry.deflate)
+			task.ok = DeflateChunk(entry.src + offset, size, task.chunk + 1 == entry.chunks.size(), entry.chunks[task.chunk]);
+	});
+
+	for (const Task& task : tasks)
+	{
+		Entry& entry = m_entries[task.entry];
+		if (!task.ok)
+			throw Exception::BadStream(m_filename).SetDiagMsg(pxsFmt(L"Failed to compress '%s'.", WX_STR(entry.name)));
+
+		const uint offset = task.chunk * ChunkSize;
+		const uint size = entry.deflate ? std::min(ChunkSize, entry.size - offset) : entry.size;
+		entry.crc = task.chunk ? crc32_combine(entry.crc, task.crc, size) : task.crc;
+	}
+
+	const time_t now = time(NULL);
+	const tm* local = localtime(&now);
+	const u16 dos_time = (local->tm_hour << 11) | (local->tm_min << 5) | (local->tm_sec / 2);
+	const u16 dos_date = ((local->tm_year - 80) << 9) | ((local->tm_mon + 1) << 5) | local->tm_mday;
+
+	std::vector<u8> directory;
+	std::vector<u8> header;
+	u32 offset = 0;
+
+	for (const Entry& entry : m_entries)
+	{
+		const wxCharBuffer name = entry.name.ToUTF8();
+		const u16 name_len = strlen(name.data());
+
+		u32 packed_size = entry.size;
+		if (entry.deflate)
+		{
+			packed_size = 0;
+			for (const std::vector<u8>& chunk : entry.chunks)
+				packed_size += chunk.size();
+		}
+
+		header.clear();
+		PushU32(header, LocalHeaderSig);
+		PushU16(header, 20);
+		PushU16(header, FlagUTF8);
+		PushU16(header, entry.deflate ? MethodDeflate : MethodStore);
+		PushU16(header, dos_time);
+		PushU16(header, dos_date);
+		PushU32(header, entry.crc);
+		PushU32(header, packed_size);
+		PushU32(header, entry.size);
+		PushU16(header, name_len);
+		PushU16(header, 0);
+		header.insert(header.end(), name.data(), name.data() + name_len);
+		Write(header.data(), header.size());
+
+		if (entry.deflate)
+		{
+			for (const std::vector<u8>& chunk : entry.chunks)
+				Write(chunk.data(), chunk.size());
+		}
+		else
+			Write(entry.src, entry.size);
+
+		std::vector<u8> extra;
+		if (entry.deflate)
+		{
+			PushU16(extra, ChunkTableId);
+			PushU16(extra, (2 + entry.chunks.size()) * sizeof(u32));
+			PushU32(extra, ChunkSize);
+			PushU32(extra, entry.chunks.size());
+			for (const std::vector<u8>& chunk : entry.chunks)
+				PushU32(extra, chunk.size());
+		}
+
+		PushU32(directory, CentralHeaderSig);
+		PushU16(directory, 20);
+		PushU16(directory, 20);
+		PushU16(directory, FlagUTF8);
+		PushU16(directory, entry.deflate ? MethodDeflate : MethodStore);
+		PushU16(directory, dos_time);
+		PushU16(directory, dos_date);
+		PushU32(directory, entry.crc);
+		PushU32(directory, packed_size);
+		PushU32(directory, entry.size);
+		PushU16(directory, name_len);
+		PushU16(directory, extra.size());
+		PushU16(directory, 0); // comment
+		PushU16(directory, 0); // disk
+		PushU16(directory, 0); // internal attributes
+		PushU32(directory, 0); // external attributes
+		PushU32(directory, offset);
+		directory.insert(directory.end(), name.data(), name.data() + name_len);
+		directory.insert(directory.end(), extra.begin(), extra.end());
+
+		offset += header.size() + packed_size;
+	}
+
+	std::vector<u8> end;
+	PushU32(end, EndOfDirectorySig);
+	PushU16(end, 0);
+	PushU16(end, 0);
+	PushU16(end, m_entries.size());
+	PushU16(end, m_entries.size());
+	PushU32(end, directory.size());
+	PushU32(end, offset);
+	PushU16(end, 0);
+
+	Write(directory.data(), directory.size());
+	Write(end.data(), end.size());
+
+	if (!m_file.Close())
+		throw Exception::BadStream(m_filename).SetDiagMsg(L"Failed to close the archive.");
+
+	m_entries.clear();
+}
+
+// --------------------------------------------------------------------------------------
+//  ChunkedZipReader  (implementations)
+// --------------------------------------------------------------------------------------
+ChunkedZipReader::ChunkedZipReader(const wxString& filename)
+	: m_filename(filename)
+{
+	wxFFile file;
+	if (!file.Open(filename, L"rb"))
+		throw Exception::SaveStateLoadError(filename).SetDiagMsg(L"Cannot open file for reading.");
+
+	m_archive.resize(file.Length());
+	if (file.Read(m_archive.data(), m_archive.size()) != m_archive.size())
+		throw Exception::SaveStateLoadError(filename).SetDiagMsg(L"Cannot read the file.");
+
+	ParseDirectory();
+}
+
+void ChunkedZipReader::ParseDirectory()
+{
+	const Exception::SaveStateLoadError invalid = Exception::SaveStateLoadError(m_filename)
+		.SetDiagMsg(L"Savestate file is not a valid zip archive.")
+		.SetUserMsg(_("This savestate cannot be loaded because it is not a valid gzip archive.  It may have been created by an older unsupported version of PCSX2, or it may be corrupted."));
+
+	const u8* archive = m_archive.data();
+	const uint archive_size = m_archive.size();
+	if (archive_size < 22)
+		throw invalid;
+
+	// The end of directory record is followed by a comment of up to 64KB.
+	uint end = archive_size - 22;
+	const uint lowest = archive_size > 22 + 0xffff ? archive_size - 22 - 0xffff : 0;
+	while (ReadU32(archive + end) != EndOfDirectorySig)
+	{
+		if (end == lowest)
+			throw invalid;
+		end--;
+	}
+
+	const uint count = ReadU16(archive + end + 10);
+	const uint directory_size = ReadU32(archive + end + 12);
+	uint pos = ReadU32(archive + end + 16);
+	if ((u64)pos + directory_size > end)
+		throw invalid;
+
+	for (uint i = 0; i < count; i++)
+	{
+		if (pos + 46 > end || ReadU32(archive + pos) != CentralHeaderSig)
+			throw invalid;
+
+		const u16 flags = ReadU16(archive + pos + 8);
+		const uint name_len = ReadU16(archive + pos + 28);
+		const uint extra_len = ReadU16(archive + pos + 30);
+		const uint comment_len = ReadU16(archive + pos + 32);
+		if (pos + 46 + name_len + extra_len + comment_len > end)
+			throw invalid;
+
+		Entry entry;
+		entry.method = ReadU16(archive + pos + 10);
+		entry.crc = ReadU32(archive + pos + 16);
+		entry.packed_size = ReadU32(archive + pos + 20);
+		entry.size = ReadU32(archive + pos + 24);
+		entry.chunk_size = 0;
+
+		const char* name = (const char*)archive + pos + 46;
+		entry.name = (flags & FlagUTF8) ? wxString::FromUTF8(name, name_len) : wxString::From8BitData(name, name_len);
+
+		if ((flags & FlagEncrypted) || (entry.method != MethodStore && entry.method != MethodDeflate))
+			throw Exception::SaveStateLoadError(m_filename)
+				.SetDiagMsg(pxsFmt(L"Savestate entry '%s' uses an unsupported compression.", WX_STR(entry.name)));
+
+		const uint local = ReadU32(archive + pos + 42);
+		if ((u64)local + 30 > archive_size || ReadU32(archive + local) != LocalHeaderSig)
+			throw invalid;
+		entry.offset = local + 30 + ReadU16(archive + local + 26) + ReadU16(archive + local + 28);
+		if ((u64)entry.offset + entry.packed_size > archive_size)
+			throw invalid;
+
+		const u8* extra = archive + pos + 46 + name_len;
+		for (uint e = 0; e + 4 <= extra_len;)
+		{
+			const u16 id = ReadU16(extra + e);
+			const uint len = ReadU16(extra + e + 2);
+			if (e + 4 + len > extra_len)
+				break;
+
+			if (id == ChunkTableId && entry.method == MethodDeflate && len >= 8)
+			{
+				const u8* table = extra + e + 4;
+				const uint chunk_size = ReadU32(table);
+				const uint chunks = ReadU32(table + 4);
+
+				u64 total = 0;
+				std::vector<u32> sizes;
+				for (uint c = 0; c < chunks && 8 + (c + 1) * 4 <= len; c++)
+				{
+					sizes.push_back(ReadU32(table + 8 + c * 4));
+					total += sizes.back();
+				}
+
+				// Anything off, and the entry is inflated as a whole.
+				if (chunk_size && sizes.size() == chunks && chunks == GetChunkCount(entry.size, chunk_size) && total == entry.packed_size)
+				{
+					entry.chunk_size = chunk_size;
+					entry.chunks = std::move(sizes);
+				}
+			}
+			e += 4 + len;
+		}
+
+		m_entries.push_back(std::move(entry));
+		pos += 46 + name_len + extra_len + comment_len;
+	}
+}
+
+const ChunkedZipReader::Entry* ChunkedZipReader::Find(const wxString& name) const
+{
+	for (const Entry& entry : m_entries)
+	{
+		if (entry.name.CmpNoCase(name) == 0)
+			return &entry;
+	}
+	return NULL;
+}
+
+void ChunkedZipReader::ExtractAll()
+{
+	struct Task
+	{
+		uint entry;
+		uint src;
+		uint packed_size;
+		uint dst;
+		uint size;
+		u32 crc;
+		bool ok;
+	};
+
+	std::vector<Task> tasks;
+	for (uint i = 0; i < m_entries.size(); i++)
+	{
+		Entry& entry = m_entries[i];
+		entry.data.resize(entry.size);
+
+		if (entry.chunks.empty())
+		{
+			tasks.push_back({i, entry.offset, entry.packed_size, 0, entry.size, 0, true});
+			continue;
+		}
+
+		uint src = entry.offset;
+		for (uint c = 0; c < entry.chunks.size(); c++)
+		{
+			const uint dst = c * entry.chunk_size;
+			tasks.push_back({i, src, entry.chunks[c], dst, std::min(entry.chunk_size, entry.size - dst), 0, true});
+			src += entry.chunks[c];
+		}
+	}
+
+	ParallelFor(tasks.size(), std::max(2u, std::thread::hardware_concurrency()), [&](uint i) {
+		Task& task = tasks[i];
+		Entry& entry = m_entries[task.entry];
+		u8* dst = entry.data.data() + task.dst;
+
+		if (entry.method == MethodStore)
+		{
+			task.ok = task.packed_size == task.size;
+			if (task.ok)
+				memcpy(dst, m_archive.data() + task.src, task.size);
+		}
+		else
+			task.ok = InflateRaw(m_archive.data() + task.src, task.packed_size, dst, task.size);
+
+		if (task.ok)
+			task.crc = crc32(0, dst, task.size);
+	});
+
+	u32 crc = 0;
+	for (uint i = 0; i < tasks.size(); i++)
+	{
+		const Task& task = tasks[i];
+		const Entry& entry = m_entries[task.entry];
+
+		crc = task.dst ? crc32_combine(crc, task.crc, task.size) : task.crc;
+		const bool last = i + 1 == tasks.size() || tasks[i + 1].entry != task.entry;
+
+		if (!task.ok || (last && crc != entry.crc))
+			throw Exception::SaveStateLoadError(m_filename)
+				.SetDiagMsg(pxsFmt(L"Savestate entry '%s' is corrupted.", WX_STR(entry.name)))
+				.SetUserMsg(_("This savestate cannot be loaded because it is corrupted."));
+	}
+
+	// Everything is unpacked, the archive itself is no longer needed.
+	m_archive.clear();
+	m_archive.shrink_to_fit();
+}
@@ -56,36 +56,30 @@ void BaseCompressThread::ExecuteTaskInThread()
 	
 	Yield( 3 );
 
+	const u64 compress_start = GetCPUTicks();
+
 	uint listlen = m_src_list->GetLength();
 	for( uint i=0; i<listlen; ++i )
 	{
 		const ArchiveEntry& entry = (*m_src_list)[i];
 		if (!entry.GetDataSize()) continue;
 
-		wxArchiveOutputStream& woot = *(wxArchiveOutputStream*)m_gzfp->GetWxStreamBase();
-		woot.PutNextEntry( entry.GetFilename() );
-
-		static const uint BlockSize = 0x64000;
-		uint curidx = 0;
-
-		do {
-			uint thisBlockSize = std::min( BlockSize, entry.GetDataSize() - curidx );
-			m_gzfp->Write(m_src_list->GetPtr( entry.GetDataIndex() + curidx ), thisBlockSize);
-			curidx += thisBlockSize;
-			Yield( 2 );
-		} while( curidx < entry.GetDataSize() );
-		
-		woot.CloseEntry();
+		m_writer->AddDeflated( entry.GetFilename(), m_src_list->GetPtr( entry.GetDataIndex() ), entry.GetDataSize() );
 	}
 
-	m_gzfp->Close();
+	// Entries are split in chunks and deflated on several threads at once.
+	m_writer->Close();
+
+	const u64 compress_end = GetCPUTicks();
 
-	if( !wxRenameFile( m_gzfp->GetStreamName(), m_final_filename, true ) )
+	if( !wxRenameFile( m_writer->GetFilename(), m_final_filename, true ) )
 		throw Exception::BadStream( m_final_filename )
 		.SetDiagMsg(L"Failed to move or copy the temporary archive to the destination filename.")
 		.SetUserMsg(_("The savestate was not properly saved. The temporary file was created successfully but could not be moved to its final resting place."));
 
-	Console.WriteLn( "(gzipThread) Data saved to disk without error." );
+	Console.WriteLn( "(gzipThread) Data saved to disk without error in %.0f ms (archived in %.0f ms on %u threads).",
+		(GetCPUTicks() - m_start_ticks) * 1000.0 / GetTickFrequency(),
+		(compress_end - compress_start) * 1000.0 / GetTickFrequency(), m_writer->GetThreadCount() );
 }
 
 void BaseCompressThread::OnCleanupInThread()
@@ -93,7 +87,7 @@ void BaseCompressThread::OnCleanupInThread()
 	_parent::OnCleanupInThread();
 	wxGetApp().DeleteThread( this );
 
-	safe_delete(m_gzfp);
+	safe_delete(m_writer);
 	safe_delete(m_src_list);
 }
 
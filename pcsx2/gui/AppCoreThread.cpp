@@ -247,7 +247,7 @@ void AppCoreThread::OnPauseDebug()
 // Load Game Settings found in database
 // (game fixes, round modes, clamp modes, etc...)
 // Returns number of gamefixes set
-static int loadGameSettings(Pcsx2Config& dest, const Game_Data& game)
+static int loadGameSettings(Pcsx2Config& dest, const GameDataView& game)
 {
 	if (!game.IsOk())
 		return 0;
@@ -310,9 +310,9 @@ static int loadGameSettings(Pcsx2Config& dest, const Game_Data& game)
 		wxString key(EnumToString(id));
 		key += L"Hack";
 
-		if (game.keyExists(key))
+		if (game.keyExists(key.utf8_str()))
 		{
-			bool enableIt = game.getBool(key);
+			bool enableIt = game.getBool(key.utf8_str());
 			dest.Gamefixes.Set(id, enableIt);
 			PatchesCon->WriteLn(L"(GameDB) %s Gamefix: " + key, enableIt ? L"Enabled" : L"Disabled");
 			gf++;
@@ -428,14 +428,14 @@ static void _ApplySettings(const Pcsx2Config& src, Pcsx2Config& fixup)
 	{
 		if (IGameDatabase* GameDB = AppHost_GetGameDatabase())
 		{
-			Game_Data game;
+			GameDataView game;
 			if (GameDB->findGame(game, curGameKey))
 			{
 				int compat = game.getInt("Compat");
-				gameName = game.getString("Name");
-				gameName += L" (" + game.getString("Region") + L")";
+				gameName = fromUTF8(game.getString("Name"));
+				gameName += L" (" + fromUTF8(game.getString("Region")) + L")";
 				gameCompat = L" [Status = " + compatToStringWX(compat) + L"]";
-				gameMemCardFilter = game.getString("MemCardFilter");
+				gameMemCardFilter = fromUTF8(game.getString("MemCardFilter"));
 			}
 
 			if (fixup.EnablePatches)
@@ -158,6 +158,24 @@ AppGameDatabase& AppGameDatabase::LoadFromFile(const wxString& _file, const wxSt
 		return *this;
 	}
 
+	// The text file is the source of truth, the compiled image is rebuilt whenever it changes
+	wxFileName source(file);
+	const u64 source_size = source.GetSize().GetValue();
+	const s64 source_time = source.GetModificationTime().GetTicks();
+	const wxString compiled = Path::Combine(GetSettingsFolder(), wxFileName(L"GameIndex.bin"));
+
+	u64 qpc_Start = GetCPUTicks();
+
+	if (m_compiled.Open(compiled, source_size, source_time))
+	{
+		u64 qpc_end = GetCPUTicks();
+
+		Console.WriteLn( "(GameDB) %d games on record (mapped in %ums)",
+			getGameCount(), (u32)(((qpc_end-qpc_Start)*1000) / GetTickFrequency()) );
+
+		return *this;
+	}
+
 	wxFFileInputStream reader( file );
 
 	if (!reader.IsOk())
@@ -168,12 +186,18 @@ AppGameDatabase& AppGameDatabase::LoadFromFile(const wxString& _file, const wxSt
 
 	DBLoaderHelper loader( reader, *this );
 
-	u64 qpc_Start = GetCPUTicks();
 	loader.ReadGames();
+
+	m_compiled.Build(gHash, source_size, source_time);
+	gHash.clear();
+
 	u64 qpc_end = GetCPUTicks();
 
 	Console.WriteLn( "(GameDB) %d games on record (loaded in %ums)",
-		gHash.size(), (u32)(((qpc_end-qpc_Start)*1000) / GetTickFrequency()) );
+		getGameCount(), (u32)(((qpc_end-qpc_Start)*1000) / GetTickFrequency()) );
+
+	if (!m_compiled.Save(compiled))
+		Console.Warning(L"(GameDB) Could not write the compiled database [%s]", WX_STR(compiled));
 
 	return *this;
 }
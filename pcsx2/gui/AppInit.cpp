@@ -260,6 +260,9 @@ void Pcsx2App::OnInitCmdLine(wxCmdLineParser& parser)
 	parser.AddSwitch(wxEmptyString, L"portable", _("enables portable mode operation (requires admin/root access)"));
 
 	parser.AddSwitch(wxEmptyString, L"profiling", _("update options to ease profiling (debug)"));
+#ifdef PCSX2_DEVBUILD
+	parser.AddSwitch(wxEmptyString, L"vifselftest", _("checks and times the VIF unpack recompiler on the first reset (debug)"));
+#endif
 
 	ForPlugins([&](const PluginInfo* pi) {
 		parser.AddOption(wxEmptyString, pi->GetShortname().Lower(),
@@ -296,6 +299,11 @@ bool Pcsx2App::ParseOverrides(wxCmdLineParser& parser)
 
 	Overrides.ProfilingMode = parser.Found(L"profiling");
 
+#ifdef PCSX2_DEVBUILD
+	if (parser.Found(L"vifselftest"))
+		dVifRequestSelfTest();
+#endif
+
 	if (parser.Found(L"gamefixes", &dest))
 	{
 		Overrides.ApplyCustomGamefixes = true;
@@ -507,6 +507,14 @@ namespace Implementations
 		if (GSFrame* gsframe = wxGetApp().GetGsFramePtr())
 			gsframe->ShowFullScreen(!gsframe->IsFullScreen());
 	}
+
+	void States_Rewind()
+	{
+		if (!g_Conf->EmuOptions.EnableRewind || !SysHasValidState())
+			return;
+
+		StateCopy_Rewind();
+	}
 #ifndef DISABLE_RECORDING
 	void FrameAdvance()
 	{
@@ -696,6 +704,14 @@ static const GlobalCommandDescriptor CommandDeclarations[] =
 			false,
 		},
 
+		{
+			"States_Rewind",
+			Implementations::States_Rewind,
+			pxL("Rewind"),
+			pxL("Goes back to the previous state in the rewind history."),
+			false,
+		},
+
 		{
 			"Frameskip_Toggle",
 			Implementations::Frameskip_Toggle,
@@ -1003,6 +1019,7 @@ void Pcsx2App::InitDefaultGlobalAccelerators()
 	GlobalAccels->Map(AAC(WXK_F3), "States_DefrostCurrentSlot");
 	GlobalAccels->Map(AAC(WXK_F2), "States_CycleSlotForward");
 	GlobalAccels->Map(AAC(WXK_F2).Shift(), "States_CycleSlotBackward");
+	GlobalAccels->Map(AAC(WXK_BACK), "States_Rewind");
 
 	GlobalAccels->Map(AAC(WXK_F4), "Framelimiter_MasterToggle");
 	GlobalAccels->Map(AAC(WXK_F4).Shift(), "Frameskip_Toggle");
@@ -34,10 +34,23 @@ FolderMemoryCard::FolderMemoryCard() {
 	m_timeLastWritten = 0;
 	m_filteringEnabled = false;
 	m_filteringString = L"";
+	m_flushPending = false;
+	memset( &m_superBlockSnapshot, 0xFF, sizeof( m_superBlockSnapshot ) );
+	m_ioBlockedTicks = 0;
+	m_ioWaitTicks = 0;
+	m_lazyIndexing = false;
+	m_indexBytesRead = 0;
+	m_fileBytesRead = 0;
+}
+
+FolderMemoryCard::~FolderMemoryCard() {
+	WaitForFlush();
 }
 
 void FolderMemoryCard::InitializeInternalData() {
+	WaitForFlush();
 	memset( &m_superBlock, 0xFF, sizeof( m_superBlock ) );
+	UpdateSuperBlockSnapshot();
 	memset( &m_indirectFat, 0xFF, sizeof( m_indirectFat ) );
 	memset( &m_fat, 0xFF, sizeof( m_fat ) );
 	memset( &m_backupBlock1, 0xFF, sizeof( m_backupBlock1 ) );
@@ -52,11 +65,22 @@ void FolderMemoryCard::InitializeInternalData() {
 	m_performFileWrites = true;
 	m_filteringEnabled = false;
 	m_filteringString = L"";
+	m_ioBlockedTicks = 0;
+	m_ioWaitTicks = 0;
+	m_index.Clear();
+	m_indexBytesRead = 0;
+	m_fileBytesRead = 0;
 }
 
 bool FolderMemoryCard::IsFormatted() const {
+	std::lock_guard<std::mutex> lock( m_flushLock );
 	// this should be a good enough arbitrary check, if someone can think of a case where this doesn't work feel free to change
-	return m_superBlock.raw[0x16] == 0x6F;
+	return m_superBlockSnapshot.magic[0x16] == 0x6F;
+}
+
+void FolderMemoryCard::UpdateSuperBlockSnapshot() {
+	std::lock_guard<std::mutex> lock( m_flushLock );
+	memcpy( &m_superBlockSnapshot, &m_superBlock.data, sizeof( m_superBlockSnapshot ) );
 }
 
 void FolderMemoryCard::Open( const bool enableFiltering, const wxString& filter ) {
@@ -66,6 +90,7 @@ void FolderMemoryCard::Open( const bool enableFiltering, const wxString& filter
 void FolderMemoryCard::Open( const wxString& fullPath, const AppConfig::McdOptions& mcdOptions, const u32 sizeInClusters, const bool enableFiltering, const wxString& filter, bool simulateFileWrites ) {
 	InitializeInternalData();
 	m_performFileWrites = !simulateFileWrites;
+	m_lazyIndexing = g_Conf->EmuOptions.McdFolderLazyIndex;
 
 	wxFileName configuredFileName( fullPath );
 	m_folderName = wxFileName( configuredFileName.GetFullPath() + L"/" );
@@ -110,7 +135,17 @@ void FolderMemoryCard::Close( bool flush ) {
 	if ( !m_isEnabled ) { return; }
 
 	if ( flush ) {
-		Flush();
+		Flush( false );
+	}
+	WaitForFlush();
+
+	if ( m_fileBytesRead > 0 ) {
+		Console.WriteLn( L"(FolderMcd) Slot %u: read %u KB from save files.", m_slot, (u32)( m_fileBytesRead / 1024 ) );
+	}
+	if ( m_ioBlockedTicks > 0 ) {
+		const u64 freq = GetTickFrequency();
+		Console.WriteLn( L"(FolderMcd) Slot %u: emulation was blocked on memory card I/O for %u ms (%u ms of it waiting for write-back).",
+			m_slot, (u32)( m_ioBlockedTicks * 1000 / freq ), (u32)( m_ioWaitTicks * 1000 / freq ) );
 	}
 
 	m_cache.clear();
@@ -133,19 +168,24 @@ bool FolderMemoryCard::ReIndex( bool enableFiltering, const wxString& filter ) {
 
 void FolderMemoryCard::LoadMemoryCardData( const u32 sizeInClusters, const bool enableFiltering, const wxString& filter ) {
 	bool formatted = false;
+	const u64 timeLoadStart = wxGetLocalTimeMillis().GetValue();
 
 	// read superblock if it exists
 	wxFileName superBlockFileName( m_folderName.GetPath(), L"_pcsx2_superblock" );
 	if ( superBlockFileName.FileExists() ) {
 		wxFFile superBlockFile( superBlockFileName.GetFullPath().c_str(), L"rb" );
-		if ( superBlockFile.IsOpened() && superBlockFile.Read( &m_superBlock.raw, sizeof( m_superBlock.raw ) ) >= sizeof( m_superBlock.data ) ) {
-			formatted = IsFormatted();
+		if ( superBlockFile.IsOpened() ) {
+			const size_t bytesRead = superBlockFile.Read( &m_superBlock.raw, sizeof( m_superBlock.raw ) );
+			m_indexBytesRead += bytesRead;
+			UpdateSuperBlockSnapshot();
+			formatted = bytesRead >= sizeof( m_superBlock.data ) && IsFormatted();
 		}
 	}
 
 	if ( sizeInClusters > 0 && sizeInClusters != GetSizeInClusters() ) {
-		SetSizeInClusters( sizeInClusters );
-		FlushBlock( 0 );
+		// nothing has been written to the card yet, so resize the loaded superblock in place
+		ResizeSuperBlock( &m_superBlock, sizeInClusters );
+		UpdateSuperBlockSnapshot();
 	}
 
 	// if superblock was valid, load folders and files
@@ -156,10 +196,29 @@ void FolderMemoryCard::LoadMemoryCardData( const u32 sizeInClusters, const bool
 			Console.WriteLn( Color_Green, L"(FolderMcd) Indexing slot %u without filter.", m_slot );
 		}
 
+		wxFileName indexFileName( m_folderName.GetPath(), L"_pcsx2_index" );
+		if ( m_lazyIndexing ) {
+			m_indexBytesRead += m_index.Load( indexFileName.GetFullPath() );
+		}
+
 		CreateFat();
 		CreateRootDir();
 		MemoryCardFileEntry* const rootDirEntry = &m_fileEntryDict[m_superBlock.data.rootdir_cluster].entries[0];
 		AddFolder( rootDirEntry, m_folderName.GetPath(), nullptr, enableFiltering, filter );
+
+		const u64 timeLoadEnd = wxGetLocalTimeMillis().GetValue();
+		if ( m_lazyIndexing ) {
+			Console.WriteLn( L"(FolderMcd) Indexed slot %u in %u ms, %u of %u entries from the index, %u bytes read.",
+				m_slot, (u32)( timeLoadEnd - timeLoadStart ), m_index.GetHitCount(), m_index.GetLookupCount(), (u32)m_indexBytesRead );
+
+			// a filtered load only sees part of the card, so only drop stale entries after a full one
+			if ( m_performFileWrites ) {
+				m_index.Save( indexFileName.GetFullPath(), !enableFiltering );
+			}
+			m_index.Clear();
+		} else {
+			Console.WriteLn( L"(FolderMcd) Indexed slot %u in %u ms, %u bytes read.", m_slot, (u32)( timeLoadEnd - timeLoadStart ), (u32)m_indexBytesRead );
+		}
 		
 		#ifdef DEBUG_WRITE_FOLDER_CARD_IN_MEMORY_TO_FILE_ON_CHANGE
 		WriteToFile( m_folderName.GetFullPath().RemoveLast() + L"-debug_" +  wxDateTime::Now().Format( L"%Y-%m-%d-%H-%M-%S" ) + L"_load.ps2" );
@@ -365,11 +424,9 @@ bool FolderMemoryCard::AddFolder( MemoryCardFileEntry* const dirEntry, const wxS
 				}
 
 				// is a subdirectory
-				wxDateTime creationTime, modificationTime;
 				fileInfo.AppendDir( fileInfo.GetFullName() );
 				fileInfo.SetName( L"" );
 				fileInfo.ClearExt();
-				fileInfo.GetTimes( NULL, &modificationTime, &creationTime );
 
 				// add entry for subdir in parent dir
 				MemoryCardFileEntry* newDirEntry = AppendFileEntryToDir( dirEntry );
@@ -378,18 +435,37 @@ bool FolderMemoryCard::AddFolder( MemoryCardFileEntry* const dirEntry, const wxS
 				// set metadata
 				wxFileName metaFileName( dirPath, L"_pcsx2_meta_directory" );
 				metaFileName.AppendDir( fileName );
-				wxFFile metaFile;
-				if ( metaFileName.FileExists() && metaFile.Open( metaFileName.GetFullPath(), L"rb" ) ) {
-					size_t bytesRead = metaFile.Read( &newDirEntry->entry.raw, sizeof( newDirEntry->entry.raw ) );
-					metaFile.Close();
-					if ( bytesRead < 0x60 ) {
+
+				wxFileName relativeDirPath( dirPath, fileName );
+				relativeDirPath.MakeRelativeTo( m_folderName.GetPath() );
+				const std::string indexPath( relativeDirPath.GetFullPath().ToUTF8() );
+				FolderMemoryCardIndex::Key indexKey;
+				const bool hasIndexKey = m_lazyIndexing && FolderMemoryCardIndex::GetKey( fileInfo.GetPath(), metaFileName.GetFullPath(), &indexKey );
+				const MemoryCardFileEntry* indexEntry = hasIndexKey ? m_index.Find( indexPath, indexKey ) : nullptr;
+
+				if ( indexEntry != nullptr ) {
+					memcpy( &newDirEntry->entry.raw[0], &indexEntry->entry.raw[0], sizeof( newDirEntry->entry.raw ) );
+				} else {
+					wxFFile metaFile;
+					if ( metaFileName.FileExists() && metaFile.Open( metaFileName.GetFullPath(), L"rb" ) ) {
+						size_t bytesRead = metaFile.Read( &newDirEntry->entry.raw, sizeof( newDirEntry->entry.raw ) );
+						metaFile.Close();
+						m_indexBytesRead += bytesRead;
+						if ( bytesRead < 0x60 ) {
+							strcpy( (char*)&newDirEntry->entry.data.name[0], fileName.mbc_str() );
+						}
+					} else {
+						wxDateTime creationTime, modificationTime;
+						fileInfo.GetTimes( NULL, &modificationTime, &creationTime );
+						newDirEntry->entry.data.mode = MemoryCardFileEntry::DefaultDirMode;
+						newDirEntry->entry.data.timeCreated = MemoryCardFileEntryDateTime::FromWxDateTime( creationTime );
+						newDirEntry->entry.data.timeModified = MemoryCardFileEntryDateTime::FromWxDateTime( modificationTime );
 						strcpy( (char*)&newDirEntry->entry.data.name[0], fileName.mbc_str() );
 					}
-				} else {
-					newDirEntry->entry.data.mode = MemoryCardFileEntry::DefaultDirMode;
-					newDirEntry->entry.data.timeCreated = MemoryCardFileEntryDateTime::FromWxDateTime( creationTime );
-					newDirEntry->entry.data.timeModified = MemoryCardFileEntryDateTime::FromWxDateTime( modificationTime );
-					strcpy( (char*)&newDirEntry->entry.data.name[0], fileName.mbc_str() );
+
+					if ( hasIndexKey ) {
+						m_index.Update( indexPath, indexKey, newDirEntry );
+					}
 				}
 
 				// create new cluster for . and .. entries
@@ -431,11 +507,24 @@ bool FolderMemoryCard::AddFile( MemoryCardFileEntry* const dirEntry, const wxStr
 	relativeFilePath.MakeRelativeTo( m_folderName.GetPath() );
 
 	wxFileName fileInfo( dirPath, fileName );
-	wxFFile file( fileInfo.GetFullPath(), L"rb" );
-	if ( file.IsOpened() ) {
+	wxFileName metaFileName( dirPath, fileName );
+	metaFileName.AppendDir( L"_pcsx2_meta" );
+
+	// in lazy mode the file itself is only opened once it's accessed, its size comes from a stat
+	const std::string indexPath( relativeFilePath.GetFullPath().ToUTF8() );
+	FolderMemoryCardIndex::Key indexKey;
+	wxFFile file;
+	bool exists;
+	if ( m_lazyIndexing ) {
+		exists = FolderMemoryCardIndex::GetKey( fileInfo.GetFullPath(), metaFileName.GetFullPath(), &indexKey );
+	} else {
+		exists = file.Open( fileInfo.GetFullPath(), L"rb" );
+	}
+
+	if ( exists ) {
 		// make sure we have enough space on the memcard to hold the data
 		const u32 clusterSize = m_superBlock.data.pages_per_cluster * m_superBlock.data.page_len;
-		const u32 filesize = file.Length();
+		const u32 filesize = m_lazyIndexing ? (u32)indexKey.size : (u32)file.Length();
 		const u32 countClusters = ( filesize % clusterSize ) != 0 ? ( filesize / clusterSize + 1 ) : ( filesize / clusterSize );
 		const u32 newNeededClusters = ( dirEntry->entry.data.length % 2 ) == 0 ? countClusters + 1 : countClusters;
 		if ( newNeededClusters > GetAmountFreeDataClusters() ) {
@@ -445,26 +534,34 @@ bool FolderMemoryCard::AddFile( MemoryCardFileEntry* const dirEntry, const wxStr
 		}
 
 		MemoryCardFileEntry* newFileEntry = AppendFileEntryToDir( dirEntry );
-		wxDateTime creationTime, modificationTime;
-		fileInfo.GetTimes( NULL, &modificationTime, &creationTime );
 
 		// set file entry metadata
-		memset( &newFileEntry->entry.raw[0], 0x00, sizeof( newFileEntry->entry.raw ) );
-
-		wxFileName metaFileName( dirPath, fileName );
-		metaFileName.AppendDir( L"_pcsx2_meta" );
-		wxFFile metaFile;
-		if ( metaFileName.FileExists() && metaFile.Open( metaFileName.GetFullPath(), L"rb" ) ) {
-			size_t bytesRead = metaFile.Read( &newFileEntry->entry.raw, sizeof( newFileEntry->entry.raw ) );
-			metaFile.Close();
-			if ( bytesRead < 0x60 ) {
+		const MemoryCardFileEntry* indexEntry = m_lazyIndexing ? m_index.Find( indexPath, indexKey ) : nullptr;
+		if ( indexEntry != nullptr ) {
+			memcpy( &newFileEntry->entry.raw[0], &indexEntry->entry.raw[0], sizeof( newFileEntry->entry.raw ) );
+		} else {
+			memset( &newFileEntry->entry.raw[0], 0x00, sizeof( newFileEntry->entry.raw ) );
+
+			wxFFile metaFile;
+			if ( metaFileName.FileExists() && metaFile.Open( metaFileName.GetFullPath(), L"rb" ) ) {
+				size_t bytesRead = metaFile.Read( &newFileEntry->entry.raw, sizeof( newFileEntry->entry.raw ) );
+				metaFile.Close();
+				m_indexBytesRead += bytesRead;
+				if ( bytesRead < 0x60 ) {
+					strcpy( (char*)&newFileEntry->entry.data.name[0], fileName.mbc_str() );
+				}
+			} else {
+				wxDateTime creationTime, modificationTime;
+				fileInfo.GetTimes( NULL, &modificationTime, &creationTime );
+				newFileEntry->entry.data.mode = MemoryCardFileEntry::DefaultFileMode;
+				newFileEntry->entry.data.timeCreated = MemoryCardFileEntryDateTime::FromWxDateTime( creationTime );
+				newFileEntry->entry.data.timeModified = MemoryCardFileEntryDateTime::FromWxDateTime( modificationTime );
 				strcpy( (char*)&newFileEntry->entry.data.name[0], fileName.mbc_str() );
 			}
-		} else {
-			newFileEntry->entry.data.mode = MemoryCardFileEntry::DefaultFileMode;
-			newFileEntry->entry.data.timeCreated = MemoryCardFileEntryDateTime::FromWxDateTime( creationTime );
-			newFileEntry->entry.data.timeModified = MemoryCardFileEntryDateTime::FromWxDateTime( modificationTime );
-			strcpy( (char*)&newFileEntry->entry.data.name[0], fileName.mbc_str() );
+
+			if ( m_lazyIndexing ) {
+				m_index.Update( indexPath, indexKey, newFileEntry );
+			}
 		}
 
 		newFileEntry->entry.data.length = filesize;
@@ -488,7 +585,7 @@ bool FolderMemoryCard::AddFile( MemoryCardFileEntry* const dirEntry, const wxStr
 		file.Close();
 
 		MemoryCardFileMetadataReference* fileRef = AddFileEntryToMetadataQuickAccess( newFileEntry, parent );
-		if ( fileRef != nullptr ) {
+		if ( fileRef != nullptr && !m_lazyIndexing ) {
 			// acquire a handle on the file so nothing else can change the file contents while the memory card is open
 			m_lastAccessedFile.ReOpen( m_folderName, fileRef );
 		}
@@ -726,15 +823,29 @@ bool FolderMemoryCard::ReadFromFile( u8 *dest, u32 adr, u32 dataLength ) {
 	auto it = m_fileMetadataQuickAccess.find( fatCluster );
 	if ( it != m_fileMetadataQuickAccess.end() ) {
 		const u32 clusterNumber = it->second.consecutiveCluster;
+		const u32 clusterOffset = ( page % 2 ) * PageSize + offset;
+		const u32 fileOffset = clusterNumber * ClusterSize + clusterOffset;
+
+		// written by the flush in progress but not renamed into place yet
+		const std::vector<u8>* staged = m_lastAccessedFile.FindStaged( &it->second );
+		if ( staged != nullptr ) {
+			const size_t bytesRead = fileOffset < staged->size() ? std::min<size_t>( dataLength, staged->size() - fileOffset ) : 0;
+			if ( bytesRead > 0 ) {
+				memcpy( dest, &( *staged )[fileOffset], bytesRead );
+			}
+			if ( bytesRead < dataLength ) {
+				memset( &dest[bytesRead], 0xFF, dataLength - bytesRead );
+			}
+			return bytesRead > 0;
+		}
+
 		wxFFile* file = m_lastAccessedFile.ReOpen( m_folderName, &it->second );
 		if ( file->IsOpened() ) {
-			const u32 clusterOffset = ( page % 2 ) * PageSize + offset;
-			const u32 fileOffset = clusterNumber * ClusterSize + clusterOffset;
-
 			if ( fileOffset != file->Tell() ) {
 				file->Seek( fileOffset );
 			}
 			size_t bytesRead = file->Read( dest, dataLength );
+			m_fileBytesRead += bytesRead;
 
 			// if more bytes were requested than actually exist, fill the rest with 0xFF
 			if ( bytesRead < dataLength ) {
@@ -802,16 +913,44 @@ s32 FolderMemoryCard::Read( u8 *dest, u32 adr, int size ) {
 }
 
 void FolderMemoryCard::ReadDataWithoutCache( u8* const dest, const u32 adr, const u32 dataLength ) {
+	if ( ReadFromJournal( dest, adr, dataLength ) ) {
+		return;
+	}
+
+	// The page isn't in the journal, and only the EE puts pages there, so the internal data and
+	// the files have what it needs. The write-back thread holds the lock for a page at a time.
+	const u64 start = GetCPUTicks();
+	std::lock_guard<std::mutex> lock( m_dataLock );
+	const u64 waited = GetCPUTicks() - start;
+	m_ioWaitTicks += waited;
+	m_ioBlockedTicks += waited;
+
 	u8* src = GetSystemBlockPointer( adr );
 	if ( src != nullptr ) {
 		memcpy( dest, src, dataLength );
 	} else {
+		const u64 readStart = GetCPUTicks();
 		if ( !ReadFromFile( dest, adr, dataLength ) ) {
 			memset( dest, 0xFF, dataLength );
 		}
+		m_ioBlockedTicks += GetCPUTicks() - readStart;
 	}
 }
 
+bool FolderMemoryCard::ReadFromJournal( u8* const dest, const u32 adr, const u32 dataLength ) {
+	if ( !m_flushPending ) { return false; }
+
+	const u32 page = adr / PageSizeRaw;
+	const u32 offset = adr % PageSizeRaw;
+
+	std::lock_guard<std::mutex> lock( m_flushLock );
+	auto it = m_flushCache.find( page );
+	if ( it == m_flushCache.end() ) { return false; }
+
+	memcpy( dest, &it->second.raw[offset], dataLength );
+	return true;
+}
+
 s32 FolderMemoryCard::Save( const u8 *src, u32 adr, int size ) {
 	//const u32 block = adr / BlockSizeRaw;
 	//const u32 cluster = adr / ClusterSizeRaw;
@@ -858,9 +997,37 @@ void FolderMemoryCard::NextFrame() {
 	}
 }
 
-void FolderMemoryCard::Flush() {
+void FolderMemoryCard::Flush( bool async ) {
+	WaitForFlush();
 	if ( m_cache.empty() ) { return; }
 
+	// Hand the dirty pages over to the journal. The EE keeps writing into a fresh m_cache, which
+	// also coalesces all writes to a page until the next flush.
+	{
+		std::lock_guard<std::mutex> lock( m_flushLock );
+		m_flushCache.swap( m_cache );
+		m_flushOldDataCache.swap( m_oldDataCache );
+		m_flushPending = true;
+	}
+
+	if ( async ) {
+		try {
+			m_flushThread = std::thread( &FolderMemoryCard::FlushJournal, this );
+			return;
+		} catch ( std::system_error& ) {
+			// couldn't start the thread, just write it out from here
+		}
+	}
+
+	const u64 start = GetCPUTicks();
+	FlushJournal();
+	m_ioBlockedTicks += GetCPUTicks() - start;
+	WaitForFlush();
+}
+
+void FolderMemoryCard::FlushJournal() {
+	if ( m_flushCache.empty() ) { return; }
+
 	#ifdef DEBUG_WRITE_FOLDER_CARD_IN_MEMORY_TO_FILE_ON_CHANGE
 	WriteToFile( m_folderName.GetFullPath().RemoveLast() + L"-debug_" + wxDateTime::Now().Format( L"%Y-%m-%d-%H-%M-%S" ) + L"_pre-flush.ps2" );
 	#endif
@@ -868,6 +1035,9 @@ void FolderMemoryCard::Flush() {
 	Console.WriteLn( L"(FolderMcd) Writing data for slot %u to file system...", m_slot );
 	const u64 timeFlushStart = wxGetLocalTimeMillis().GetValue();
 
+	// the file system structure is rebuilt in one go, reads of the data wait for it
+	std::unique_lock<std::mutex> dataLock( m_dataLock );
+
 	// Keep a copy of the old file entries so we can figure out which files and directories, if any, have been deleted from the memory card.
 	std::vector<MemoryCardFileEntryTreeNode> oldFileEntryTree;
 	if ( IsFormatted() ) {
@@ -913,14 +1083,26 @@ void FolderMemoryCard::Flush() {
 	// Now we have the new file system, compare it to the old one and "delete" any files that were in it before but aren't anymore.
 	FlushDeletedFilesAndRemoveUnchangedDataFromCache( oldFileEntryTree );
 
-	// and finally, flush everything that hasn't been flushed yet
+	// and finally, flush everything that hasn't been flushed yet; the structure is complete, so
+	// reads can go in between the pages
+	dataLock.unlock();
 	for ( uint i = 0; i < pageCount; ++i ) {
+		std::lock_guard<std::mutex> pageLock( m_dataLock );
 		FlushPage( i );
 	}
+	dataLock.lock();
+
+	// the pages went into staged copies of the files, replace the files in one go each
+	if ( !m_lastAccessedFile.PublishStaged( m_folderName ) ) {
+		Console.Warning( L"(FolderMcd) Could not write all files of slot %u to the file system!", m_slot );
+	}
 
 	m_lastAccessedFile.FlushAll();
 	m_lastAccessedFile.ClearMetadataWriteState();
-	m_oldDataCache.clear();
+	{
+		std::lock_guard<std::mutex> lock( m_flushLock );
+		m_flushOldDataCache.clear();
+	}
 
 	const u64 timeFlushEnd = wxGetLocalTimeMillis().GetValue();
 	Console.WriteLn( L"(FolderMcd) Done! Took %u ms.", timeFlushEnd - timeFlushStart );
@@ -930,11 +1112,39 @@ void FolderMemoryCard::Flush() {
 	#endif
 }
 
+void FolderMemoryCard::WaitForFlush() {
+	if ( m_flushThread.joinable() ) {
+		const u64 start = GetCPUTicks();
+		m_flushThread.join();
+		const u64 waited = GetCPUTicks() - start;
+		m_ioWaitTicks += waited;
+		m_ioBlockedTicks += waited;
+	}
+
+	if ( !m_flushPending ) { return; }
+
+	// The journal is normally empty by now, unless the flush was aborted. Take its leftovers back
+	// so the next flush retries them; pages the EE has written since are newer and win, while the
+	// old data of the journal predates whatever the EE has recorded since and wins.
+	std::lock_guard<std::mutex> lock( m_flushLock );
+	m_cache.insert( m_flushCache.begin(), m_flushCache.end() );
+	for ( auto& it : m_flushOldDataCache ) {
+		m_oldDataCache[it.first] = it.second;
+	}
+	m_flushCache.clear();
+	m_flushOldDataCache.clear();
+	m_flushPending = false;
+}
+
 bool FolderMemoryCard::FlushPage( const u32 page ) {
-	auto it = m_cache.find( page );
-	if ( it != m_cache.end() ) {
-		WriteWithoutCache( &it->second.raw[0], page * PageSizeRaw, PageSize );
-		m_cache.erase( it );
+	auto it = m_flushCache.find( page );
+	if ( it != m_flushCache.end() ) {
+		// the EE may read this page from the journal until it's erased, so write from a copy
+		MemoryCardPage data = it->second;
+		WriteWithoutCache( &data.raw[0], page * PageSizeRaw, PageSize );
+
+		std::lock_guard<std::mutex> lock( m_flushLock );
+		m_flushCache.erase( it );
 		return true;
 	}
 	return false;
@@ -958,12 +1168,12 @@ bool FolderMemoryCard::FlushBlock( const u32 block ) {
 }
 
 void FolderMemoryCard::FlushSuperBlock() {
-	if ( FlushBlock( 0 ) && m_performFileWrites ) {
+	if ( !FlushBlock( 0 ) ) { return; }
+
+	UpdateSuperBlockSnapshot();
+	if ( m_performFileWrites ) {
 		wxFileName superBlockFileName( m_folderName.GetPath(), L"_pcsx2_superblock" );
-		wxFFile superBlockFile( superBlockFileName.GetFullPath().c_str(), L"wb" );
-		if ( superBlockFile.IsOpened() ) {
-			superBlockFile.Write( &m_superBlock.raw, sizeof( m_superBlock.raw ) );
-		}
+		FileAccessHelper::WriteFileAtomically( superBlockFileName.GetFullPath(), &m_superBlock.raw, sizeof( m_superBlock.raw ) );
 	}
 }
 
@@ -1001,11 +1211,7 @@ void FolderMemoryCard::FlushFileEntries( const u32 dirCluster, const u32 remaini
 						if ( !metaFileName.DirExists() ) {
 							metaFileName.Mkdir();
 						}
-						wxFFile metaFile( metaFileName.GetFullPath(), L"wb" );
-						if ( metaFile.IsOpened() ) {
-							metaFile.Write( entry->entry.raw, sizeof( entry->entry.raw ) );
-							metaFile.Close();
-						}
+						FileAccessHelper::WriteFileAtomically( metaFileName.GetFullPath(), entry->entry.raw, sizeof( entry->entry.raw ) );
 					} else {
 						// if metadata is standard make sure to remove a possibly existing metadata file
 						if ( metaFileName.FileExists() ) {
@@ -1108,13 +1314,14 @@ void FolderMemoryCard::RemoveUnchangedDataFromCache( const MemoryCardFileEntry*
 	while ( cluster != LastDataCluster ) {
 		for ( int i = 0; i < 2; ++i ) {
 			const u32 page = ( cluster + alloc_offset ) * 2 + i;
-			auto newIt = m_cache.find( page );
-			if ( newIt == m_cache.end() ) { continue; }
-			auto oldIt = m_oldDataCache.find( page );
-			if ( oldIt == m_oldDataCache.end() ) { continue; }
+			auto newIt = m_flushCache.find( page );
+			if ( newIt == m_flushCache.end() ) { continue; }
+			auto oldIt = m_flushOldDataCache.find( page );
+			if ( oldIt == m_flushOldDataCache.end() ) { continue; }
 
 			if ( memcmp( &oldIt->second.raw[0], &newIt->second.raw[0], PageSize ) == 0 ) {
-				m_cache.erase( newIt );
+				std::lock_guard<std::mutex> lock( m_flushLock );
+				m_flushCache.erase( newIt );
 			}
 		}
 
@@ -1176,33 +1383,20 @@ bool FolderMemoryCard::WriteToFile( const u8* src, u32 adr, u32 dataLength ) {
 		const u32 clusterNumber = it->second.consecutiveCluster;
 		
 		if ( m_performFileWrites ) {
-			wxFFile* file = m_lastAccessedFile.ReOpen( m_folderName, &it->second, true );
-			if ( file->IsOpened() ) {
-				const u32 clusterOffset = ( page % 2 ) * PageSize + offset;
-				const u32 fileSize = entry->entry.data.length;
-				const u32 fileOffsetStart = std::min( clusterNumber * ClusterSize + clusterOffset, fileSize );
-				const u32 fileOffsetEnd = std::min( fileOffsetStart + dataLength, fileSize );
-				const u32 bytesToWrite = fileOffsetEnd - fileOffsetStart;
-
-				wxFileOffset actualFileSize = file->Length();
-				if ( actualFileSize < fileOffsetStart ) {
-					file->Seek( actualFileSize );
-					const u32 diff = fileOffsetStart - actualFileSize;
-					u8 temp = 0xFF;
-					for ( u32 i = 0; i < diff; ++i ) {
-						file->Write( &temp, 1 );
-					}
-				}
-
-				const wxFileOffset fileOffset = file->Tell();
-				if ( fileOffset != fileOffsetStart ) {
-					file->Seek( fileOffsetStart );
-				}
-				if ( bytesToWrite > 0 ) {
-					file->Write( src, bytesToWrite );
-				}
-			} else {
-				return false;
+			// the file is patched in memory and renamed into place at the end of FlushJournal()
+			std::vector<u8>& data = m_lastAccessedFile.Stage( m_folderName, &it->second );
+			const u32 clusterOffset = ( page % 2 ) * PageSize + offset;
+			const u32 fileSize = entry->entry.data.length;
+			const u32 fileOffsetStart = std::min( clusterNumber * ClusterSize + clusterOffset, fileSize );
+			const u32 fileOffsetEnd = std::min( fileOffsetStart + dataLength, fileSize );
+			const u32 bytesToWrite = fileOffsetEnd - fileOffsetStart;
+
+			// a gap between the end of the file and the written data reads back as erased
+			if ( data.size() < fileOffsetEnd ) {
+				data.resize( fileOffsetEnd, 0xFF );
+			}
+			if ( bytesToWrite > 0 ) {
+				memcpy( &data[fileOffsetStart], src, bytesToWrite );
 			}
 		}
 
@@ -1286,7 +1480,8 @@ void FolderMemoryCard::SetSlot( uint slot ) {
 }
 
 u32 FolderMemoryCard::GetSizeInClusters() const {
-	const u32 clusters = m_superBlock.data.clusters_per_card;
+	std::lock_guard<std::mutex> lock( m_flushLock );
+	const u32 clusters = m_superBlockSnapshot.clusters_per_card;
 	if ( clusters > 0 && clusters < 0xFFFFFFFFu ) {
 		return clusters;
 	} else {
@@ -1296,23 +1491,29 @@ u32 FolderMemoryCard::GetSizeInClusters() const {
 
 void FolderMemoryCard::SetSizeInClusters( u32 clusters ) {
 	superBlockUnion newSuperBlock;
-	memcpy( &newSuperBlock.raw[0], &m_superBlock.raw[0], sizeof( newSuperBlock.raw ) );
-
-	newSuperBlock.data.clusters_per_card = clusters;
-	
-	const u32 alloc_offset = clusters / 0x100 + 9;
-	newSuperBlock.data.alloc_offset = alloc_offset;
-	newSuperBlock.data.alloc_end = clusters - 0x10 - alloc_offset;
-
-	const u32 blocks = clusters / 8;
-	newSuperBlock.data.backup_block1 = blocks - 1;
-	newSuperBlock.data.backup_block2 = blocks - 2;
+	{
+		std::lock_guard<std::mutex> lock( m_dataLock );
+		memcpy( &newSuperBlock.raw[0], &m_superBlock.raw[0], sizeof( newSuperBlock.raw ) );
+	}
+	ResizeSuperBlock( &newSuperBlock, clusters );
 
 	for ( size_t i = 0; i < sizeof( newSuperBlock.raw ) / PageSize; ++i ) {
 		Save( &newSuperBlock.raw[i * PageSize], i * PageSizeRaw, PageSize );
 	}
 }
 
+void FolderMemoryCard::ResizeSuperBlock( superBlockUnion* superBlock, u32 clusters ) {
+	superBlock->data.clusters_per_card = clusters;
+
+	const u32 alloc_offset = clusters / 0x100 + 9;
+	superBlock->data.alloc_offset = alloc_offset;
+	superBlock->data.alloc_end = clusters - 0x10 - alloc_offset;
+
+	const u32 blocks = clusters / 8;
+	superBlock->data.backup_block1 = blocks - 1;
+	superBlock->data.backup_block2 = blocks - 2;
+}
+
 void FolderMemoryCard::SetSizeInMB( u32 megaBytes ) {
 	SetSizeInClusters( ( megaBytes * 1024 * 1024 ) / ClusterSize );
 }
@@ -1429,6 +1630,20 @@ wxFFile* FileAccessHelper::Open( const wxFileName& folderName, MemoryCardFileMet
 	return file;
 }
 
+bool FileAccessHelper::WriteFileAtomically( const wxString& filename, const void* data, size_t size ) {
+	const wxString tempFilename = filename + L".tmp";
+	{
+		wxFFile file( tempFilename, L"wb" );
+		if ( !file.IsOpened() ) { return false; }
+		const bool written = size == 0 || file.Write( data, size ) == size;
+		if ( !file.Close() || !written ) {
+			wxRemoveFile( tempFilename );
+			return false;
+		}
+	}
+	return wxRenameFile( tempFilename, filename, true );
+}
+
 void FileAccessHelper::WriteMetadata( const wxFileName& folderName, MemoryCardFileMetadataReference* fileRef ) {
 	wxFileName fn( folderName );
 	bool cleanedFilename = fileRef->GetPath( &fn );
@@ -1446,11 +1661,7 @@ void FileAccessHelper::WriteMetadata( bool metadataIsNonstandard, wxFileName& me
 		if ( !metadataFilename.DirExists() ) {
 			metadataFilename.Mkdir();
 		}
-		wxFFile metaFile( metadataFilename.GetFullPath(), L"wb" );
-		if ( metaFile.IsOpened() ) {
-			metaFile.Write( entry->entry.raw, sizeof( entry->entry.raw ) );
-			metaFile.Close();
-		}
+		WriteFileAtomically( metadataFilename.GetFullPath(), entry->entry.raw, sizeof( entry->entry.raw ) );
 	} else {
 		// if metadata is standard remove metadata file if it exists
 		if ( metadataFilename.FileExists() ) {
@@ -1538,6 +1749,77 @@ void FileAccessHelper::ClearMetadataWriteState() {
 	m_lastWrittenFileRef = nullptr;
 }
 
+std::vector<u8>& FileAccessHelper::Stage( const wxFileName& folderName, MemoryCardFileMetadataReference* fileRef ) {
+	std::string internalPath;
+	fileRef->GetInternalPath( &internalPath );
+	auto it = m_staged.find( internalPath );
+	if ( it != m_staged.end() ) {
+		it->second.fileRef = fileRef;
+		return it->second.data;
+	}
+
+	MemoryCardStagedFile& staged = m_staged[internalPath];
+	staged.fileRef = fileRef;
+
+	// a flush only rewrites the pages that changed, so start from the current contents
+	wxFileName fn( folderName );
+	fileRef->GetPath( &fn );
+	if ( fn.FileExists() ) {
+		wxFFile file( fn.GetFullPath(), L"rb" );
+		if ( file.IsOpened() && file.Length() > 0 ) {
+			staged.data.resize( file.Length() );
+			staged.data.resize( file.Read( &staged.data[0], staged.data.size() ) );
+		}
+	}
+
+	return staged.data;
+}
+
+const std::vector<u8>* FileAccessHelper::FindStaged( MemoryCardFileMetadataReference* fileRef ) const {
+	if ( m_staged.empty() ) { return nullptr; }
+
+	std::string internalPath;
+	fileRef->GetInternalPath( &internalPath );
+	auto it = m_staged.find( internalPath );
+	return it != m_staged.end() ? &it->second.data : nullptr;
+}
+
+bool FileAccessHelper::PublishStaged( const wxFileName& folderName ) {
+	bool success = true;
+
+	for ( auto it = m_staged.begin(); it != m_staged.end(); ++it ) {
+		MemoryCardFileMetadataReference* const fileRef = it->second.fileRef;
+		const MemoryCardFileEntry* const entry = fileRef->entry;
+
+		// an open handle would keep reading the old file once the new one is renamed over it
+		auto handle = m_files.find( it->first );
+		if ( handle != m_files.end() ) {
+			CloseFileHandle( handle->second.fileHandle );
+			m_files.erase( handle );
+		}
+
+		wxFileName fn( folderName );
+		fileRef->GetPath( &fn );
+		if ( !fn.DirExists() ) {
+			fn.Mkdir( 0777, wxPATH_MKDIR_FULL );
+		}
+
+		const std::vector<u8>& data = it->second.data;
+		if ( WriteFileAtomically( fn.GetFullPath(), data.empty() ? nullptr : &data[0], data.size() ) ) {
+			wxDateTime modified = entry->entry.data.timeModified.ToWxDateTime();
+			wxDateTime created = entry->entry.data.timeCreated.ToWxDateTime();
+			fn.SetTimes( nullptr, &modified, &created );
+		} else {
+			success = false;
+		}
+
+		WriteMetadata( folderName, fileRef );
+	}
+
+	m_staged.clear();
+	return success;
+}
+
 bool FileAccessHelper::CleanMemcardFilename( char* name ) {
 	// invalid characters for filenames in the PS2 file system: { '/', '?', '*' }
 	// the following characters are valid in a PS2 memcard file system but invalid in Windows
@@ -1609,6 +1891,152 @@ void MemoryCardFileMetadataReference::GetInternalPath( std::string* fileName ) c
 	}
 }
 
+FolderMemoryCardIndex::FolderMemoryCardIndex() {
+	Clear();
+}
+
+void FolderMemoryCardIndex::Clear() {
+	m_entries.clear();
+	m_dirty = false;
+	m_lookups = 0;
+	m_hits = 0;
+}
+
+size_t FolderMemoryCardIndex::Load( const wxString& filename ) {
+	Clear();
+
+	wxFFile file;
+	if ( !wxFileName::FileExists( filename ) || !file.Open( filename, L"rb" ) ) {
+		return 0;
+	}
+
+	std::vector<u8> data( file.Length() );
+	const size_t bytesRead = data.empty() ? 0 : file.Read( &data[0], data.size() );
+	if ( bytesRead != data.size() ) {
+		return bytesRead;
+	}
+
+	size_t pos = 0;
+	auto read = [&]( void* dest, size_t size ) {
+		if ( data.size() - pos < size ) { return false; }
+		memcpy( dest, &data[pos], size );
+		pos += size;
+		return true;
+	};
+
+	u32 header[3];
+	if ( !read( header, sizeof( header ) ) || header[0] != FileMagic || header[1] != FileVersion ) {
+		Console.Warning( L"(FolderMcd) Ignoring invalid index file %s", WX_STR( filename ) );
+		return bytesRead;
+	}
+
+	// entries are stored with the trailing zeros of the entry cut off
+	for ( u32 i = 0; i < header[2]; ++i ) {
+		u16 pathLength, entryLength;
+		Entry entry;
+		if ( !read( &pathLength, sizeof( pathLength ) ) || data.size() - pos < pathLength ) { break; }
+		std::string path( (const char*)&data[pos], pathLength );
+		pos += pathLength;
+
+		memset( &entry.entry.entry.raw[0], 0, sizeof( entry.entry.entry.raw ) );
+		if ( !read( &entry.key, sizeof( entry.key ) ) || !read( &entryLength, sizeof( entryLength ) )
+		  || entryLength > sizeof( entry.entry.entry.raw ) || !read( &entry.entry.entry.raw[0], entryLength ) ) {
+			break;
+		}
+
+		entry.used = false;
+		m_entries.emplace( std::move( path ), entry );
+	}
+
+	return bytesRead;
+}
+
+bool FolderMemoryCardIndex::Save( const wxString& filename, bool pruneUnused ) {
+	if ( pruneUnused ) {
+		for ( auto it = m_entries.begin(); it != m_entries.end(); ) {
+			if ( !it->second.used ) {
+				it = m_entries.erase( it );
+				m_dirty = true;
+			} else {
+				++it;
+			}
+		}
+	}
+
+	if ( !m_dirty ) { return true; }
+
+	std::vector<u8> data;
+	auto write = [&]( const void* src, size_t size ) {
+		data.insert( data.end(), (const u8*)src, (const u8*)src + size );
+	};
+
+	const u32 header[3] = { FileMagic, FileVersion, (u32)m_entries.size() };
+	write( header, sizeof( header ) );
+
+	for ( const auto& it : m_entries ) {
+		const u8* raw = &it.second.entry.entry.raw[0];
+		u16 entryLength = sizeof( it.second.entry.entry.raw );
+		while ( entryLength > 0 && raw[entryLength - 1] == 0 ) {
+			--entryLength;
+		}
+
+		const u16 pathLength = (u16)it.first.size();
+		write( &pathLength, sizeof( pathLength ) );
+		write( it.first.data(), pathLength );
+		write( &it.second.key, sizeof( it.second.key ) );
+		write( &entryLength, sizeof( entryLength ) );
+		write( raw, entryLength );
+	}
+
+	if ( !FileAccessHelper::WriteFileAtomically( filename, &data[0], data.size() ) ) {
+		Console.Warning( L"(FolderMcd) Could not write index file %s", WX_STR( filename ) );
+		return false;
+	}
+
+	m_dirty = false;
+	return true;
+}
+
+const MemoryCardFileEntry* FolderMemoryCardIndex::Find( const std::string& path, const Key& key ) {
+	++m_lookups;
+
+	auto it = m_entries.find( path );
+	if ( it == m_entries.end() ) { return nullptr; }
+
+	it->second.used = true;
+	if ( !( it->second.key == key ) ) { return nullptr; }
+
+	++m_hits;
+	return &it->second.entry;
+}
+
+void FolderMemoryCardIndex::Update( const std::string& path, const Key& key, const MemoryCardFileEntry* const entry ) {
+	Entry& indexEntry = m_entries[path];
+	indexEntry.key = key;
+	indexEntry.entry = *entry;
+	indexEntry.used = true;
+	m_dirty = true;
+}
+
+bool FolderMemoryCardIndex::GetKey( const wxString& path, const wxString& metaPath, Key* key ) {
+	wxStructStat st;
+	if ( wxStat( path, &st ) != 0 ) {
+		return false;
+	}
+	key->size = ( st.st_mode & S_IFDIR ) ? 0 : st.st_size;
+	key->modified = st.st_mtime;
+
+	if ( wxStat( metaPath, &st ) == 0 ) {
+		key->metaSize = st.st_size;
+		key->metaModified = st.st_mtime;
+	} else {
+		key->metaSize = 0;
+		key->metaModified = -1;
+	}
+
+	return true;
+}
+
 FolderMemoryCardAggregator::FolderMemoryCardAggregator() {
 	for ( uint i = 0; i < TotalCardSlots; ++i ) {
 		m_cards[i].SetSlot( i );
@@ -19,6 +19,8 @@
 #include <wx/dir.h>
 #include <wx/ffile.h>
 #include <map>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "PluginCallbacks.h"
@@ -207,6 +209,11 @@ struct MemoryCardFileHandleStructure {
 	wxFFile* fileHandle;
 };
 
+struct MemoryCardStagedFile {
+	MemoryCardFileMetadataReference* fileRef;
+	std::vector<u8> data;
+};
+
 // --------------------------------------------------------------------------------------
 //  FileAccessHelper
 // --------------------------------------------------------------------------------------
@@ -214,6 +221,7 @@ struct MemoryCardFileHandleStructure {
 class FileAccessHelper {
 protected:
 	std::map<std::string, MemoryCardFileHandleStructure> m_files;
+	std::map<std::string, MemoryCardStagedFile> m_staged;
 	MemoryCardFileMetadataReference* m_lastWrittenFileRef; // we remember this to reduce redundant metadata checks/writes
 
 public:
@@ -232,10 +240,24 @@ public:
 	// Force metadata to be written on next file access, not sure if this is necessary but it can't hurt.
 	void ClearMetadataWriteState();
 
+	// Get the new contents of a file, kept in memory until PublishStaged(); the first call for a
+	// file starts from what's currently on disk
+	std::vector<u8>& Stage( const wxFileName& folderName, MemoryCardFileMetadataReference* fileRef );
+	// Get the staged contents of a file, or nullptr if nothing has been staged for it
+	const std::vector<u8>* FindStaged( MemoryCardFileMetadataReference* fileRef ) const;
+	// Write every staged file with WriteFileAtomically() along with its metadata, so an interrupted
+	// flush leaves each file either old or new but never half written
+	// returns false if any file couldn't be written
+	bool PublishStaged( const wxFileName& folderName );
+
 	// removes characters from a PS2 file name that would be illegal in a Windows file system
 	// returns true if any changes were made
 	static bool CleanMemcardFilename( char* name );
 
+	// writes a small file next to its destination and renames it into place, so that an
+	// interrupted write never leaves a truncated superblock or metadata file behind
+	static bool WriteFileAtomically( const wxString& filename, const void* data, size_t size );
+
 protected:
 	// helper function for CleanMemcardFilename()
 	static bool CleanMemcardFilenameEndDotOrSpace( char* name, size_t length );
@@ -250,6 +272,62 @@ protected:
 	void WriteMetadata( bool metadataIsNonstandard, wxFileName& metadataFilename, const MemoryCardFileEntry* const entry );
 };
 
+// --------------------------------------------------------------------------------------
+//  FolderMemoryCardIndex
+// --------------------------------------------------------------------------------------
+// File and directory entries built from the host file system on the last load, stored in
+// the memory card folder as _pcsx2_index. An entry is only reused while the size and
+// modification time of both the host file (or directory) and its metadata file still match.
+class FolderMemoryCardIndex {
+public:
+	static const u32 FileMagic = 0x4944434d; // "MCDI"
+	static const u32 FileVersion = 1;
+
+	struct Key {
+		u64 size;
+		s64 modified;
+		u64 metaSize;
+		s64 metaModified;
+
+		bool operator==( const Key& other ) const {
+			return size == other.size && modified == other.modified && metaSize == other.metaSize && metaModified == other.metaModified;
+		}
+	};
+
+protected:
+	struct Entry {
+		Key key;
+		MemoryCardFileEntry entry;
+		bool used;
+	};
+
+	// by path relative to the memory card folder
+	std::map<std::string, Entry> m_entries;
+	bool m_dirty;
+	uint m_lookups;
+	uint m_hits;
+
+public:
+	FolderMemoryCardIndex();
+
+	void Clear();
+	// returns the number of bytes read
+	size_t Load( const wxString& filename );
+	// writes the index if anything changed; if pruneUnused, entries that weren't looked up since
+	// Load() belong to files that are gone and are dropped
+	bool Save( const wxString& filename, bool pruneUnused );
+
+	// returns the cached entry for the given path if it was built from the same files, else nullptr
+	const MemoryCardFileEntry* Find( const std::string& path, const Key& key );
+	void Update( const std::string& path, const Key& key, const MemoryCardFileEntry* const entry );
+
+	uint GetLookupCount() const { return m_lookups; }
+	uint GetHitCount() const { return m_hits; }
+
+	// stats a file or directory and its metadata file, returns false if the former doesn't exist
+	static bool GetKey( const wxString& path, const wxString& metaPath, Key* key );
+};
+
 // --------------------------------------------------------------------------------------
 //  FolderMemoryCard
 // --------------------------------------------------------------------------------------
@@ -307,6 +385,28 @@ protected:
 	// used to reduce the amount of disk I/O by not re-writing unchanged data that just happened to be
 	// touched in memory due to how actual physical memory cards have to erase and rewrite in blocks
 	std::map<u32, MemoryCardPage> m_oldDataCache;
+
+	// write-back journal: on Flush the dirty pages move here and a background thread writes them
+	// to the file system, while m_cache starts collecting the next batch of writes.  Reads of a
+	// page still in the journal are served from it, other reads go to the internal data and the
+	// host files under m_dataLock.  The writer holds that lock while it rebuilds the file system
+	// structure and then once per data page, so a read never waits for the whole flush.
+	// Data pages go into staged copies of the save files (see FileAccessHelper::Stage), which
+	// replace the files at the end of the flush, so an interrupted flush never leaves one half
+	// written.
+	std::map<u32, MemoryCardPage> m_flushCache;
+	std::map<u32, MemoryCardPage> m_flushOldDataCache;
+	mutable std::mutex m_flushLock;
+	std::mutex m_dataLock;
+	// copy of the superblock for IsFormatted() and GetSizeInClusters(), which may be called while
+	// the writer changes m_superBlock; updated under m_flushLock (see UpdateSuperBlockSnapshot)
+	superblock m_superBlockSnapshot;
+	std::thread m_flushThread;
+	bool m_flushPending;
+	// time the calling (EE) thread spent on host file I/O and waiting for the writer, in CPU ticks
+	u64 m_ioBlockedTicks;
+	u64 m_ioWaitTicks;
+
 	// if > 0, the amount of frames until data is flushed to the file system
 	// reset to FramesAfterWriteUntilFlush on each write
 	int m_framesUntilFlush;
@@ -316,6 +416,15 @@ protected:
 	// remembers and keeps the last accessed file open for further access
 	FileAccessHelper m_lastAccessedFile;
 
+	// if set, files aren't opened while indexing but on first access, and entries are taken from
+	// m_index where possible; this also means files aren't locked against outside changes until then
+	bool m_lazyIndexing;
+	FolderMemoryCardIndex m_index;
+
+	// bytes read from the host file system while indexing and from save files afterwards
+	u64 m_indexBytesRead;
+	u64 m_fileBytesRead;
+
 	// path to the folder that contains the files of this memory card
 	wxFileName m_folderName;
 
@@ -333,7 +442,7 @@ protected:
 
 public:
 	FolderMemoryCard();
-	virtual ~FolderMemoryCard() = default;
+	virtual ~FolderMemoryCard();
 
 	void Lock();
 	void Unlock();
@@ -381,6 +490,12 @@ protected:
 
 	bool IsFormatted() const;
 
+	// copies m_superBlock for IsFormatted() and GetSizeInClusters(), call after changing it
+	void UpdateSuperBlockSnapshot();
+
+	// sets the size and the fields that depend on it in the given superblock
+	static void ResizeSuperBlock( superBlockUnion* superBlock, u32 clusters );
+
 	// returns the in-memory address of data the given memory card adr corresponds to
 	// returns nullptr if adr corresponds to a folder or file entry
 	u8* GetSystemBlockPointer( const u32 adr );
@@ -482,8 +597,17 @@ protected:
 	bool WriteToFile( const u8* src, u32 adr, u32 dataLength );
 
 
-	// flush the whole cache to the internal data and/or host file system
-	void Flush();
+	// hand the whole cache over to the write-back thread, or write it synchronously if !async
+	void Flush( bool async = true );
+
+	// writes the journal to the internal data and/or host file system, runs on the write-back thread
+	void FlushJournal();
+
+	// waits for a write-back in progress and takes back whatever it left unwritten
+	void WaitForFlush();
+
+	// copies a page from the write-back journal, if it's still there
+	bool ReadFromJournal( u8* const dest, const u32 adr, const u32 dataLength );
 
 	// flush a single page of the cache to the internal data and/or host file system
 	bool FlushPage( const u32 page );
@@ -19,6 +19,8 @@
 
 #include "System/SysThreads.h"
 #include "SaveState.h"
+#include "RewindBuffer.h"
+#include "DirtyPageTracker.h"
 #include "VUmicro.h"
 
 #include "ZipTools/ThreadedZipTools.h"
@@ -29,6 +31,7 @@
 #include "ConsoleLogger.h"
 
 #include <wx/wfstream.h>
+#include <wx/mstream.h>
 #include <memory>
 
 #include "Patch.h"
@@ -39,6 +42,7 @@
 static const wxChar* EntryFilename_StateVersion = L"PCSX2 Savestate Version.id";
 static const wxChar* EntryFilename_Screenshot = L"Screenshot.jpg";
 static const wxChar* EntryFilename_InternalStructures = L"PCSX2 Internal Structures.dat";
+static const wxChar* EntryFilename_BaseState = L"Base Savestate.dat";
 
 
 // --------------------------------------------------------------------------------------
@@ -56,6 +60,9 @@ public:
 	virtual void FreezeIn(pxInputStream& reader) const = 0;
 	virtual void FreezeOut(SaveStateBase& writer) const = 0;
 	virtual bool IsRequired() const = 0;
+
+	// Main memory region an incremental savestate stores as pages changed since its base, or -1.
+	virtual int GetIncrementalRegion() const { return -1; }
 };
 
 class MemorySavestateEntry : public BaseSavestateEntry
@@ -154,6 +161,7 @@ public:
 	wxString GetFilename() const { return L"eeMemory.bin"; }
 	u8* GetDataPtr() const { return eeMem->Main; }
 	uint GetDataSize() const { return sizeof(eeMem->Main); }
+	int GetIncrementalRegion() const { return DirtyPageTracker::Region_EEMain; }
 
 	virtual void FreezeIn(pxInputStream& reader) const
 	{
@@ -170,6 +178,7 @@ public:
 	wxString GetFilename() const { return L"iopMemory.bin"; }
 	u8* GetDataPtr() const { return iopMem->Main; }
 	uint GetDataSize() const { return sizeof(iopMem->Main); }
+	int GetIncrementalRegion() const { return DirtyPageTracker::Region_IOPMain; }
 };
 
 class SavestateEntry_HwRegs : public MemorySavestateEntry
@@ -323,6 +332,184 @@ static const std::unique_ptr<BaseSavestateEntry> SavestateEntries[] = {
 //
 static Mutex mtx_CompressToDisk;
 
+// --------------------------------------------------------------------------------------
+//  Incremental savestates
+// --------------------------------------------------------------------------------------
+// With EmuConfig.IncrementalSavestates, a state saved after a full one only holds the pages of
+// EE and IOP main memory written since that full state, its base.  They replace eeMemory.bin
+// and iopMemory.bin with eeMemory.pages and iopMemory.pages: a u32 page count, the page
+// indices, then the pages.  EntryFilename_BaseState holds a hash of the base's main memory,
+// followed by the base's file name (UTF8, same folder).  Loading reads the base's main memory
+// first and refuses the state when the hash doesn't match, i.e. the base was overwritten.
+//
+// A full state, and a new base, is saved instead when the VM memory was reset or a state
+// was loaded since the base, when saving over the base itself or to another folder, or when
+// more than half of the pages changed.
+//
+struct IncrementalSaveChain
+{
+	wxString base;		// full path of the base, empty when there's none
+	u64 hash;
+};
+
+// Only used by the SysExecutor thread, which saves the states.
+static IncrementalSaveChain s_SaveChain;
+
+static wxString GetPagesFilename(const BaseSavestateEntry& entry)
+{
+	return entry.GetFilename().BeforeLast(L'.') + L".pages";
+}
+
+static u64 HashMainMemory()
+{
+	u64 hash = 0;
+	for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
+	{
+		const int region = SavestateEntries[i]->GetIncrementalRegion();
+		if (region >= 0)
+			hash = DirtyPageTracker::HashMemory(g_DirtyPages.GetRegionPtr((DirtyPageTracker::RegionId)region),
+				g_DirtyPages.GetRegionSize((DirtyPageTracker::RegionId)region), hash);
+	}
+	return hash;
+}
+
+// Pages for an incremental state saved to filename, or false when it must be a full state.
+static bool GetIncrementalPages(const wxString& filename, std::vector<u32> (&pages)[DirtyPageTracker::Region_Count])
+{
+	if (!EmuConfig.IncrementalSavestates)
+	{
+		if (!s_SaveChain.base.IsEmpty())
+		{
+			s_SaveChain.base.clear();
+			g_DirtyPages.Release(DirtyPageTracker::Checkpoint_Savestate);
+		}
+		return false;
+	}
+
+	const wxFileName target(filename);
+	if (s_SaveChain.base.IsEmpty() || filename.IsEmpty() || target.SameAs(s_SaveChain.base) ||
+		target.GetPath() != wxFileName(s_SaveChain.base).GetPath() ||
+		!g_DirtyPages.IsValid(DirtyPageTracker::Checkpoint_Savestate))
+		return false;
+
+	uint changed = 0, total = 0;
+	for (uint i = 0; i < DirtyPageTracker::Region_Count; ++i)
+	{
+		const DirtyPageTracker::RegionId region = (DirtyPageTracker::RegionId)i;
+		g_DirtyPages.Collect(DirtyPageTracker::Checkpoint_Savestate, region, pages[i]);
+		changed += pages[i].size();
+		total += g_DirtyPages.GetRegionSize(region) / DirtyPageTracker::PageSize;
+	}
+	return changed <= total / 2;
+}
+
+static void FreezeOutPages(SaveStateBase& writer, DirtyPageTracker::RegionId region, std::vector<u32>& pages)
+{
+	const u8* base = g_DirtyPages.GetRegionPtr(region);
+
+	u32 count = pages.size();
+	writer.Freeze(count);
+	writer.FreezeMem(pages.data(), count * sizeof(u32));
+	for (u32 page : pages)
+		writer.FreezeMem(const_cast<u8*>(base) + page * DirtyPageTracker::PageSize, DirtyPageTracker::PageSize);
+}
+
+// Throws Exception::SaveStateLoadError if the pages entry doesn't fit the region.
+static void CheckPages(const wxString& filename, const ChunkedZipReader::Entry& entry, DirtyPageTracker::RegionId region)
+{
+	const uint max_pages = g_DirtyPages.GetRegionSize(region) / DirtyPageTracker::PageSize;
+	const u8* src = entry.data.data();
+
+	u32 count = 0;
+	if (entry.data.size() >= sizeof(count))
+		memcpy(&count, src, sizeof(count));
+
+	bool valid = entry.data.size() >= sizeof(count) && count <= max_pages &&
+		entry.data.size() == sizeof(count) + count * (sizeof(u32) + DirtyPageTracker::PageSize);
+
+	for (u32 i = 0; valid && i < count; i++)
+	{
+		u32 page;
+		memcpy(&page, src + sizeof(count) + i * sizeof(u32), sizeof(page));
+		valid = page < max_pages;
+	}
+
+	if (!valid)
+		throw Exception::SaveStateLoadError(filename)
+			.SetDiagMsg(pxsFmt(L"Savestate entry '%s' is corrupted.", WX_STR(entry.name)))
+			.SetUserMsg(_("This savestate cannot be loaded due to missing critical components.  See the log file for details."));
+}
+
+// Writes the pages over the region, the entry must have passed CheckPages.
+static void LoadPages(const ChunkedZipReader::Entry& entry, DirtyPageTracker::RegionId region)
+{
+	u8* dst = g_DirtyPages.GetRegionPtr(region);
+	const u8* src = entry.data.data();
+
+	u32 count;
+	memcpy(&count, src, sizeof(count));
+	const u8* data = src + sizeof(count) + count * sizeof(u32);
+
+	for (u32 i = 0; i < count; i++)
+	{
+		u32 page;
+		memcpy(&page, src + sizeof(count) + i * sizeof(u32), sizeof(page));
+		memcpy(dst + page * DirtyPageTracker::PageSize, data + i * DirtyPageTracker::PageSize, DirtyPageTracker::PageSize);
+	}
+}
+
+// Finds the base of an incremental savestate and reads it.  Throws Exception::SaveStateLoadError
+// when it's gone, or isn't the state this one was saved against anymore.
+static std::unique_ptr<ChunkedZipReader> OpenIncrementalBase(const wxString& filename, const ChunkedZipReader::Entry& info)
+{
+	u64 hash;
+	if (info.data.size() <= sizeof(hash))
+		throw Exception::SaveStateLoadError(filename)
+			.SetDiagMsg(pxsFmt(L"Savestate entry '%s' is corrupted.", EntryFilename_BaseState))
+			.SetUserMsg(_("This savestate cannot be loaded due to missing critical components.  See the log file for details."));
+
+	memcpy(&hash, info.data.data(), sizeof(hash));
+	wxFileName basefile(filename);
+	basefile.SetFullName(wxString::FromUTF8((const char*)info.data.data() + sizeof(hash), info.data.size() - sizeof(hash)));
+
+	// Saving over the base moves it to its backup, when backups are on.
+	const wxString candidates[] = {basefile.GetFullPath(), basefile.GetFullPath() + L".backup"};
+	for (const wxString& path : candidates)
+	{
+		if (!wxFileExists(path))
+			continue;
+
+		std::unique_ptr<ChunkedZipReader> base(new ChunkedZipReader(path));
+
+		bool complete = true;
+		for (uint i = 0; complete && i < ArraySize(SavestateEntries); ++i)
+			complete = SavestateEntries[i]->GetIncrementalRegion() < 0 || base->Find(SavestateEntries[i]->GetFilename());
+		if (!complete)
+			continue;
+
+		base->ExtractAll();
+
+		u64 found = 0;
+		for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
+		{
+			if (SavestateEntries[i]->GetIncrementalRegion() < 0)
+				continue;
+			const ChunkedZipReader::Entry* entry = base->Find(SavestateEntries[i]->GetFilename());
+			found = DirtyPageTracker::HashMemory(entry->data.data(), entry->data.size(), found);
+		}
+
+		if (found == hash)
+		{
+			Console.WriteLn(Color_Green, L" ... base savestate '%s'", WX_STR(path));
+			return base;
+		}
+	}
+
+	throw Exception::SaveStateLoadError(filename)
+		.SetDiagMsg(pxsFmt(L"Base savestate '%s' is missing or was overwritten.", WX_STR(basefile.GetFullPath())))
+		.SetUserMsg(_("This savestate only holds the changes since another savestate, which is missing or was overwritten since.  It cannot be loaded."));
+}
+
 static void CheckVersion(pxInputStream& thr)
 {
 	u32 savever;
@@ -354,13 +541,15 @@ class SysExecEvent_DownloadState : public SysExecEvent
 {
 protected:
 	ArchiveEntryList* m_dest_list;
+	wxString m_filename;
 
 public:
 	wxString GetEventName() const { return L"VM_Download"; }
 
 	virtual ~SysExecEvent_DownloadState() = default;
 	SysExecEvent_DownloadState* Clone() const { return new SysExecEvent_DownloadState(*this); }
-	SysExecEvent_DownloadState(ArchiveEntryList* dest_list = NULL)
+	SysExecEvent_DownloadState(ArchiveEntryList* dest_list = NULL, const wxString& filename = wxEmptyString)
+		: m_filename(filename)
 	{
 		m_dest_list = dest_list;
 	}
@@ -388,15 +577,55 @@ protected:
 		internals.SetDataSize(saveme.GetCurrentPos() - internals.GetDataIndex());
 		m_dest_list->Add(internals);
 
+		std::vector<u32> pages[DirtyPageTracker::Region_Count];
+		const bool incremental = GetIncrementalPages(m_filename, pages);
+
+		if (incremental)
+		{
+			ArchiveEntry base(EntryFilename_BaseState);
+			base.SetDataIndex(saveme.GetCurrentPos());
+
+			wxCharBuffer name(wxFileName(s_SaveChain.base).GetFullName().ToUTF8());
+			saveme.Freeze(s_SaveChain.hash);
+			saveme.FreezeMem(name.data(), strlen(name.data()));
+
+			base.SetDataSize(saveme.GetCurrentPos() - base.GetDataIndex());
+			m_dest_list->Add(base);
+		}
+
 		for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
 		{
+			const int region = SavestateEntries[i]->GetIncrementalRegion();
+			wxString name(SavestateEntries[i]->GetFilename());
+
 			uint startpos = saveme.GetCurrentPos();
-			SavestateEntries[i]->FreezeOut(saveme);
-			m_dest_list->Add(ArchiveEntry(SavestateEntries[i]->GetFilename())
+			if (incremental && region >= 0)
+			{
+				FreezeOutPages(saveme, (DirtyPageTracker::RegionId)region, pages[region]);
+				name = GetPagesFilename(*SavestateEntries[i]);
+			}
+			else
+				SavestateEntries[i]->FreezeOut(saveme);
+
+			m_dest_list->Add(ArchiveEntry(name)
 								 .SetDataIndex(startpos)
 								 .SetDataSize(saveme.GetCurrentPos() - startpos));
 		}
 
+		if (incremental)
+		{
+			DevCon.WriteLn(Color_Gray, L"(DownloadState) Incremental savestate: %u EE and %u IOP pages changed since '%s'",
+				(uint)pages[DirtyPageTracker::Region_EEMain].size(), (uint)pages[DirtyPageTracker::Region_IOPMain].size(),
+				WX_STR(wxFileName(s_SaveChain.base).GetFullName()));
+		}
+		else if (EmuConfig.IncrementalSavestates && !m_filename.IsEmpty())
+		{
+			// The states saved next only need what changes from here.
+			s_SaveChain.base = m_filename;
+			s_SaveChain.hash = HashMainMemory();
+			g_DirtyPages.Mark(DirtyPageTracker::Checkpoint_Savestate);
+		}
+
 		UI_EnableStateActions();
 		paused_core.AllowResume();
 	}
@@ -443,6 +672,7 @@ class SysExecEvent_ZipToDisk : public SysExecEvent
 protected:
 	ArchiveEntryList* m_src_list;
 	wxString m_filename;
+	u64 m_start_ticks;
 
 public:
 	wxString GetEventName() const { return L"VM_ZipToDisk"; }
@@ -451,16 +681,18 @@ public:
 
 	SysExecEvent_ZipToDisk* Clone() const { return new SysExecEvent_ZipToDisk(*this); }
 
-	SysExecEvent_ZipToDisk(ArchiveEntryList& srclist, const wxString& filename)
+	SysExecEvent_ZipToDisk(ArchiveEntryList& srclist, const wxString& filename, u64 start_ticks = GetCPUTicks())
 		: m_filename(filename)
 	{
 		m_src_list = &srclist;
+		m_start_ticks = start_ticks;
 	}
 
-	SysExecEvent_ZipToDisk(ArchiveEntryList* srclist, const wxString& filename)
+	SysExecEvent_ZipToDisk(ArchiveEntryList* srclist, const wxString& filename, u64 start_ticks = GetCPUTicks())
 		: m_filename(filename)
 	{
 		m_src_list = srclist;
+		m_start_ticks = start_ticks;
 	}
 
 	bool IsCriticalEvent() const { return true; }
@@ -474,10 +706,6 @@ protected:
 
 		wxString tempfile(m_filename + L".tmp");
 
-		wxFFileOutputStream* woot = new wxFFileOutputStream(tempfile);
-		if (!woot->IsOk())
-			throw Exception::CannotCreateStream(tempfile);
-
 		// Scheduler hint (yield) -- creating and saving the file is low priority compared to
 		// the emulator/vm thread.  Sleeping the executor thread briefly before doing file
 		// transactions should help reduce overhead. --air
@@ -485,32 +713,24 @@ protected:
 		pxYield(4);
 
 		// Write the version and screenshot:
-		std::unique_ptr<pxOutputStream> out(new pxOutputStream(tempfile, new wxZipOutputStream(woot)));
-		wxZipOutputStream* gzfp = (wxZipOutputStream*)out->GetWxStreamBase();
+		std::unique_ptr<ChunkedZipWriter> out(new ChunkedZipWriter(tempfile));
 
-		{
-			wxZipEntry* vent = new wxZipEntry(EntryFilename_StateVersion);
-			vent->SetMethod(wxZIP_METHOD_STORE);
-			gzfp->PutNextEntry(vent);
-			out->Write(g_SaveVersion);
-			gzfp->CloseEntry();
-		}
+		out->AddStored(EntryFilename_StateVersion, &g_SaveVersion, sizeof(g_SaveVersion));
 
 		std::unique_ptr<wxImage> m_screenshot;
 
 		if (m_screenshot)
 		{
-			wxZipEntry* vent = new wxZipEntry(EntryFilename_Screenshot);
-			vent->SetMethod(wxZIP_METHOD_STORE);
-			gzfp->PutNextEntry(vent);
-			m_screenshot->SaveFile(*gzfp, wxBITMAP_TYPE_JPEG);
-			gzfp->CloseEntry();
+			wxMemoryOutputStream jpeg;
+			m_screenshot->SaveFile(jpeg, wxBITMAP_TYPE_JPEG);
+			out->AddStored(EntryFilename_Screenshot, jpeg.GetOutputStreamBuffer()->GetBufferStart(), jpeg.GetSize());
 		}
 
 		(*new VmStateCompressThread())
 			.SetSource(elist.get())
-			.SetOutStream(out.get())
+			.SetWriter(out.get())
 			.SetFinishedPath(m_filename)
+			.SetStartTime(m_start_ticks)
 			.Start();
 
 		// No errors?  Release cleanup handlers:
@@ -552,72 +772,30 @@ protected:
 	{
 		ScopedLock lock(mtx_CompressToDisk);
 
-		// Ugh.  Exception handling made crappy because wxWidgets classes don't support scoped pointers yet.
-
-		std::unique_ptr<wxFFileInputStream> woot(new wxFFileInputStream(m_filename));
-		if (!woot->IsOk())
-			throw Exception::CannotCreateStream(m_filename).SetDiagMsg(L"Cannot open file for reading.");
-
-		std::unique_ptr<pxInputStream> reader(new pxInputStream(m_filename, new wxZipInputStream(woot.get())));
-		woot.release();
-
-		if (!reader->IsOk())
-		{
-			throw Exception::SaveStateLoadError(m_filename)
-				.SetDiagMsg(L"Savestate file is not a valid gzip archive.")
-				.SetUserMsg(_("This savestate cannot be loaded because it is not a valid gzip archive.  It may have been created by an older unsupported version of PCSX2, or it may be corrupted."));
-		}
+		const u64 start = GetCPUTicks();
 
-		wxZipInputStream* gzreader = (wxZipInputStream*)reader->GetWxStreamBase();
+		// Read and inflate the whole archive up front; the entries are unpacked in parallel.
+		ChunkedZipReader zip(m_filename);
 
 		// look for version and screenshot information in the zip stream:
 
-		bool foundVersion = false;
-		//bool foundScreenshot = false;
-		//bool foundEntry[ArraySize(SavestateEntries)] = false;
+		const ChunkedZipReader::Entry* foundVersion = zip.Find(EntryFilename_StateVersion);
+		const ChunkedZipReader::Entry* foundInternal = zip.Find(EntryFilename_InternalStructures);
+		const ChunkedZipReader::Entry* foundBase = zip.Find(EntryFilename_BaseState);
+		const ChunkedZipReader::Entry* foundEntry[ArraySize(SavestateEntries)];
 
-		std::unique_ptr<wxZipEntry> foundInternal;
-		std::unique_ptr<wxZipEntry> foundEntry[ArraySize(SavestateEntries)];
+		// No point in finding screenshots when loading states -- the screenshots are
+		// only useful for the UI savestate browser.
 
-		while (true)
+		for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
 		{
-			Threading::pxTestCancel();
-
-			std::unique_ptr<wxZipEntry> entry(gzreader->GetNextEntry());
-			if (!entry)
-				break;
-
-			if (entry->GetName().CmpNoCase(EntryFilename_StateVersion) == 0)
-			{
-				DevCon.WriteLn(Color_Green, L" ... found '%s'", EntryFilename_StateVersion);
-				foundVersion = true;
-				CheckVersion(*reader);
-				continue;
-			}
-
-			if (entry->GetName().CmpNoCase(EntryFilename_InternalStructures) == 0)
-			{
-				DevCon.WriteLn(Color_Green, L" ... found '%s'", EntryFilename_InternalStructures);
-				foundInternal = std::move(entry);
-				continue;
-			}
-
-			// No point in finding screenshots when loading states -- the screenshots are
-			// only useful for the UI savestate browser.
-			/*if (entry->GetName().CmpNoCase(EntryFilename_Screenshot) == 0)
-			{
-				foundScreenshot = true;
-			}*/
+			// Incremental states have the pages changed since their base instead.
+			const wxString name(foundBase && SavestateEntries[i]->GetIncrementalRegion() >= 0 ?
+				GetPagesFilename(*SavestateEntries[i]) : SavestateEntries[i]->GetFilename());
 
-			for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
-			{
-				if (entry->GetName().CmpNoCase(SavestateEntries[i]->GetFilename()) == 0)
-				{
-					DevCon.WriteLn(Color_Green, L" ... found '%s'", WX_STR(SavestateEntries[i]->GetFilename()));
-					foundEntry[i] = std::move(entry);
-					break;
-				}
-			}
+			foundEntry[i] = zip.Find(name);
+			if (foundEntry[i])
+				DevCon.WriteLn(Color_Green, L" ... found '%s'", WX_STR(name));
 		}
 
 		if (!foundVersion || !foundInternal)
@@ -647,6 +825,29 @@ protected:
 				.SetDiagMsg(L"Savestate cannot be loaded: some required components were not found or are incomplete.")
 				.SetUserMsg(_("This savestate cannot be loaded due to missing critical components.  See the log file for details."));
 
+		Threading::pxTestCancel();
+
+		zip.ExtractAll();
+
+		std::unique_ptr<ChunkedZipReader> base;
+		if (foundBase)
+		{
+			base = OpenIncrementalBase(m_filename, *foundBase);
+			for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
+			{
+				const int region = SavestateEntries[i]->GetIncrementalRegion();
+				if (region >= 0)
+					CheckPages(m_filename, *foundEntry[i], (DirtyPageTracker::RegionId)region);
+			}
+		}
+
+		const u64 unpacked = GetCPUTicks();
+
+		{
+			pxInputStream reader(m_filename, new wxMemoryInputStream(foundVersion->data.data(), foundVersion->data.size()));
+			CheckVersion(reader);
+		}
+
 		// We use direct Suspend/Resume control here, since it's desirable that emulation
 		// *ALWAYS* start execution after the new savestate is loaded.
 
@@ -662,19 +863,53 @@ protected:
 
 			Threading::pxTestCancel();
 
-			gzreader->OpenEntry(*foundEntry[i]);
-			SavestateEntries[i]->FreezeIn(*reader);
+			const int region = SavestateEntries[i]->GetIncrementalRegion();
+			const ChunkedZipReader::Entry* entry = foundEntry[i];
+			if (base && region >= 0)
+				entry = base->Find(SavestateEntries[i]->GetFilename());
+
+			pxInputStream reader(m_filename, new wxMemoryInputStream(entry->data.data(), entry->data.size()));
+			SavestateEntries[i]->FreezeIn(reader);
+
+			if (base && region >= 0)
+				LoadPages(*foundEntry[i], (DirtyPageTracker::RegionId)region);
 		}
 
 		// Load all the internal data
 
-		gzreader->OpenEntry(*foundInternal);
-
-		VmStateBuffer buffer(foundInternal->GetSize(), L"StateBuffer_UnzipFromDisk"); // start with an 8 meg buffer to avoid frequent reallocation.
-		reader->Read(buffer.GetPtr(), foundInternal->GetSize());
+		VmStateBuffer buffer(foundInternal->data.size(), L"StateBuffer_UnzipFromDisk");
+		memcpy(buffer.GetPtr(), foundInternal->data.data(), foundInternal->data.size());
 
 		memLoadingState(buffer).FreezeBios().FreezeInternals();
 		GetCoreThread().Resume(); // force resume regardless of emulation state earlier.
+
+		const u64 freq = GetTickFrequency();
+		Console.WriteLn("(UnzipFromDisk) Savestate loaded in %.0f ms (unpacked in %.0f ms)",
+			(GetCPUTicks() - start) * 1000.0 / freq, (unpacked - start) * 1000.0 / freq);
+	}
+};
+
+// --------------------------------------------------------------------------------------
+//  SysExecEvent_Rewind
+// --------------------------------------------------------------------------------------
+class SysExecEvent_Rewind : public SysExecEvent
+{
+public:
+	wxString GetEventName() const { return L"VM_Rewind"; }
+
+	virtual ~SysExecEvent_Rewind() = default;
+	SysExecEvent_Rewind* Clone() const { return new SysExecEvent_Rewind(*this); }
+
+protected:
+	void InvokeEvent()
+	{
+		GetCoreThread().Pause();
+		SysClearExecutionCache();
+
+		if (!g_RewindBuffer.Rewind())
+			OSDlog(Color_StrongGreen, true, "Nothing to rewind to.");
+
+		GetCoreThread().Resume();
 	}
 };
 
@@ -687,9 +922,10 @@ void StateCopy_SaveToFile(const wxString& file)
 	UI_DisableStateActions();
 
 	std::unique_ptr<ArchiveEntryList> ziplist(new ArchiveEntryList(new VmStateBuffer(L"Zippable Savestate")));
+	const u64 start = GetCPUTicks();
 
-	GetSysExecutorThread().PostEvent(new SysExecEvent_DownloadState(ziplist.get()));
-	GetSysExecutorThread().PostEvent(new SysExecEvent_ZipToDisk(ziplist.get(), file));
+	GetSysExecutorThread().PostEvent(new SysExecEvent_DownloadState(ziplist.get(), file));
+	GetSysExecutorThread().PostEvent(new SysExecEvent_ZipToDisk(ziplist.get(), file, start));
 
 	ziplist.release();
 }
@@ -700,6 +936,11 @@ void StateCopy_LoadFromFile(const wxString& file)
 	GetSysExecutorThread().PostEvent(new SysExecEvent_UnzipFromDisk(file));
 }
 
+void StateCopy_Rewind()
+{
+	GetSysExecutorThread().PostEvent(new SysExecEvent_Rewind());
+}
+
 // Saves recovery state info to the given saveslot, or saves the active emulation state
 // (if one exists) and no recovery data was found.  This is needed because when a recovery
 // state is made, the emulation state is usually reset so the only persisting state is
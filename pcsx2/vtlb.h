@@ -121,6 +121,9 @@ public:
 	virtual void Decommit();
 
 	bool IsCommitted() const;
+
+	// Host address of the reserve, fixed from Reserve on, before the memory is committed.
+	u8* GetPtr() { return m_reserve.GetPtr(); }
 };
 
 // --------------------------------------------------------------------------------------
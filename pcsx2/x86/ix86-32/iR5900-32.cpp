@@ -333,9 +333,14 @@ static DynGenFunc* ExitRecompiledCode	= NULL;
 static DynGenFunc* DispatchBlockDiscard = NULL;
 static DynGenFunc* DispatchPageReset    = NULL;
 
+void dynarecMemcheck();
+
 static void recEventTest()
 {
 	_cpuEventTest_Shared();
+
+	if (mmap_CheckWatchpoints())
+		dynarecMemcheck();
 }
 
 // The address for all cleared blocks.  It recompiles the current pc and then
@@ -1237,6 +1242,8 @@ void recMemcheck(u32 op, u32 bits, bool store)
 	{
 		if (checks[i].result == 0)
 			continue;
+		if (mmap_IsPageWatchpoint(checks[i].start, checks[i].end))
+			continue;
 		if ((checks[i].cond & MEMCHECK_WRITE) == 0 && store)
 			continue;
 		if ((checks[i].cond & MEMCHECK_READ) == 0 && !store)
@@ -65,7 +65,12 @@ struct nVifStruct {
 	RecompiledCodeReserve*	recReserve;
 	u8*						recWritePtr;		// current write pos into the reserve
 
-	HashBucket				vifBlocks;		// Vif Blocks
+	HashBucket				vifBlocks;		// Vif Blocks, front-end of the shared routine cache
+
+	// Statistics, reported on dVifReset in dev builds
+	u32						statLookups;	// dVifUnpack calls (dev builds only)
+	u32						statCompiled;	// routines compiled by this unit
+	u32						statShared;		// routines found in the shared cache
 
 	nVifStruct() = default;
 };
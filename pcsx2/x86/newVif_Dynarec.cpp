@@ -22,6 +22,51 @@
 #include "MTVU.h"
 #include "Utilities/Perf.h"
 
+#include <mutex>
+#include <unordered_map>
+
+// --------------------------------------------------------------------------------------
+//  Shared unpack routine cache
+// --------------------------------------------------------------------------------------
+// VIF0 and VIF1 mostly unpack the same shapes, so routines are compiled once in a reserve
+// shared by both units, and kept across dVifReset. The key is the full nVifBlock descriptor
+// plus the vifStruct the routine reads MaskRow/MaskCol from, if any (vif0, vif1 or the MTVU
+// copy of vif1). The per unit HashBuckets stay the lock-free front-end; the shared table
+// is only locked on their misses (VIF1 unpacks on the VU1 thread with MTVU).
+//
+// Shared code is only discarded when no unit can run it: on dVifReset, when the reserve
+// is nearly full. Until then, a unit that finds it full compiles into its own reserve.
+
+struct nVifRoutineKey {
+	u32  hash_key;
+	u32  key0;
+	u32  key1;
+	uptr owner;
+
+	bool operator==(const nVifRoutineKey& k) const {
+		return hash_key == k.hash_key && key0 == k.key0 && key1 == k.key1 && owner == k.owner;
+	}
+};
+
+struct nVifRoutineKeyHash {
+	size_t operator()(const nVifRoutineKey& k) const {
+		u64 h = ((u64)k.key0 << 32 | k.key1) * 0x9E3779B97F4A7C15ull;
+		return (size_t)(h ^ (h >> 29) ^ k.hash_key ^ k.owner);
+	}
+};
+
+struct nVifRoutine {
+	uptr startPtr;
+	u8   units;			// bit per nVif bucket holding the routine (reference count)
+};
+
+static struct {
+	std::mutex				lock;
+	RecompiledCodeReserve*	recReserve;
+	u8*						recWritePtr;
+	std::unordered_map<nVifRoutineKey, nVifRoutine, nVifRoutineKeyHash> routines;
+} nVifShared;
+
 static void recReset(int idx) {
 	nVif[idx].vifBlocks.reset();
 
@@ -30,18 +75,235 @@ static void recReset(int idx) {
 	nVif[idx].recWritePtr = nVif[idx].recReserve->GetPtr();
 }
 
+static void recResetShared() {
+	nVifShared.routines.clear();
+
+	nVifShared.recReserve->Reset();
+
+	nVifShared.recWritePtr = nVifShared.recReserve->GetPtr();
+}
+
+static void dVifPrintStats(int idx) {
+	const nVifStruct& v = nVif[idx];
+
+	if (!v.statCompiled && !v.statShared)
+		return;
+
+	u32 both = 0;
+	for (const auto& r : nVifShared.routines)
+		both += r.second.units == 3;
+
+	DevCon.WriteLn("nVif%d: %u lookups, %u compiled, %u from the shared cache (%.1f%% hits), longest bucket chain %u; %u shared routines, %u used by both units",
+		idx, v.statLookups, v.statCompiled, v.statShared,
+		v.statLookups ? 100.0 * (v.statLookups - v.statCompiled) / v.statLookups : 0.0,
+		v.vifBlocks.max_chain(), (u32)nVifShared.routines.size(), both);
+}
+
+#ifdef PCSX2_DEVBUILD
+// --------------------------------------------------------------------------------------
+//  Unpack self test (dev builds)
+// --------------------------------------------------------------------------------------
+// Runs V4 unpacks on VIF0 with the interpreter, the SSE routine and the AVX2 routine,
+// checks that they write the same VU0 memory, and times the two routines on full 256
+// vector unpacks. Only on request (--vifselftest), from the next dVifReset of VIF0: the
+// routines go to its reserve, which is reset afterwards. VIF0 state and VU0 memory are
+// restored.
+
+static bool dVifSelfTestPending = false;
+
+static u16 dVifComputeLength(uint cl, uint wl, u8 num, bool isFill);
+
+static uptr dVifTestCompile(nVifBlock& block, bool isFill, bool useAVX2) {
+	nVifStruct& v = nVif[0];
+
+	block.length = dVifComputeLength(block.cl, block.wl, block.num, isFill);
+
+	xSetPtr(v.recWritePtr);
+	uptr startPtr = (uptr)xGetAlignedCallTarget();
+
+	VifUnpackSSE_Dynarec rec(v, block);
+	rec.useAVX2 = useAVX2;
+	rec.CompileRoutine();
+
+	v.recWritePtr = xGetPtr();
+	return startPtr;
+}
+
+static void dVifSelfTest() {
+	static const struct { u8 cl, wl, num; } shapes[] = {
+		{ 4, 4, 1 }, { 4, 4, 2 }, { 4, 4, 7 }, { 4, 4, 0 },
+		{ 1, 1, 33 }, { 3, 3, 31 }, { 8, 8, 100 },
+		{ 4, 2, 40 }, { 6, 3, 25 },		// skipping
+		{ 2, 4, 30 }, { 3, 5, 41 },		// filling
+	};
+	static const u32 masks[] = { 0, 0xe4e4e4e4, 0x55aaff00, 0x1b6c39d2 };
+
+	nVifStruct& v = nVif[0];
+	u8* vuMem = vuRegs[0].Mem;
+
+	if (!v.recWritePtr || !vuMem || !nVifUpk[(12 * 4)])
+		return;
+
+	vifStruct    saveVif  = vif0;
+	VIFregisters saveRegs = vif0Regs;
+
+	std::unique_ptr<u8[]> saveMem(new u8[0x1000]);
+	memcpy(saveMem.get(), vuMem, 0x1000);
+
+	__aligned16 static u8 src[256 * 16];
+	__aligned16 static u8 expected[0x1000];
+
+	u32 seed = 0x12345678;
+	auto rnd = [&seed]() { seed = seed * 1103515245 + 12345; return seed ^ (seed >> 15); };
+
+	for (uint i = 0; i < sizeof(src) / 4; i++)
+		((u32*)src)[i] = rnd();
+
+	uint tests = 0, errors = 0;
+
+	for (int upkNum = 12; upkNum <= 14; upkNum++)
+	for (int usn = 0; usn < 2; usn++)
+	for (u32 mask : masks)
+	for (const auto& shape : shapes) {
+		const bool isFill = shape.cl < shape.wl;
+		const bool doMask = mask != 0;
+
+		nVifBlock block = {};
+		block.num     = shape.num;
+		block.upkType = upkNum | (doMask ? 0x10 : 0) | (usn << 5);
+		block.mask    = (doMask || isFill) ? mask : 0;
+		block.cl      = shape.cl;
+		block.wl      = shape.wl;
+
+		if (dVifComputeLength(shape.cl, shape.wl, shape.num, isFill) > 0x1000)
+			continue;
+		if (v.recWritePtr > (v.recReserve->GetPtrEnd() - _256kb))
+			break;
+
+		for (uint i = 0; i < 4; i++) {
+			vif0.MaskRow._u32[i] = rnd();
+			vif0.MaskCol._u32[i] = rnd();
+		}
+
+		const uptr routines[2] = {
+			dVifTestCompile(block, isFill, false),
+			x86caps.hasAVX2 ? dVifTestCompile(block, isFill, true) : 0,
+		};
+
+		// Interpreter reference
+		for (uint i = 0; i < 0x1000 / 4; i++)
+			((u32*)vuMem)[i] = 0xdead0000 | i;
+
+		vif0.cmd          = block.upkType & 0x1f;
+		vif0.usn          = usn;
+		vif0.cl           = 0;
+		vif0.tag.addr     = 0;
+		vif0Regs.cycle.cl = shape.cl;
+		vif0Regs.cycle.wl = shape.wl;
+		vif0Regs.mode     = 0;
+		vif0Regs.num      = shape.num ? shape.num : 256;
+		vif0Regs.mask     = mask;
+
+		_nVifUnpack(0, src, 0, isFill);
+		memcpy(expected, vuMem, 0x1000);
+
+		for (int r = 0; r < 2; r++) {
+			if (!routines[r])
+				continue;
+
+			for (uint i = 0; i < 0x1000 / 4; i++)
+				((u32*)vuMem)[i] = 0xdead0000 | i;
+
+			((nVifrecCall)routines[r])((uptr)vuMem, (uptr)src);
+
+			tests++;
+			if (memcmp(expected, vuMem, 0x1000)) {
+				errors++;
+				Console.Error("nVif self test: %s routine differs from the interpreter [upk=%d usn=%d mask=0x%08x cl=%d wl=%d num=%d]",
+					r ? "AVX2" : "SSE", upkNum, usn, mask, shape.cl, shape.wl, shape.num ? shape.num : 256);
+			}
+		}
+
+		// Benchmark on full blocks
+		if (shape.num == 0 && routines[1]) {
+			const int loops = 2000;
+			u64 ticks[2];
+
+			for (int r = 0; r < 2; r++) {
+				u64 start = GetCPUTicks();
+				for (int l = 0; l < loops; l++)
+					((nVifrecCall)routines[r])((uptr)vuMem, (uptr)src);
+				ticks[r] = GetCPUTicks() - start;
+			}
+
+			const double ns = 1e9 / GetTickFrequency() / (loops * 256);
+
+			DevCon.WriteLn("nVif: V4-%d usn=%d mask=0x%08x: SSE %.2f ns/vector, AVX2 %.2f ns/vector",
+				upkNum == 12 ? 32 : upkNum == 13 ? 16 : 8, usn, mask, ticks[0] * ns, ticks[1] * ns);
+		}
+	}
+
+	vif0     = saveVif;
+	vif0Regs = saveRegs;
+	memcpy(vuMem, saveMem.get(), 0x1000);
+
+	DevCon.WriteLn("nVif self test: %u routines checked against the interpreter, %u errors%s",
+		tests, errors, x86caps.hasAVX2 ? "" : " (no AVX2)");
+}
+#endif
+
+void dVifRequestSelfTest() {
+#ifdef PCSX2_DEVBUILD
+	dVifSelfTestPending = true;
+#endif
+}
+
 void dVifReserve(int idx) {
 	if(!nVif[idx].recReserve)
 		nVif[idx].recReserve = new RecompiledCodeReserve(pxsFmt(L"VIF%u Unpack Recompiler Cache", idx), _8mb);
 
 	auto offset = idx ? HostMemoryMap::VIF1recOffset : HostMemoryMap::VIF0recOffset;
 	nVif[idx].recReserve->Reserve(GetVmMemory().MainMemory(), offset, 8 * _1mb);
+
+	if(!nVifShared.recReserve) {
+		nVifShared.recReserve = new RecompiledCodeReserve(L"VIF Unpack Recompiler Cache (shared)", _8mb);
+		nVifShared.recReserve->Reserve(GetVmMemory().MainMemory(), HostMemoryMap::VIFrecSharedOffset, 8 * _1mb);
+		nVifShared.recWritePtr = nullptr;
+	}
 }
 
 void dVifReset(int idx) {
 	pxAssertDev(nVif[idx].recReserve, "Dynamic VIF recompiler reserve must be created prior to VIF use or reset!");
 
+	std::lock_guard<std::mutex> lock(nVifShared.lock);
+
+	if (IsDevBuild)
+		dVifPrintStats(idx);
+
 	recReset(idx);
+
+#ifdef PCSX2_DEVBUILD
+	if (idx == 0 && dVifSelfTestPending) {
+		dVifSelfTestPending = false;
+		dVifSelfTest();
+		recReset(idx);
+	}
+#endif
+
+	nVif[idx].statLookups  = 0;
+	nVif[idx].statCompiled = 0;
+	nVif[idx].statShared   = 0;
+
+	for (auto& r : nVifShared.routines)
+		r.second.units &= ~(1 << idx);
+
+	if (!nVifShared.recWritePtr || nVifShared.recWritePtr > (nVifShared.recReserve->GetPtrEnd() - _256kb)) {
+		// The other unit may still hold shared routines in its bucket
+		if (nVif[idx ^ 1].recReserve && nVifShared.recWritePtr)
+			recReset(idx ^ 1);
+
+		recResetShared();
+	}
 }
 
 void dVifClose(int idx) {
@@ -52,6 +314,12 @@ void dVifClose(int idx) {
 void dVifRelease(int idx) {
 	dVifClose(idx);
 	safe_delete(nVif[idx].recReserve);
+
+	if (!nVif[0].recReserve && !nVif[1].recReserve) {
+		nVifShared.routines.clear();
+		nVifShared.recWritePtr = nullptr;
+		safe_delete(nVifShared.recReserve);
+	}
 }
 
 VifUnpackSSE_Dynarec::VifUnpackSSE_Dynarec(const nVifStruct& vif_, const nVifBlock& vifBlock_)
@@ -64,6 +332,7 @@ VifUnpackSSE_Dynarec::VifUnpackSSE_Dynarec(const nVifStruct& vif_, const nVifBlo
 	doMask		= (vB.upkType>>4) & 1;
 	doMode		= vB.mode & 3;
 	IsAligned   = vB.aligned;
+	useAVX2		= x86caps.hasAVX2;
 	vCL			= 0;
 }
 
@@ -93,6 +362,17 @@ __fi void VifUnpackSSE_Dynarec::SetMasks(int cS) const {
 	//if (doMask||doMode) loadRowCol((nVifStruct&)v);
 }
 
+// SetMasks and writeBackRow are the only parts of a routine reading the vifStruct of the unit
+bool VifUnpackSSE_Dynarec::UsesVifRegs() const {
+	const int upkNum = vB.upkType & 0xf;
+
+	u32 m0 = vB.mask;
+	u32 m3 = ((m0 & 0xaaaaaaaa)>>1) & ~m0;
+	u32 m2 = (m0 & 0x55555555) & (~m0>>1);
+
+	return (doMask && (m2 || m3)) || (doMode && upkNum != 0xf);
+}
+
 void VifUnpackSSE_Dynarec::doMaskWrite(const xRegisterSSE& regX) const {
 	pxAssertDev(regX.Id <= 1, "Reg Overflow! XMM2 thru XMM6 are reserved for masking.");
 
@@ -146,6 +426,55 @@ void VifUnpackSSE_Dynarec::doMaskWrite(const xRegisterSSE& regX) const {
 	xMOVAPS(ptr32[dstIndirect], regX);
 }
 
+// 4 bit dword select of vpblendd from the 0x55 bits of a mask byte (x is bit 0)
+static __fi u32 makeBlendMask(u32 x)
+{
+	return (x & 1) | ((x >> 1) & 2) | ((x >> 2) & 4) | ((x >> 3) & 8);
+}
+
+// Same merges as doMaskWrite for vCL and vCL+1 at once, each cycle in its 128 bit lane.
+// There is no mode, so it's only row/col/protect: dword blends with row, col or dest.
+void VifUnpackSSE_Dynarec::xMovDestPair() const {
+	const xRegisterYMM regY(destReg.Id);
+	const xRegisterYMM tempY(xmmTemp.Id);
+
+	pxAssume(!doMode);
+
+	if (IsUnmaskedOp()) {
+		xVMOVDQU(ptr[dstIndirect], regY);
+		return;
+	}
+
+	const int cc0 = std::min(vCL, 3);
+	const int cc1 = std::min(vCL + 1, 3);
+
+	u32 row = 0, col = 0, protect = 0;
+
+	for (int i = 0; i < 2; i++) {
+		u32 m0 = (vB.mask >> ((i ? cc1 : cc0) * 8)) & 0xff;
+		u32 m3 = ((m0 & 0xaa)>>1) & ~m0;
+		u32 m2 = (m0 & 0x55) & (~m0>>1);
+		u32 m4 = (m0 & ~((m3<<1) | m2)) & 0x55;
+
+		row     |= makeBlendMask(m2) << (i * 4);
+		col     |= makeBlendMask(m3) << (i * 4);
+		protect |= makeBlendMask(m4) << (i * 4);
+	}
+
+	if (row) {
+		xVINSERTI128(tempY, xRegisterYMM(xmmRow.Id), xmmRow, 1);
+		xVPBLENDD(regY, regY, tempY, row);
+	}
+	if (col) {
+		xVINSERTI128(tempY, xRegisterYMM(xmmCol0.Id + cc0), xRegisterSSE(xmmCol0.Id + cc1), 1);
+		xVPBLENDD(regY, regY, tempY, col);
+	}
+	if (protect) {
+		xVPBLENDD(regY, regY, ptr[dstIndirect], protect);
+	}
+	xVMOVDQU(ptr[dstIndirect], regY);
+}
+
 void VifUnpackSSE_Dynarec::writeBackRow() const {
 	const int idx = v.idx;
 	xMOVAPS(ptr128[&(MTVU_VifX.MaskRow)], xmmRow);
@@ -218,6 +547,11 @@ void VifUnpackSSE_Dynarec::CompileRoutine() {
 	// Value passed determines # of col regs we need to load
 	SetMasks(isFill ? blockSize : cycleSize);
 
+	// Pairs of writes in the same cycle block are done with AVX2. vzeroupper is needed
+	// before any SSE op once the upper halves are used.
+	const bool doPairs = useAVX2 && !doMode && CanUnpackPair(upkNum);
+	bool upperDirty = false;
+
 	while (vNum) {
 
 
@@ -227,6 +561,25 @@ void VifUnpackSSE_Dynarec::CompileRoutine() {
 			ShiftDisplacementWindow( srcIndirect, arg2reg ); //Don't need to do this otherwise as we arent reading the source.
 
 
+		if (doPairs && vNum >= 2 && (vCL + 1) < cycleSize) {
+			xUnpackPair(upkNum);
+			xMovDestPair();
+
+			dstIndirect += 32;
+			srcIndirect += vift * 2;
+
+			vNum -= 2;
+			vCL  += 2;
+			if (vCL == blockSize) vCL = 0;
+			upperDirty = true;
+			continue;
+		}
+
+		if (upperDirty) {
+			xVZEROUPPER();
+			upperDirty = false;
+		}
+
 		if (vCL < cycleSize) {
 			ModUnpack(upkNum, false);
 			xUnpack(upkNum);
@@ -257,6 +610,7 @@ void VifUnpackSSE_Dynarec::CompileRoutine() {
 		}
 	}
 
+	if (upperDirty) xVZEROUPPER();
 	if (doMode>=2) writeBackRow();
 	xRET();
 }
@@ -276,25 +630,69 @@ static u16 dVifComputeLength(uint cl, uint wl, u8 num, bool isFill) {
 _vifT __fi nVifBlock* dVifCompile(nVifBlock& block, bool isFill) {
 	nVifStruct& v = nVif[idx];
 
+	block.length = dVifComputeLength(block.cl, block.wl, block.num, isFill);
+
+	{
+		VifUnpackSSE_Dynarec rec(v, block);
+
+		nVifRoutineKey key = { block.hash_key, block.key0, block.key1, rec.UsesVifRegs() ? (uptr)&MTVU_VifX : 0 };
+
+		std::lock_guard<std::mutex> lock(nVifShared.lock);
+
+		auto it = nVifShared.routines.find(key);
+
+		if (it != nVifShared.routines.end()) {
+			it->second.units |= 1 << idx;
+
+			block.startPtr = it->second.startPtr;
+			v.vifBlocks.add(block);
+			v.statShared++;
+
+			return &block;
+		}
+
+		if (nVifShared.recWritePtr <= (nVifShared.recReserve->GetPtrEnd() - _256kb)) {
+			xSetPtr(nVifShared.recWritePtr);
+
+			block.startPtr = (uptr)xGetAlignedCallTarget();
+			v.vifBlocks.add(block);
+
+			rec.CompileRoutine();
+
+			Perf::vif.map((uptr)nVifShared.recWritePtr, xGetPtr() - nVifShared.recWritePtr, block.upkType /* FIXME ideally a key*/);
+			nVifShared.recWritePtr = xGetPtr();
+
+			nVifShared.routines[key] = { block.startPtr, (u8)(1 << idx) };
+			v.statCompiled++;
+
+			return &block;
+		}
+	}
+
+	// The shared cache is full until the next reset, compile in the unit reserve.
 	// Check size before the compilation
 	if (v.recWritePtr > (v.recReserve->GetPtrEnd() - _256kb)) {
 		DevCon.WriteLn(L"nVif Recompiler Cache Reset! [%ls > %ls]",
 			pxsPtr(v.recWritePtr), pxsPtr(v.recReserve->GetPtrEnd())
 		);
 		recReset(idx);
+
+		std::lock_guard<std::mutex> lock(nVifShared.lock);
+		for (auto& r : nVifShared.routines)
+			r.second.units &= ~(1 << idx);
 	}
 
 	// Compile the block now
 	xSetPtr(v.recWritePtr);
 
 	block.startPtr = (uptr)xGetAlignedCallTarget();
-	block.length = dVifComputeLength(block.cl, block.wl, block.num, isFill);
 	v.vifBlocks.add(block);
 
 	VifUnpackSSE_Dynarec(v, block).CompileRoutine();
 
 	Perf::vif.map((uptr)v.recWritePtr, xGetPtr() - v.recWritePtr, block.upkType /* FIXME ideally a key*/);
 	v.recWritePtr = xGetPtr();
+	v.statCompiled++;
 
 	return &block;
 }
@@ -336,6 +734,10 @@ _vifT __fi void dVifUnpack(const u8* data, bool isFill) {
 	//	doMask >> 4, doMask ? wxsFormat( L"0x%08x", block.mask ).c_str() : L"ignored"
 	//);
 
+#ifdef PCSX2_DEVBUILD
+	v.statLookups++;
+#endif
+
 	// Seach in cache before trying to compile the block
 	nVifBlock*  b = v.vifBlocks.find(block);
 	if (unlikely(b == nullptr)) {
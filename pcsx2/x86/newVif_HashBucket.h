@@ -57,10 +57,12 @@ union nVifBlock {
 class HashBucket {
 protected:
 	std::array<nVifBlock*, hSize> m_bucket;
+	u32 m_max_chain;
 
 public:
 	HashBucket() {
 		m_bucket.fill(nullptr);
+		m_max_chain = 0;
 	}
 
 	~HashBucket() { clear(); }
@@ -97,8 +99,12 @@ public:
 		memset(&m_bucket[b][size], 0, sizeof(nVifBlock));
 
 		if( size > 3 ) DevCon.Warning( "recVifUnpk: Bucket 0x%04x has %d micro-programs", b, size );
+
+		m_max_chain = std::max(m_max_chain, size);
 	}
 
+	u32 max_chain() const { return m_max_chain; }
+
 	u32 bucket_size(const nVifBlock& dataPtr) {
 		nVifBlock* chainpos = m_bucket[dataPtr.hash_key];
 
@@ -120,6 +126,8 @@ public:
 	void reset() {
 		clear();
 
+		m_max_chain = 0;
+
 		// Allocate an empty cell for all buckets
 		for (auto& bucket : m_bucket) {
 			if( (bucket = (nVifBlock*)_aligned_malloc( sizeof(nVifBlock), 64 )) == nullptr ) {
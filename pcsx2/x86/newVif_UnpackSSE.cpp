@@ -375,6 +375,36 @@ void VifUnpackSSE_Base::xUnpack( int upknum ) const
 	}
 }
 
+bool VifUnpackSSE_Base::CanUnpackPair( int upknum )
+{
+	// Two V4 vectors are contiguous in the source, so one 256 bit load or extend does both
+	return x86caps.hasAVX2 && upknum >= 12 && upknum <= 14;
+}
+
+void VifUnpackSSE_Base::xUnpackPair( int upknum ) const
+{
+	const xRegisterYMM destYMM(destReg.Id);
+
+	switch( upknum )
+	{
+		case 12: xVMOVDQU(destYMM, ptr[srcIndirect]); break;
+
+		case 13:
+			if (usn)	xVPMOVZXWD(destYMM, ptr[srcIndirect]);
+			else		xVPMOVSXWD(destYMM, ptr[srcIndirect]);
+			break;
+
+		case 14:
+			if (usn)	xVPMOVZXBD(destYMM, ptr[srcIndirect]);
+			else		xVPMOVSXBD(destYMM, ptr[srcIndirect]);
+			break;
+
+		default:
+			pxFailRel( wxsFormat( L"Vpu/Vif - Invalid pair Unpack! [%d]", upknum ) );
+		break;
+	}
+}
+
 // =====================================================================================================
 //  VifUnpackSSE_Simple
 // =====================================================================================================
@@ -52,6 +52,10 @@ public:
 	virtual bool IsUnmaskedOp() const=0;
 	virtual void xMovDest() const;
 
+	// AVX2: unpacks two consecutive vectors into the ymm of destReg (V4-32/16/8 only)
+	static bool CanUnpackPair( int upktype );
+	void xUnpackPair( int upktype ) const;
+
 protected:
 	virtual void doMaskWrite(const xRegisterSSE& regX ) const=0;
 
@@ -108,6 +112,7 @@ class VifUnpackSSE_Dynarec : public VifUnpackSSE_Base
 public:
 	bool			isFill;
 	int				doMode;			// two bit value representing... something!
+	bool			useAVX2;		// write pairs of vectors with 256 bit ops when possible
 	
 protected:
 	const nVifStruct&	v;			// vif0 or vif1
@@ -122,6 +127,7 @@ public:
 		, vB(src.vB)
 	{
 		isFill	= src.isFill;
+		useAVX2	= src.useAVX2;
 		vCL		= src.vCL;
 	}
 
@@ -131,10 +137,12 @@ public:
 
 	void ModUnpack( int upknum, bool PostOp );
 	void CompileRoutine();
+	bool UsesVifRegs() const;
 	
 
 protected:
 	virtual void doMaskWrite(const xRegisterSSE& regX) const;
+	void xMovDestPair() const;
 	void SetMasks(int cS) const;
 	void writeBackRow() const;
 
@@ -28,6 +28,7 @@
 #include "Renderers/OpenGL/GSDeviceOGL.h"
 #include "Renderers/OpenGL/GSRendererOGL.h"
 #include "GSLzma.h"
+#include "GSDumpStream.h"
 
 #ifdef _WIN32
 
@@ -42,6 +43,8 @@ static HRESULT s_hr = E_FAIL;
 #else
 
 #include "Window/GSWndEGL.h"
+#include <dirent.h>
+#include <chrono>
 
 extern bool RunLinuxDialog();
 
@@ -69,6 +72,7 @@ static uint8* s_basemem = NULL;
 static int s_vsync = 0;
 static bool s_exclusive = true;
 static std::string s_renderer_name;
+static bool s_headless = false; // replay benchmark: no window, null device
 bool gsopen_done = false; // crash guard for GSgetTitleInfo2 and GSKeyEvent (replace with lock?)
 
 EXPORT_C_(uint32) PS2EgetLibType()
@@ -252,38 +256,45 @@ static int _GSopen(void** dsp, const char* title, GSRendererType renderer, int t
 					break;
 			}
 #else
-			switch (renderer)
+			if (s_headless)
 			{
-				case GSRendererType::OGL_HW:
-				case GSRendererType::OGL_SW:
+				wnds.push_back(std::make_shared<GSWndNull>());
+			}
+			else
+			{
+				switch (renderer)
+				{
+					case GSRendererType::OGL_HW:
+					case GSRendererType::OGL_SW:
 #if defined(__unix__)
-					// Note: EGL code use GLX otherwise maybe it could be also compatible with Windows
-					// Yes OpenGL code isn't complicated enough !
-					switch (GSWndEGL::SelectPlatform()) {
+						// Note: EGL code use GLX otherwise maybe it could be also compatible with Windows
+						// Yes OpenGL code isn't complicated enough !
+						switch (GSWndEGL::SelectPlatform()) {
 #if GS_EGL_X11
-						case EGL_PLATFORM_X11_KHR:
-							wnds.push_back(std::make_shared<GSWndEGL_X11>());
-							break;
+							case EGL_PLATFORM_X11_KHR:
+								wnds.push_back(std::make_shared<GSWndEGL_X11>());
+								break;
 #endif
 #if GS_EGL_WL
-						case EGL_PLATFORM_WAYLAND_KHR:
-							wnds.push_back(std::make_shared<GSWndEGL_WL>());
-							break;
+							case EGL_PLATFORM_WAYLAND_KHR:
+								wnds.push_back(std::make_shared<GSWndEGL_WL>());
+								break;
 #endif
-						default:
-							break;
-					}
+							default:
+								break;
+						}
 #else
-					wnds.push_back(std::make_shared<GSWndWGL>());
+						wnds.push_back(std::make_shared<GSWndWGL>());
 #endif
-					break;
-				default:
+						break;
+					default:
 #ifdef _WIN32
-					wnds.push_back(std::make_shared<GSWndDX>());
+						wnds.push_back(std::make_shared<GSWndDX>());
 #else
-					wnds.push_back(std::make_shared<GSWndEGL_X11>());
+						wnds.push_back(std::make_shared<GSWndEGL_X11>());
 #endif
-					break;
+						break;
+				}
 			}
 #endif
 			int w = theApp.GetConfigI("ModeWidth");
@@ -348,7 +359,10 @@ static int _GSopen(void** dsp, const char* title, GSRendererType renderer, int t
 			renderer_name = "OpenGL";
 			break;
 		case GSRendererType::OGL_SW:
-			dev = new GSDeviceOGL();
+			if (s_headless)
+				dev = new GSDeviceNull();
+			else
+				dev = new GSDeviceOGL();
 			s_renderer_name = "SW";
 			renderer_name = "Software";
 			break;
@@ -1115,6 +1129,11 @@ EXPORT_C GSReplay(HWND hwnd, HINSTANCE hinst, LPSTR lpszCmdLine, int nCmdShow)
 			p.buff.resize(0x2000);
 			file->Read(p.buff.data(), 0x2000);
 			break;
+		case 5:
+			// keyframe, only used to seek
+			file->Read(&p.size, 4);
+			file->Skip(p.size);
+			break;
 		}
 
 		return p;
@@ -1122,7 +1141,7 @@ EXPORT_C GSReplay(HWND hwnd, HINSTANCE hinst, LPSTR lpszCmdLine, int nCmdShow)
 
 	std::list<Packet> packets;
 	uint8 type;
-	while(file->Read(&type, 1))
+	while(file->Read(&type, 1) && type != 4) // frame index ends the dump
 		packets.push_back(read_packet(type));
 
 	Sleep(100);
@@ -1377,6 +1396,86 @@ inline unsigned long timeGetTime()
 	return (unsigned long)(t.tv_sec*1000 + t.tv_nsec/1000000);
 }
 
+// Streaming replay, plays 'finished' loops like the in-memory replay does. The frames
+// before start_frame are played to rebuild the GS memory but not presented.
+static void GSReplayStream(GSDumpStream* stream, uint8* regs, int& finished, int start_frame)
+{
+	std::vector<uint8> buff;
+	bool first = true;
+
+	if (start_frame > 0)
+		stream->Seek(start_frame);
+
+	while (finished > 0)
+	{
+		const GSDumpStream::Packet* p = stream->Next();
+
+		if (p == NULL)
+			break;
+
+		switch (p->type)
+		{
+			case 0:
+
+				switch (p->param)
+				{
+					case 0: GSgifTransfer1(p->data - p->addr, p->addr); break;
+					case 1: GSgifTransfer2(p->data, p->size / 16); break;
+					case 2: GSgifTransfer3(p->data, p->size / 16); break;
+					case 3: GSgifTransfer(p->data, p->size / 16); break;
+				}
+
+				break;
+
+			case 1:
+
+				if (p->frame >= start_frame)
+					GSvsync(p->param);
+
+				break;
+
+			case 2:
+
+				if (buff.size() < p->size) buff.resize(p->size);
+
+				GSreadFIFO2(&buff[0], p->size / 16);
+
+				break;
+
+			case 3:
+
+				memcpy(regs, p->data, 0x2000);
+
+				break;
+
+			case 5:
+			{
+				// Start of a loop
+				if (!first) {
+					if (finished >= 200) {
+						; // Nop for Nvidia Profiler
+					} else if (finished > 90) {
+						sleep(1);
+					} else if (--finished == 0) {
+						break;
+					}
+				}
+
+				first = false;
+
+				GSFreezeData fd;
+				fd.size = p->size;
+				fd.data = p->data;
+				GSfreeze(FREEZE_LOAD, &fd);
+
+				break;
+			}
+		}
+	}
+
+	finished = 0;
+}
+
 // Note
 EXPORT_C GSReplay(char* lpszCmdLine, int renderer)
 {
@@ -1423,6 +1522,23 @@ EXPORT_C GSReplay(char* lpszCmdLine, int renderer)
 	}
 	if (s_gs->m_wnd == NULL) return;
 
+	std::unique_ptr<GSDumpStream> stream;
+	int stream_mb = theApp.GetConfigI("linux_replay_stream");
+
+	if (stream_mb > 0 && !repack_dump)
+	{
+		try {
+			stream = std::unique_ptr<GSDumpStream>(new GSDumpStream(lpszCmdLine, (size_t)stream_mb << 20));
+		} catch (...) {
+			fprintf(stderr, "Error failed to open %s\n", lpszCmdLine);
+			return;
+		}
+
+		// The GS state is restored by the first packet of the stream
+		GSsetGameCRC(stream->GetCRC(), 0);
+		memcpy(regs, stream->GetRegs(), 0x2000);
+	}
+	else
 	{ // Read .gs content
 		std::string f(lpszCmdLine);
 		bool is_xz = (f.size() >= 4) && (f.compare(f.size()-3, 3, ".xz") == 0);
@@ -1450,7 +1566,7 @@ EXPORT_C GSReplay(char* lpszCmdLine, int renderer)
 		file->Read(regs, 0x2000);
 
 		uint8 type;
-		while(file->Read(&type, 1))
+		while(file->Read(&type, 1) && type != 4) // frame index ends the dump
 		{
 			Packet* p = new Packet();
 
@@ -1495,6 +1611,14 @@ EXPORT_C GSReplay(char* lpszCmdLine, int renderer)
 
 				file->Read(&p->buff[0], 0x2000);
 
+				break;
+
+			case 5:
+				// keyframe, only used to seek (read to keep repacked dumps valid)
+				file->Read(&p->size, 4);
+				p->buff.resize(p->size);
+				file->Read(p->buff.data(), p->size);
+
 				break;
 			}
 
@@ -1515,6 +1639,9 @@ EXPORT_C GSReplay(char* lpszCmdLine, int renderer)
 	// Init vsync stuff
 	GSvsync(1);
 
+	if (stream)
+		GSReplayStream(stream.get(), regs, finished, theApp.GetConfigI("linux_replay_start_frame"));
+
 	while(finished > 0)
 	{
 		for(auto i = packets.begin(); i != packets.end(); i++)
@@ -1590,4 +1717,438 @@ EXPORT_C GSReplay(char* lpszCmdLine, int renderer)
 	GSclose();
 	GSshutdown();
 }
+
+// Headless replay benchmark
+//
+// Plays a dump (or every .gs/.gs.xz dump of a directory) without any window, with either the
+// Null renderer or the SW renderer drawing into a null device. The first 'warmup' frames are
+// not measured, then the dump is played 'loops' times. Results go to 'output' (CSV when the
+// name ends with .csv, JSON otherwise) or to stdout. Returns the number of dumps that failed.
+
+struct GSReplayBenchmarkResult
+{
+	std::string name;
+	std::vector<double> frames; // ms
+	double transfer; // ms spent in the GIF transfers (parsing and vertex kicks, -r null isolates them)
+	double counters[GSPerfMon::CounterLast];
+};
+
+static const char* s_perfmon_counter_name[GSPerfMon::CounterLast] =
+{
+	"frame_cpu_ms", "prim", "draw", "swizzle", "unswizzle", "fillrate", "quad", "syncpoint",
+	"unswizzle_skip",
+};
+
+static bool GSReplayBenchmarkDump(const std::string& fn, GSRendererType renderer, int loops, int warmup, GSReplayBenchmarkResult& res)
+{
+	struct Packet {uint8 type, param; uint32 size, addr; std::vector<uint8> buff;};
+
+	std::array<uint8, 0x2000> regs;
+	std::list<Packet> packets;
+	int frames_per_loop = 0;
+
+	res.name = fn.substr(fn.find_last_of('/') + 1);
+
+	const bool is_xz = fn.size() >= 4 && fn.compare(fn.size() - 3, 3, ".xz") == 0;
+
+	std::unique_ptr<GSDumpFile> file;
+
+	try
+	{
+		if(is_xz)
+			file = std::unique_ptr<GSDumpFile>{new GSDumpLzma(const_cast<char*>(fn.c_str()), nullptr)};
+		else
+			file = std::unique_ptr<GSDumpFile>{new GSDumpRaw(const_cast<char*>(fn.c_str()), nullptr)};
+	}
+	catch(...)
+	{
+		return false;
+	}
+
+	GSinit();
+
+	GSsetBaseMem(regs.data());
+
+	s_vsync = 0;
+	s_headless = true;
+
+	void* hWnd = NULL;
+
+	if(_GSopen(&hWnd, "", renderer, -1) != 0)
+	{
+		fprintf(stderr, "%s: failed to open the renderer\n", res.name.c_str());
+
+		s_headless = false;
+		GSshutdown();
+
+		return false;
+	}
+
+	try
+	{
+		uint32 crc;
+		file->Read(&crc, 4);
+		GSsetGameCRC(crc, 0);
+
+		GSFreezeData fd;
+		file->Read(&fd.size, 4);
+		std::vector<uint8> freeze_data(fd.size);
+		fd.data = freeze_data.data();
+		file->Read(fd.data, fd.size);
+		GSfreeze(FREEZE_LOAD, &fd);
+
+		file->Read(regs.data(), 0x2000);
+
+		uint8 type;
+
+		while(file->Read(&type, 1) && type != 4) // frame index ends the dump
+		{
+			packets.emplace_back();
+
+			Packet& p = packets.back();
+
+			p.type = type;
+
+			switch(p.type)
+			{
+			case 0:
+				file->Read(&p.param, 1);
+				file->Read(&p.size, 4);
+				switch(p.param)
+				{
+				case 0:
+					p.buff.resize(0x4000);
+					p.addr = 0x4000 - p.size;
+					file->Read(&p.buff[p.addr], p.size);
+					break;
+				case 1:
+				case 2:
+				case 3:
+					p.buff.resize(p.size);
+					file->Read(p.buff.data(), p.size);
+					break;
+				}
+				break;
+			case 1:
+				file->Read(&p.param, 1);
+				frames_per_loop++;
+				break;
+			case 2:
+				file->Read(&p.size, 4);
+				break;
+			case 3:
+				p.buff.resize(0x2000);
+				file->Read(p.buff.data(), 0x2000);
+				break;
+			case 5:
+				file->Read(&p.size, 4);
+				file->Skip(p.size);
+				break;
+			}
+		}
+	}
+	catch(...)
+	{
+		frames_per_loop = 0;
+	}
+
+	file.reset();
+
+	if(frames_per_loop == 0)
+	{
+		fprintf(stderr, "%s: no frame to replay\n", res.name.c_str());
+
+		GSclose();
+		GSshutdown();
+		s_headless = false;
+
+		return false;
+	}
+
+	GSPerfMon& perfmon = s_gs->m_perfmon;
+
+	perfmon.EnableCounters(); // release builds on linux don't count otherwise
+
+	double base[GSPerfMon::CounterLast];
+
+	const size_t measured = (size_t)frames_per_loop * loops;
+
+	res.frames.reserve(measured);
+
+	GSvsync(1);
+
+	for(int i = 0; i < GSPerfMon::CounterLast; i++)
+	{
+		base[i] = perfmon.GetTotal((GSPerfMon::counter_t)i);
+	}
+
+	std::vector<uint8> buff;
+
+	int vsyncs = 0;
+
+	res.transfer = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	while(res.frames.size() < measured)
+	{
+		for(auto i = packets.begin(); i != packets.end() && res.frames.size() < measured; ++i)
+		{
+			Packet& p = *i;
+
+			switch(p.type)
+			{
+			case 0:
+			{
+				auto t = std::chrono::steady_clock::now();
+
+				switch(p.param)
+				{
+				case 0: GSgifTransfer1(p.buff.data(), p.addr); break;
+				case 1: GSgifTransfer2(p.buff.data(), p.size / 16); break;
+				case 2: GSgifTransfer3(p.buff.data(), p.size / 16); break;
+				case 3: GSgifTransfer(p.buff.data(), p.size / 16); break;
+				}
+
+				if(vsyncs >= warmup)
+				{
+					res.transfer += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count();
+				}
+
+				break;
+			}
+			case 1:
+			{
+				GSvsync(p.param);
+
+				auto now = std::chrono::steady_clock::now();
+
+				if(vsyncs >= warmup)
+				{
+					res.frames.push_back(std::chrono::duration<double, std::milli>(now - start).count());
+				}
+
+				start = now;
+
+				if(++vsyncs == warmup)
+				{
+					for(int c = 0; c < GSPerfMon::CounterLast; c++)
+					{
+						base[c] = perfmon.GetTotal((GSPerfMon::counter_t)c);
+					}
+				}
+
+				break;
+			}
+			case 2:
+				if(buff.size() < p.size) buff.resize(p.size);
+				GSreadFIFO2(buff.data(), p.size / 16);
+				break;
+			case 3:
+				memcpy(regs.data(), p.buff.data(), 0x2000);
+				break;
+			}
+		}
+	}
+
+	for(int i = 0; i < GSPerfMon::CounterLast; i++)
+	{
+		res.counters[i] = perfmon.GetTotal((GSPerfMon::counter_t)i) - base[i];
+	}
+
+	GSclose();
+	GSshutdown();
+
+	s_headless = false;
+
+	return true;
+}
+
+static double GSReplayBenchmarkPercentile(const std::vector<double>& sorted, double p)
+{
+	size_t rank = (size_t)std::ceil(p / 100 * sorted.size());
+
+	return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+static void GSReplayBenchmarkWrite(FILE* fp, bool csv, const char* renderer, int loops, int warmup, const std::vector<GSReplayBenchmarkResult>& results)
+{
+	if(csv)
+	{
+		fprintf(fp, "name,frames,total_ms,mean_ms,min_ms,p50_ms,p90_ms,p95_ms,p99_ms,max_ms,fps,transfer_ms");
+
+		for(int i = 0; i < GSPerfMon::CounterLast; i++)
+		{
+			fprintf(fp, ",%s", s_perfmon_counter_name[i]);
+		}
+
+		fprintf(fp, "\n");
+	}
+	else
+	{
+		fprintf(fp, "{\n\t\"renderer\": \"%s\",\n\t\"loops\": %d,\n\t\"warmup\": %d,\n\t\"dumps\": [", renderer, loops, warmup);
+	}
+
+	for(size_t n = 0; n < results.size(); n++)
+	{
+		const GSReplayBenchmarkResult& res = results[n];
+
+		std::vector<double> sorted = res.frames;
+
+		std::sort(sorted.begin(), sorted.end());
+
+		double total = 0;
+
+		for(double f : sorted) total += f;
+
+		double mean = total / sorted.size();
+
+		double stats[] =
+		{
+			total, mean, sorted.front(),
+			GSReplayBenchmarkPercentile(sorted, 50), GSReplayBenchmarkPercentile(sorted, 90),
+			GSReplayBenchmarkPercentile(sorted, 95), GSReplayBenchmarkPercentile(sorted, 99),
+			sorted.back(), 1000 / mean,
+		};
+
+		if(csv)
+		{
+			std::string name = res.name;
+
+			std::replace(name.begin(), name.end(), ',', '_');
+
+			fprintf(fp, "%s,%zu", name.c_str(), sorted.size());
+
+			for(double v : stats) fprintf(fp, ",%.4f", v);
+
+			fprintf(fp, ",%.4f", res.transfer);
+
+			for(int i = 0; i < GSPerfMon::CounterLast; i++) fprintf(fp, ",%.0f", res.counters[i]);
+
+			fprintf(fp, "\n");
+
+			continue;
+		}
+
+		std::string name;
+
+		for(char c : res.name)
+		{
+			if(c == '"' || c == '\\') name += '\\';
+
+			name += c;
+		}
+
+		fprintf(fp, "%s\n\t\t{\n\t\t\t\"name\": \"%s\",\n\t\t\t\"frames\": %zu,\n", n > 0 ? "," : "", name.c_str(), sorted.size());
+		fprintf(fp, "\t\t\t\"total_ms\": %.4f,\n\t\t\t\"mean_ms\": %.4f,\n\t\t\t\"min_ms\": %.4f,\n", stats[0], stats[1], stats[2]);
+		fprintf(fp, "\t\t\t\"p50_ms\": %.4f,\n\t\t\t\"p90_ms\": %.4f,\n\t\t\t\"p95_ms\": %.4f,\n\t\t\t\"p99_ms\": %.4f,\n", stats[3], stats[4], stats[5], stats[6]);
+		fprintf(fp, "\t\t\t\"max_ms\": %.4f,\n\t\t\t\"fps\": %.4f,\n\t\t\t\"transfer_ms\": %.4f,\n\t\t\t\"counters\": {", stats[7], stats[8], res.transfer);
+
+		for(int i = 0; i < GSPerfMon::CounterLast; i++)
+		{
+			fprintf(fp, "%s\"%s\": %.0f", i > 0 ? ", " : "", s_perfmon_counter_name[i], res.counters[i]);
+		}
+
+		fprintf(fp, "},\n\t\t\t\"frame_ms\": [");
+
+		for(size_t i = 0; i < res.frames.size(); i++)
+		{
+			fprintf(fp, "%s%.4f", i > 0 ? ", " : "", res.frames[i]);
+		}
+
+		fprintf(fp, "]\n\t\t}");
+	}
+
+	if(!csv)
+	{
+		fprintf(fp, "\n\t]\n}\n");
+	}
+}
+
+EXPORT_C_(int) GSReplayBenchmark(const char* path, int renderer, int loops, int warmup, const char* output)
+{
+	GSRendererType type = static_cast<GSRendererType>(renderer);
+
+	if(type != GSRendererType::Null && type != GSRendererType::OGL_SW)
+	{
+		fprintf(stderr, "GSReplayBenchmark: only the Null and SW renderers can run headless\n");
+		return -1;
+	}
+
+	loops = std::max<int>(loops, 1);
+	warmup = std::max<int>(warmup, 0);
+
+	GLLoader::in_replayer = true;
+
+	std::vector<std::string> dumps;
+
+	if(DIR* dir = opendir(path))
+	{
+		while(struct dirent* entry = readdir(dir))
+		{
+			std::string fn = entry->d_name;
+
+			auto ends_with = [&fn](const char* ext) {
+				size_t n = strlen(ext);
+				return fn.size() > n && fn.compare(fn.size() - n, n, ext) == 0;
+			};
+
+			if(ends_with(".gs") || ends_with(".gs.xz"))
+			{
+				dumps.push_back(std::string(path) + "/" + fn);
+			}
+		}
+
+		closedir(dir);
+
+		std::sort(dumps.begin(), dumps.end());
+	}
+	else
+	{
+		dumps.push_back(path);
+	}
+
+	// Open the output first, a bad path shouldn't throw away a long run
+
+	FILE* fp = stdout;
+
+	if(output != NULL && (fp = fopen(output, "w")) == NULL)
+	{
+		fprintf(stderr, "GSReplayBenchmark: failed to open %s\n", output);
+		return -1;
+	}
+
+	std::string out = output != NULL ? output : "";
+
+	bool csv = out.size() >= 4 && out.compare(out.size() - 4, 4, ".csv") == 0;
+
+	std::vector<GSReplayBenchmarkResult> results;
+
+	int failed = 0;
+
+	for(const std::string& fn : dumps)
+	{
+		GSReplayBenchmarkResult res;
+
+		fprintf(stderr, "GSReplayBenchmark: %s\n", fn.c_str());
+
+		if(GSReplayBenchmarkDump(fn, type, loops, warmup, res))
+		{
+			results.push_back(std::move(res));
+		}
+		else
+		{
+			failed++;
+		}
+	}
+
+	GSReplayBenchmarkWrite(fp, csv, type == GSRendererType::Null ? "Null" : "SW", loops, warmup, results);
+
+	if(fp != stdout)
+	{
+		fclose(fp);
+	}
+
+	return failed;
+}
 #endif
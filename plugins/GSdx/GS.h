@@ -86,6 +86,17 @@ enum GIF_REG_COMPLEX
 {
 	GIF_REG_STQRGBAXYZF2	= 0x00,
 	GIF_REG_STQRGBAXYZ2		= 0x01,
+	GIF_REG_UVRGBAXYZF2		= 0x02,
+	GIF_REG_UVRGBAXYZ2		= 0x03,
+	GIF_REG_RGBAXYZF2		= 0x04,
+	GIF_REG_RGBAXYZ2		= 0x05,
+	GIF_REGLIST_STRGBAQXYZF2	= 0x06,
+	GIF_REGLIST_STRGBAQXYZ2	= 0x07,
+	GIF_REGLIST_UVRGBAQXYZF2	= 0x08,
+	GIF_REGLIST_UVRGBAQXYZ2	= 0x09,
+	GIF_REGLIST_RGBAQXYZF2	= 0x0a,
+	GIF_REGLIST_RGBAQXYZ2	= 0x0b,
+	GIF_REG_COMPLEX_LAST,
 };
 
 enum GIF_A_D_REG
@@ -1120,7 +1131,9 @@ struct alignas(32) GIFPath
 	uint32 type;
 	GSVector4i regs;
 
-	enum {TYPE_UNKNOWN, TYPE_ADONLY, TYPE_STQRGBAXYZF2, TYPE_STQRGBAXYZ2};
+	// TYPE_COMPLEX + GIF_REG_COMPLEX: a repeating vertex layout, handled in one call per tag
+
+	enum {TYPE_UNKNOWN, TYPE_ADONLY, TYPE_COMPLEX};
 
 	__forceinline void SetTag(const void* mem)
 	{
@@ -1157,11 +1170,15 @@ struct alignas(32) GIFPath
 				switch(nreg)
 				{
 				case 1: break;
-				case 2: break;
+				case 2:
+					if(regs.u32[0] == 0x00000401) type = TYPE_COMPLEX + GIF_REG_RGBAXYZF2;
+					if(regs.u32[0] == 0x00000501) type = TYPE_COMPLEX + GIF_REG_RGBAXYZ2;
+					break;
 				case 3:
-					if(regs.u32[0] == 0x00040102) type = TYPE_STQRGBAXYZF2; // many games, TODO: formats mixed with NOPs (xeno2: 040f010f02, 04010f020f, mgs3: 04010f0f02, 0401020f0f, 04010f020f)
-					if(regs.u32[0] == 0x00050102) type = TYPE_STQRGBAXYZ2; // GoW (has other crazy formats, like ...030503050103)
-					// TODO: common types with UV instead
+					if(regs.u32[0] == 0x00040102) type = TYPE_COMPLEX + GIF_REG_STQRGBAXYZF2; // many games, TODO: formats mixed with NOPs (xeno2: 040f010f02, 04010f020f, mgs3: 04010f0f02, 0401020f0f, 04010f020f)
+					if(regs.u32[0] == 0x00050102) type = TYPE_COMPLEX + GIF_REG_STQRGBAXYZ2; // GoW (has other crazy formats, like ...030503050103)
+					if(regs.u32[0] == 0x00040103) type = TYPE_COMPLEX + GIF_REG_UVRGBAXYZF2;
+					if(regs.u32[0] == 0x00050103) type = TYPE_COMPLEX + GIF_REG_UVRGBAXYZ2;
 					break;
 				case 4: break;
 				case 5: break;
@@ -1169,12 +1186,12 @@ struct alignas(32) GIFPath
 				case 7: break;
 				case 8: break;
 				case 9:
-					if(regs.u32[0] == 0x02040102 && regs.u32[1] == 0x01020401 && regs.u32[2] == 0x00000004) {type = TYPE_STQRGBAXYZF2; nreg = 3; nloop *= 3;} // ffx
+					if(regs.u32[0] == 0x02040102 && regs.u32[1] == 0x01020401 && regs.u32[2] == 0x00000004) {type = TYPE_COMPLEX + GIF_REG_STQRGBAXYZF2; nreg = 3; nloop *= 3;} // ffx
 					break;
 				case 10: break;
 				case 11: break;
 				case 12:
-					if(regs.u32[0] == 0x02040102 && regs.u32[1] == 0x01020401 && regs.u32[2] == 0x04010204) {type = TYPE_STQRGBAXYZF2; nreg = 3; nloop *= 4;} // dq8 (not many, mostly 040102)
+					if(regs.u32[0] == 0x02040102 && regs.u32[1] == 0x01020401 && regs.u32[2] == 0x04010204) {type = TYPE_COMPLEX + GIF_REG_STQRGBAXYZF2; nreg = 3; nloop *= 4;} // dq8 (not many, mostly 040102)
 					break;
 				case 13: break;
 				case 14: break;
@@ -1185,6 +1202,24 @@ struct alignas(32) GIFPath
 				}
 			}
 		}
+		else if(tag.FLG == GIF_FLG_REGLIST)
+		{
+			switch(nreg)
+			{
+			case 2:
+				if(regs.u32[0] == 0x00000401) type = TYPE_COMPLEX + GIF_REGLIST_RGBAQXYZF2;
+				if(regs.u32[0] == 0x00000501) type = TYPE_COMPLEX + GIF_REGLIST_RGBAQXYZ2;
+				break;
+			case 3:
+				if(regs.u32[0] == 0x00040102) type = TYPE_COMPLEX + GIF_REGLIST_STRGBAQXYZF2;
+				if(regs.u32[0] == 0x00050102) type = TYPE_COMPLEX + GIF_REGLIST_STRGBAQXYZ2;
+				if(regs.u32[0] == 0x00040103) type = TYPE_COMPLEX + GIF_REGLIST_UVRGBAQXYZF2;
+				if(regs.u32[0] == 0x00050103) type = TYPE_COMPLEX + GIF_REGLIST_UVRGBAQXYZ2;
+				break;
+			default:
+				break;
+			}
+		}
 	}
 
 	__forceinline uint8 GetReg() const
@@ -21,14 +21,19 @@
 
 #include "stdafx.h"
 #include "GSDump.h"
+#include "GSdx.h"
 
 GSDumpBase::GSDumpBase(const std::string& fn)
 	: m_frames(0)
 	, m_extra_frames(2)
+	, m_pos(0)
 {
 	m_gs = px_fopen(fn, "wb");
 	if (!m_gs)
 		fprintf(stderr, "GSDump: Error failed to open %s\n", fn.c_str());
+
+	m_keyframe_interval = theApp.GetConfigI("dump_keyframes");
+	m_index = theApp.GetConfigB("dump_index") || m_keyframe_interval > 0;
 }
 
 GSDumpBase::~GSDumpBase()
@@ -39,10 +44,39 @@ GSDumpBase::~GSDumpBase()
 
 void GSDumpBase::AddHeader(uint32 crc, const GSFreezeData& fd, const GSPrivRegSet* regs)
 {
-	AppendRawData(&crc, 4);
-	AppendRawData(&fd.size, 4);
-	AppendRawData(fd.data, fd.size);
-	AppendRawData(regs, sizeof(*regs));
+	Append(&crc, 4);
+	Append(&fd.size, 4);
+	Append(fd.data, fd.size);
+	Append(regs, sizeof(*regs));
+
+	m_frame_offsets.push_back(m_pos);
+}
+
+void GSDumpBase::AddIndex()
+{
+	if (!m_index)
+		return;
+
+	// The last offset is the end of the stream, not a frame
+	m_frame_offsets.pop_back();
+
+	uint32 frames = m_frame_offsets.size();
+	uint32 keyframes = m_keyframe_offsets.size();
+	uint32 size = 4 + frames * 8 + 4 + keyframes * 12;
+
+	Append(4);
+	Append(&size, 4);
+	Append(&frames, 4);
+	Append(m_frame_offsets.data(), frames * 8);
+	Append(&keyframes, 4);
+
+	for (const auto& k : m_keyframe_offsets) {
+		Append(&k.first, 4);
+		Append(&k.second, 8);
+	}
+
+	uint32 footer[2] = {size + 5, GSDUMP_INDEX_MAGIC};
+	Append(footer, sizeof(footer));
 }
 
 void GSDumpBase::Transfer(int index, const uint8* mem, size_t size)
@@ -50,10 +84,10 @@ void GSDumpBase::Transfer(int index, const uint8* mem, size_t size)
 	if (size == 0)
 		return;
 
-	AppendRawData(0);
-	AppendRawData(static_cast<uint8>(index));
-	AppendRawData(&size, 4);
-	AppendRawData(mem, size);
+	Append(0);
+	Append(static_cast<uint8>(index));
+	Append(&size, 4);
+	Append(mem, size);
 }
 
 void GSDumpBase::ReadFIFO(uint32 size)
@@ -61,8 +95,8 @@ void GSDumpBase::ReadFIFO(uint32 size)
 	if (size == 0)
 		return;
 
-	AppendRawData(2);
-	AppendRawData(&size, 4);
+	Append(2);
+	Append(&size, 4);
 }
 
 bool GSDumpBase::VSync(int field, bool last, const GSPrivRegSet* regs)
@@ -71,11 +105,13 @@ bool GSDumpBase::VSync(int field, bool last, const GSPrivRegSet* regs)
 	if (!m_gs)
 		return true;
 
-	AppendRawData(3);
-	AppendRawData(regs, sizeof(*regs));
+	Append(3);
+	Append(regs, sizeof(*regs));
 
-	AppendRawData(1);
-	AppendRawData(static_cast<uint8>(field));
+	Append(1);
+	Append(static_cast<uint8>(field));
+
+	m_frame_offsets.push_back(m_pos);
 
 	if (last)
 		m_extra_frames--;
@@ -83,6 +119,20 @@ bool GSDumpBase::VSync(int field, bool last, const GSPrivRegSet* regs)
 	return (++m_frames & 1) == 0 && last && (m_extra_frames < 0);
 }
 
+bool GSDumpBase::NeedKeyframe() const
+{
+	return m_gs && m_keyframe_interval > 0 && (m_frames % m_keyframe_interval) == 0;
+}
+
+void GSDumpBase::Keyframe(const GSFreezeData& fd)
+{
+	m_keyframe_offsets.push_back(std::make_pair(static_cast<uint32>(m_frames), m_pos));
+
+	Append(5);
+	Append(&fd.size, 4);
+	Append(fd.data, fd.size);
+}
+
 void GSDumpBase::Write(const void *data, size_t size)
 {
 	if (!m_gs || size == 0)
@@ -103,6 +153,11 @@ GSDump::GSDump(const std::string& fn, uint32 crc, const GSFreezeData& fd, const
 	AddHeader(crc, fd, regs);
 }
 
+GSDump::~GSDump()
+{
+	AddIndex();
+}
+
 void GSDump::AppendRawData(const void *data, size_t size)
 {
 	Write(data, size);
@@ -119,76 +174,181 @@ void GSDump::AppendRawData(uint8 c)
 
 GSDumpXz::GSDumpXz(const std::string& fn, uint32 crc, const GSFreezeData& fd, const GSPrivRegSet* regs)
 	: GSDumpBase(fn + ".gs.xz")
+	, m_encoder(false)
+	, m_chunk(nullptr, 0)
+	, m_chunk_capacity(4 * 1024 * 1024)
+	, m_allocated(0)
+	, m_in_total(0)
+	, m_out_total(0)
+	, m_stall(0)
 {
+	m_max_chunks = std::max<size_t>(2, ((size_t)std::max(theApp.GetConfigI("dump_buffer"), 0) << 20) / m_chunk_capacity);
+
+	int threads = theApp.GetConfigI("dump_threads");
+	if (threads <= 0)
+		threads = std::min<int>(std::max<uint32>(lzma_cputhreads(), 1), 4);
+
+	// Each block is compressed independently by the encoder threads, the result is
+	// still a single xz stream so the existing readers don't need any change.
+	lzma_mt mt = {};
+	mt.threads = threads;
+	mt.preset = 6;
+	mt.check = LZMA_CHECK_CRC64;
+
 	m_strm = LZMA_STREAM_INIT;
-	lzma_ret ret = lzma_easy_encoder(&m_strm, 6 /*level*/, LZMA_CHECK_CRC64);
+	lzma_ret ret = lzma_stream_encoder_mt(&m_strm, &mt);
+	if (ret != LZMA_OK) {
+		fprintf(stderr, "GSDumpXz: multi-threaded encoder unavailable (error code %u), using a single thread\n", ret);
+
+		m_strm = LZMA_STREAM_INIT;
+		ret = lzma_easy_encoder(&m_strm, 6 /*level*/, LZMA_CHECK_CRC64);
+	}
+
 	if (ret != LZMA_OK) {
 		fprintf(stderr, "GSDumpXz: Error initializing LZMA encoder ! (error code %u)\n", ret);
 		return;
 	}
 
+	m_encoder = true;
+	m_out_buff.resize(1024*1024);
+	m_writer = std::unique_ptr<GSJobQueue<Chunk, 256>>(new GSJobQueue<Chunk, 256>([this](Chunk& c) {WriteChunk(c);}));
+
 	AddHeader(crc, fd, regs);
 }
 
 GSDumpXz::~GSDumpXz()
 {
-	Flush();
+	if (m_writer) {
+		AddIndex();
 
-	// Finish the stream
-	m_strm.avail_in = 0;
-	Compress(LZMA_FINISH, LZMA_STREAM_END);
+		Flush();
+
+		// An empty chunk finishes the stream
+		m_writer->Push(Chunk(nullptr, 0));
+		m_writer->Wait();
+		m_writer.reset();
+
+		fprintf(stderr, "GSDumpXz: %llu MB compressed to %llu MB, GS thread waited %lld ms\n",
+			(unsigned long long)(m_in_total >> 20), (unsigned long long)(m_out_total >> 20),
+			(long long)std::chrono::duration_cast<std::chrono::milliseconds>(m_stall).count());
+	}
 
-	lzma_end(&m_strm);
+	if (m_encoder)
+		lzma_end(&m_strm);
+
+	_aligned_free(m_chunk.first);
+
+	for (uint8* p : m_free)
+		_aligned_free(p);
 }
 
 void GSDumpXz::AppendRawData(const void *data, size_t size)
 {
-	size_t old_size = m_in_buff.size();
-	m_in_buff.resize(old_size + size);
-	memcpy(&m_in_buff[old_size], data, size);
+	if (!m_writer)
+		return;
 
-	// Enough data was accumulated, time to write/compress it.  If compression
-	// is enabled, it will freeze PCSX2. 1GB should be enough for long dump.
-	//
-	// Note: long dumps are currently not supported so this path won't be executed
-	if (m_in_buff.size() > 1024*1024*1024)
-		Flush();
+	const uint8* src = static_cast<const uint8*>(data);
+
+	while (size > 0) {
+		if (m_chunk.second == m_chunk_capacity || m_chunk.first == nullptr)
+			NextChunk();
+
+		size_t n = std::min(size, m_chunk_capacity - m_chunk.second);
+		memcpy(m_chunk.first + m_chunk.second, src, n);
+
+		m_chunk.second += n;
+		src += n;
+		size -= n;
+	}
 }
 
 void GSDumpXz::AppendRawData(uint8 c)
 {
-	m_in_buff.push_back(c);
+	if (!m_writer)
+		return;
+
+	if (m_chunk.second == m_chunk_capacity || m_chunk.first == nullptr)
+		NextChunk();
+
+	m_chunk.first[m_chunk.second++] = c;
+}
+
+void GSDumpXz::NextChunk()
+{
+	Flush();
+
+	std::unique_lock<std::mutex> l(m_free_lock);
+
+	if (m_free.empty() && m_allocated < m_max_chunks) {
+		m_allocated++;
+		m_chunk.first = (uint8*)_aligned_malloc(m_chunk_capacity, 32);
+		return;
+	}
+
+	if (m_free.empty()) {
+		auto start = std::chrono::steady_clock::now();
+
+		while (m_free.empty())
+			m_free_cv.wait(l);
+
+		m_stall += std::chrono::steady_clock::now() - start;
+	}
+
+	m_chunk.first = m_free.back();
+	m_free.pop_back();
 }
 
 void GSDumpXz::Flush()
 {
-	if (m_in_buff.empty())
+	if (m_chunk.second == 0 || !m_writer)
 		return;
 
-	m_strm.next_in = m_in_buff.data();
-	m_strm.avail_in = m_in_buff.size();
+	m_in_total += m_chunk.second;
+
+	m_writer->Push(m_chunk);
+
+	m_chunk = Chunk(nullptr, 0);
+}
+
+void GSDumpXz::WriteChunk(Chunk& c)
+{
+	if (c.first == nullptr) {
+		m_strm.avail_in = 0;
+		Compress(LZMA_FINISH, LZMA_STREAM_END);
+		return;
+	}
+
+	m_strm.next_in = c.first;
+	m_strm.avail_in = c.second;
 
 	Compress(LZMA_RUN, LZMA_OK);
 
-	m_in_buff.clear();
+	{
+		std::lock_guard<std::mutex> l(m_free_lock);
+		m_free.push_back(c.first);
+	}
+
+	m_free_cv.notify_one();
 }
 
 void GSDumpXz::Compress(lzma_action action, lzma_ret expected_status)
 {
-	std::vector<uint8> out_buff(1024*1024);
+	lzma_ret ret;
+
 	do {
-		m_strm.next_out = out_buff.data();
-		m_strm.avail_out = out_buff.size();
+		m_strm.next_out = m_out_buff.data();
+		m_strm.avail_out = m_out_buff.size();
 
-		lzma_ret ret = lzma_code(&m_strm, action);
+		ret = lzma_code(&m_strm, action);
 
-		if (ret != expected_status) {
+		if (ret != LZMA_OK && ret != expected_status) {
 			fprintf (stderr, "GSDumpXz: Error %d\n", (int) ret);
 			return;
 		}
 
-		size_t write_size = out_buff.size() - m_strm.avail_out;
-		Write(out_buff.data(), write_size);
+		size_t write_size = m_out_buff.size() - m_strm.avail_out;
+		Write(m_out_buff.data(), write_size);
+		m_out_total += write_size;
 
-	} while (m_strm.avail_out == 0);
+	} while (ret != expected_status || (action == LZMA_RUN && (m_strm.avail_out == 0 || m_strm.avail_in > 0)));
 }
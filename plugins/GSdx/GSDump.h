@@ -23,6 +23,7 @@
 
 #include "GS.h"
 #include "Renderers/SW/GSVertexSW.h"
+#include "GSThread_CXX11.h"
 #include <lzma.h>
 
 /*
@@ -42,16 +43,42 @@ ReadFIFO2 data (id == 2)
 Regs data (id == 3)
 - [PMODE/0x2000]
 
+Frame index (id == 4), last packet of the dump, only the footer follows (dump_index)
+- [4/1] [size/4] [frames/4] [frame offset/8 * frames] [keyframes/4] [{frame/4, offset/8} * keyframes]
+- [size + 5/4] ['GSIX'/4]
+
+Keyframe (id == 5), the GS state at the start of the next frame (dump_keyframes)
+- [5/1] [size/4] [state data/size]
+
+Offsets are positions in the uncompressed stream. The footer lets raw dumps
+find the index from the end of the file, xz dumps only see it at the end.
+
+Ids 4 and 5 are only written on request: GSdx builds that predate them take an
+unknown id for a corrupted dump. Keyframes turn the index on as well, the dump
+needs a newer reader anyway.
+
 */
 
+#define GSDUMP_INDEX_MAGIC 0x58495347 // 'GSIX'
+
 class GSDumpBase
 {
 	int m_frames;
 	int m_extra_frames;
 	FILE* m_gs;
 
+	uint64 m_pos;
+	int m_keyframe_interval;
+	bool m_index;
+	std::vector<uint64> m_frame_offsets;
+	std::vector<std::pair<uint32, uint64>> m_keyframe_offsets;
+
+	void Append(const void *data, size_t size) {AppendRawData(data, size); m_pos += size;}
+	void Append(uint8 c) {AppendRawData(c); m_pos++;}
+
 protected:
 	void AddHeader(uint32 crc, const GSFreezeData& fd, const GSPrivRegSet* regs);
+	void AddIndex();
 	void Write(const void *data, size_t size);
 
 	virtual void AppendRawData(const void *data, size_t size) = 0;
@@ -64,6 +91,9 @@ public:
 	void ReadFIFO(uint32 size);
 	void Transfer(int index, const uint8* mem, size_t size);
 	bool VSync(int field, bool last, const GSPrivRegSet* regs);
+
+	bool NeedKeyframe() const;
+	void Keyframe(const GSFreezeData& fd);
 };
 
 class GSDump final : public GSDumpBase
@@ -73,16 +103,37 @@ class GSDump final : public GSDumpBase
 
 public:
 	GSDump(const std::string& fn, uint32 crc, const GSFreezeData& fd, const GSPrivRegSet* regs);
-	virtual ~GSDump() = default;
+	virtual ~GSDump();
 };
 
+// Transfers are copied to fixed size chunks on the GS thread and handed over to a
+// writer thread which feeds the multi-threaded xz encoder. The GS thread only waits
+// when every chunk of the memory budget (dump_buffer) is still being compressed.
 class GSDumpXz final : public GSDumpBase
 {
+	typedef std::pair<uint8*, size_t> Chunk;
+
 	lzma_stream m_strm;
+	bool m_encoder;
+
+	Chunk m_chunk;
+	size_t m_chunk_capacity;
+	size_t m_max_chunks;
+	size_t m_allocated;
+	std::vector<uint8*> m_free;
+	std::mutex m_free_lock;
+	std::condition_variable m_free_cv;
+
+	std::unique_ptr<GSJobQueue<Chunk, 256>> m_writer;
+	std::vector<uint8> m_out_buff;
 
-	std::vector<uint8> m_in_buff;
+	uint64 m_in_total;
+	uint64 m_out_total;
+	std::chrono::steady_clock::duration m_stall;
 
 	void Flush();
+	void NextChunk();
+	void WriteChunk(Chunk& c);
 	void Compress(lzma_action action, lzma_ret expected_status);
 	void AppendRawData(const void *data, size_t size);
 	void AppendRawData(uint8 c);
@@ -0,0 +1,521 @@
+/*
+ *  Copyright (C) 2019 PCSX2 Dev Team
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "GSDumpStream.h"
+#include "GSDump.h"
+
+GSDumpStream::GSDumpStream(const std::string& fn, size_t budget)
+	: m_fn(fn)
+	, m_crc(0)
+	, m_header_size(0)
+	, m_read(0)
+	, m_write(0)
+	, m_used(0)
+	, m_count(0)
+	, m_current(0)
+	, m_exit(false)
+	, m_error(false)
+	, m_seek(0)
+	, m_generation(0)
+{
+	m_capacity = std::max<size_t>(budget, 8 << 20) & ~(size_t)15;
+	m_ring = (uint8*)_aligned_malloc(m_capacity, 32);
+
+	// Header is read synchronously, it can throw like GSDumpFile does
+
+	std::unique_ptr<GSDumpFile> file(Open(0));
+
+	uint32 size = 0;
+
+	file->Read(&m_crc, 4);
+	file->Read(&size, 4);
+	m_state.resize(size);
+	file->Read(m_state.data(), size);
+	file->Read(m_regs.data(), 0x2000);
+
+	m_header_size = 8 + size + 0x2000;
+
+	// Raw dumps find the index from the footer, xz dumps when the decoder reaches it
+
+	uint32 footer[2];
+
+	if(file->ReadTail(footer, sizeof(footer)) && footer[1] == GSDUMP_INDEX_MAGIC && footer[0] > 5)
+	{
+		std::vector<uint8> tail(footer[0] + sizeof(footer));
+
+		if(file->ReadTail(tail.data(), tail.size()) && tail[0] == 4)
+		{
+			ReadIndex(&tail[5], footer[0] - 5);
+		}
+	}
+
+	m_thread = std::thread(&GSDumpStream::ThreadProc, this);
+}
+
+GSDumpStream::~GSDumpStream()
+{
+	{
+		std::lock_guard<std::mutex> l(m_lock);
+
+		m_exit = true;
+	}
+
+	m_not_full.notify_one();
+
+	m_thread.join();
+
+	_aligned_free(m_ring);
+}
+
+GSDumpFile* GSDumpStream::Open(uint64 offset)
+{
+	char* fn = const_cast<char*>(m_fn.c_str());
+
+	const bool is_xz = m_fn.size() >= 4 && m_fn.compare(m_fn.size() - 3, 3, ".xz") == 0;
+
+	std::unique_ptr<GSDumpFile> file(is_xz
+		? (GSDumpFile*)new GSDumpLzma(fn, nullptr)
+		: (GSDumpFile*)new GSDumpRaw(fn, nullptr));
+
+	if(offset > 0 && !file->Skip(offset))
+	{
+		return NULL;
+	}
+
+	return file.release();
+}
+
+bool GSDumpStream::ReadIndex(const uint8* data, size_t size)
+{
+	uint32 frames, keyframes;
+
+	if(size < 8)
+	{
+		return false;
+	}
+
+	memcpy(&frames, data, 4);
+
+	if(size < 8 + (size_t)frames * 8)
+	{
+		return false;
+	}
+
+	// Frame offsets are for external tools, only keyframes help seeking
+
+	data += 4 + (size_t)frames * 8;
+
+	memcpy(&keyframes, data, 4);
+
+	data += 4;
+
+	if(size < 8 + (size_t)frames * 8 + (size_t)keyframes * 12)
+	{
+		return false;
+	}
+
+	m_keyframe_offsets.clear();
+
+	for(uint32 i = 0; i < keyframes; i++, data += 12)
+	{
+		uint32 frame;
+		uint64 offset;
+
+		memcpy(&frame, data, 4);
+		memcpy(&offset, data + 4, 8);
+
+		m_keyframe_offsets.push_back(std::make_pair(frame, offset));
+	}
+
+	return true;
+}
+
+GSDumpStream::Packet* GSDumpStream::Reserve(uint8 type, size_t payload, int generation)
+{
+	const size_t header = sizeof(Record);
+
+	size_t bytes = header + ((payload + 15) & ~(size_t)15);
+
+	// Packets too big for the ring go to a side buffer, once everything before them is released
+
+	bool oversize = bytes > m_capacity / 2;
+
+	if(oversize)
+	{
+		bytes = header;
+	}
+
+	std::unique_lock<std::mutex> l(m_lock);
+
+	while(true)
+	{
+		if(m_exit || m_generation != generation)
+		{
+			return NULL;
+		}
+
+		if(m_used == 0)
+		{
+			m_read = m_write = 0;
+
+			break;
+		}
+
+		if(!oversize)
+		{
+			if(m_write > m_read)
+			{
+				if(m_capacity - m_write >= bytes)
+				{
+					break;
+				}
+
+				if(m_read >= bytes)
+				{
+					size_t tail = m_capacity - m_write;
+
+					if(tail >= header)
+					{
+						((Record*)&m_ring[m_write])->packet.type = Wrap;
+					}
+
+					m_used += tail;
+					m_write = 0;
+
+					break;
+				}
+			}
+			else if(m_read - m_write >= bytes)
+			{
+				break;
+			}
+		}
+
+		m_not_full.wait(l);
+	}
+
+	Record* r = (Record*)&m_ring[m_write];
+
+	r->bytes = bytes;
+
+	m_write += bytes;
+	m_used += bytes;
+
+	Packet* p = &r->packet;
+
+	if(oversize)
+	{
+		m_oversize.resize(payload);
+
+		p->data = m_oversize.data();
+	}
+	else
+	{
+		p->data = (uint8*)(r + 1);
+	}
+
+	p->type = type;
+	p->param = 0;
+	p->size = (uint32)payload;
+	p->addr = 0;
+	p->frame = 0;
+
+	return p;
+}
+
+void GSDumpStream::Commit(int generation)
+{
+	{
+		std::lock_guard<std::mutex> l(m_lock);
+
+		if(m_generation != generation)
+		{
+			return;
+		}
+
+		m_count++;
+	}
+
+	m_not_empty.notify_one();
+}
+
+void GSDumpStream::ThreadProc()
+{
+	std::unique_ptr<GSDumpFile> file;
+
+	int generation = -1;
+	int target = 0;
+	int frame = 0;
+
+	// Every loop and every seek starts by restoring the state, from the closest keyframe when indexed
+
+	auto restart = [&]() -> bool
+	{
+		const std::pair<uint32, uint64>* key = NULL;
+
+		for(const auto& k : m_keyframe_offsets)
+		{
+			if((int)k.first <= target && (key == NULL || k.first > key->first))
+			{
+				key = &k;
+			}
+		}
+
+		if(key != NULL)
+		{
+			file.reset(Open(key->second));
+
+			uint8 type = 0;
+			uint32 size = 0;
+
+			if(!file || !file->Read(&type, 1) || type != 5 || !file->Read(&size, 4))
+			{
+				return false;
+			}
+
+			frame = key->first;
+
+			if(Packet* p = Reserve(5, size, generation))
+			{
+				p->frame = frame;
+
+				file->Read(p->data, size);
+
+				Commit(generation);
+			}
+		}
+		else
+		{
+			file.reset(Open(m_header_size));
+
+			if(!file)
+			{
+				return false;
+			}
+
+			frame = 0;
+
+			if(Packet* p = Reserve(5, m_state.size(), generation))
+			{
+				memcpy(p->data, m_state.data(), m_state.size());
+
+				Commit(generation);
+			}
+
+			if(Packet* p = Reserve(3, m_regs.size(), generation))
+			{
+				memcpy(p->data, m_regs.data(), m_regs.size());
+
+				Commit(generation);
+			}
+		}
+
+		return true;
+	};
+
+	try
+	{
+		while(true)
+		{
+			{
+				std::lock_guard<std::mutex> l(m_lock);
+
+				if(m_exit)
+				{
+					return;
+				}
+
+				if(generation != m_generation)
+				{
+					generation = m_generation;
+					target = m_seek;
+					file.reset();
+				}
+			}
+
+			if(!file && !restart())
+			{
+				break;
+			}
+
+			uint8 type;
+			uint8 param = 0;
+			uint32 size = 0;
+
+			if(!file->Read(&type, 1))
+			{
+				file.reset();
+
+				continue;
+			}
+
+			Packet* p = NULL;
+
+			switch(type)
+			{
+			case 0:
+				file->Read(&param, 1);
+				file->Read(&size, 4);
+
+				if((p = Reserve(0, size, generation)) != NULL)
+				{
+					p->param = param;
+					p->addr = param == 0 ? 0x4000 - size : 0;
+
+					file->Read(p->data, size);
+				}
+
+				break;
+
+			case 1:
+				file->Read(&param, 1);
+
+				if((p = Reserve(1, 0, generation)) != NULL)
+				{
+					p->param = param;
+				}
+
+				break;
+
+			case 2:
+				file->Read(&size, 4);
+
+				if((p = Reserve(2, 0, generation)) != NULL)
+				{
+					p->size = size;
+				}
+
+				break;
+
+			case 3:
+				if((p = Reserve(3, 0x2000, generation)) != NULL)
+				{
+					file->Read(p->data, 0x2000);
+				}
+
+				break;
+
+			case 4:
+			{
+				file->Read(&size, 4);
+
+				std::vector<uint8> index(size);
+
+				if(file->Read(index.data(), size))
+				{
+					ReadIndex(index.data(), size);
+				}
+
+				file.reset(); // end of the dump, the footer follows
+
+				break;
+			}
+
+			case 5:
+				file->Read(&size, 4);
+				file->Skip(size);
+
+				break;
+
+			default:
+				fprintf(stderr, "GSDumpStream: unknown packet type %d\n", type);
+
+				file.reset();
+
+				break;
+			}
+
+			if(p != NULL)
+			{
+				p->frame = frame;
+
+				Commit(generation);
+
+				if(type == 1)
+				{
+					frame++;
+				}
+			}
+		}
+	}
+	catch(...)
+	{
+	}
+
+	{
+		std::lock_guard<std::mutex> l(m_lock);
+
+		m_error = true;
+	}
+
+	m_not_empty.notify_one();
+}
+
+const GSDumpStream::Packet* GSDumpStream::Next()
+{
+	std::unique_lock<std::mutex> l(m_lock);
+
+	if(m_current > 0)
+	{
+		m_read += m_current;
+		m_used -= m_current;
+		m_current = 0;
+
+		m_not_full.notify_one();
+	}
+
+	while(m_count == 0)
+	{
+		if(m_error)
+		{
+			return NULL;
+		}
+
+		m_not_empty.wait(l);
+	}
+
+	if(m_capacity - m_read < sizeof(Record) || ((Record*)&m_ring[m_read])->packet.type == Wrap)
+	{
+		m_used -= m_capacity - m_read;
+		m_read = 0;
+	}
+
+	Record* r = (Record*)&m_ring[m_read];
+
+	m_count--;
+	m_current = r->bytes;
+
+	return &r->packet;
+}
+
+void GSDumpStream::Seek(int frame)
+{
+	{
+		std::lock_guard<std::mutex> l(m_lock);
+
+		m_seek = frame;
+		m_generation++;
+
+		m_read = m_write = m_used = m_count = m_current = 0;
+	}
+
+	m_not_full.notify_one();
+}
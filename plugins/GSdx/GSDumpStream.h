@@ -0,0 +1,96 @@
+/*
+ *  Copyright (C) 2019 PCSX2 Dev Team
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#pragma once
+
+#include "GSLzma.h"
+
+// Streaming .gs reader: packets are decoded on a background thread into a fixed size
+// ring and handed out in place, so memory use is bounded whatever the dump length.
+// The dump is played in a loop, each loop (and each Seek) starts with a type 5 packet
+// that restores the GS state. With a frame index and keyframes (see GSDump.h) a seek
+// starts from the closest keyframe, otherwise from the beginning of the dump. The
+// consumer is expected to skip presentation of the frames before the seek target.
+
+class GSDumpStream
+{
+public:
+	struct Packet
+	{
+		uint8 type, param;
+		uint32 size, addr;
+		int frame;
+		uint8* data; // path 1 (param 0) transfers live at data[0..size), addressed as (data - addr, addr)
+	};
+
+private:
+	struct alignas(16) Record
+	{
+		Packet packet;
+		size_t bytes;
+	};
+
+	enum {Wrap = 0xff};
+
+	std::string m_fn;
+	uint32 m_crc;
+	std::vector<uint8> m_state;
+	std::array<uint8, 0x2000> m_regs;
+	uint64 m_header_size;
+
+	std::vector<std::pair<uint32, uint64>> m_keyframe_offsets; // decoder thread only
+
+	uint8* m_ring;
+	size_t m_capacity;
+	size_t m_read;
+	size_t m_write;
+	size_t m_used;
+	size_t m_count;
+	size_t m_current;
+	std::vector<uint8> m_oversize;
+
+	std::thread m_thread;
+	std::mutex m_lock;
+	std::condition_variable m_not_full;
+	std::condition_variable m_not_empty;
+	bool m_exit;
+	bool m_error;
+	int m_seek;
+	int m_generation;
+
+	GSDumpFile* Open(uint64 offset);
+	bool ReadIndex(const uint8* data, size_t size);
+	Packet* Reserve(uint8 type, size_t payload, int generation);
+	void Commit(int generation);
+	void ThreadProc();
+
+public:
+	GSDumpStream(const std::string& fn, size_t budget);
+	virtual ~GSDumpStream();
+
+	uint32 GetCRC() const {return m_crc;}
+	std::vector<uint8>& GetState() {return m_state;}
+	const uint8* GetRegs() const {return m_regs.data();}
+
+	// Blocks until the next packet is decoded, the previous one is released. NULL on error.
+	const Packet* Next();
+
+	void Seek(int frame);
+};
@@ -21,6 +21,11 @@
 #include "stdafx.h"
 #include "GSLzma.h"
 
+#ifdef _WIN32
+#define fseeko _fseeki64
+#define ftello _ftelli64
+#endif
+
 GSDumpFile::GSDumpFile(char* filename, const char* repack_filename) {
 	m_fp = fopen(filename, "rb");
 	if (m_fp == nullptr) {
@@ -46,6 +51,19 @@ void GSDumpFile::Repack(void* ptr, size_t size) {
 
 }
 
+bool GSDumpFile::Skip(size_t size) {
+	uint8_t buff[4096];
+
+	while (size > 0) {
+		size_t l = std::min(size, sizeof(buff));
+		if (!Read(buff, l))
+			return false;
+		size -= l;
+	}
+
+	return true;
+}
+
 GSDumpFile::~GSDumpFile() {
 	if (m_fp)
 		fclose(m_fp);
@@ -139,6 +157,21 @@ bool GSDumpLzma::Read(void* ptr, size_t size) {
 	return false;
 }
 
+bool GSDumpLzma::Skip(size_t size) {
+	while (size && !IsEof()) {
+		if (m_avail == 0) {
+			Decompress();
+		}
+
+		size_t l = std::min(size, m_avail);
+		m_avail -= l;
+		size    -= l;
+		m_start += l;
+	}
+
+	return size == 0;
+}
+
 GSDumpLzma::~GSDumpLzma() {
 	lzma_end(&m_strm);
 
@@ -176,3 +209,17 @@ bool GSDumpRaw::Read(void* ptr, size_t size) {
 
 	return false;
 }
+
+bool GSDumpRaw::Skip(size_t size) {
+	return fseeko(m_fp, size, SEEK_CUR) == 0;
+}
+
+bool GSDumpRaw::ReadTail(void* ptr, size_t size) {
+	int64 pos = ftello(m_fp);
+
+	bool ret = fseeko(m_fp, -(int64)size, SEEK_END) == 0 && fread(ptr, 1, size, m_fp) == size;
+
+	fseeko(m_fp, pos, SEEK_SET);
+
+	return ret;
+}
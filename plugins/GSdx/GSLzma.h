@@ -18,6 +18,8 @@
  *
  */
 
+#pragma once
+
 #include <lzma.h>
 
 class GSDumpFile {
@@ -31,6 +33,8 @@ class GSDumpFile {
 	public:
 	virtual bool IsEof() = 0;
 	virtual bool Read(void* ptr, size_t size) = 0;
+	virtual bool Skip(size_t size);
+	virtual bool ReadTail(void* ptr, size_t size) { return false; }
 
 	GSDumpFile(char* filename, const char* repack_filename);
 	virtual ~GSDumpFile();
@@ -56,6 +60,7 @@ class GSDumpLzma : public GSDumpFile {
 
 	bool IsEof() final;
 	bool Read(void* ptr, size_t size) final;
+	bool Skip(size_t size) final;
 };
 
 class GSDumpRaw : public GSDumpFile {
@@ -74,4 +79,6 @@ class GSDumpRaw : public GSDumpFile {
 
 	bool IsEof() final;
 	bool Read(void* ptr, size_t size) final;
+	bool Skip(size_t size) final;
+	bool ReadTail(void* ptr, size_t size) final;
 };
@@ -26,16 +26,35 @@ GSPerfMon::GSPerfMon()
 	: m_frame(0)
 	, m_lastframe(0)
 	, m_count(0)
+#ifdef DISABLE_PERF_MON
+	, m_counting(false)
+#else
+	, m_counting(true)
+#endif
+	, m_draw(NULL)
+	, m_draw_id(0)
+	, m_draw_frame(0)
+	, m_draw_tsc(0)
 {
 	memset(m_counters, 0, sizeof(m_counters));
 	memset(m_stats, 0, sizeof(m_stats));
+	memset(m_totals, 0, sizeof(m_totals));
 	memset(m_total, 0, sizeof(m_total));
 	memset(m_begin, 0, sizeof(m_begin));
 }
 
 void GSPerfMon::Put(counter_t c, double val)
 {
-#ifndef DISABLE_PERF_MON
+	if(c == Frame)
+	{
+		m_draw_frame++; // draw records work without the counters
+	}
+
+	if(!m_counting)
+	{
+		return;
+	}
+
 	if(c == Frame)
 	{
 #if defined(__unix__)
@@ -61,12 +80,15 @@ void GSPerfMon::Put(counter_t c, double val)
 	{
 		m_counters[c] += val;
 	}
-#endif
 }
 
 void GSPerfMon::Update()
 {
-#ifndef DISABLE_PERF_MON
+	if(!m_counting)
+	{
+		return;
+	}
+
 	if(m_count > 0)
 	{
 		for(size_t i = 0; i < countof(m_counters); i++)
@@ -77,8 +99,12 @@ void GSPerfMon::Update()
 		m_count = 0;
 	}
 
+	for(size_t i = 0; i < countof(m_counters); i++)
+	{
+		m_totals[i] += m_counters[i];
+	}
+
 	memset(m_counters, 0, sizeof(m_counters));
-#endif
 }
 
 void GSPerfMon::Start(int timer)
@@ -117,3 +143,207 @@ int GSPerfMon::CPU(int timer, bool reset)
 
 	return percent;
 }
+
+void GSPerfMon::EnableDraws(size_t count)
+{
+	std::lock_guard<std::mutex> l(m_draw_lock);
+
+	m_draws.clear();
+	m_draws.resize(count);
+	m_draws.shrink_to_fit();
+
+	memset(m_draws.data(), 0, sizeof(DrawRecord) * count);
+
+	m_draw = NULL;
+}
+
+uint64 GSPerfMon::BeginDraw(int primclass, uint32 vertices, uint32 indices)
+{
+	// Not behind DISABLE_PERF_MON, recording is opt-in and costs one test per draw otherwise
+
+	if(m_draws.empty())
+	{
+		return 0;
+	}
+
+	uint64 now = __rdtsc();
+
+	if(m_draw_tsc == 0)
+	{
+		m_draw_tsc = now;
+		m_draw_clock = std::chrono::steady_clock::now();
+	}
+
+	std::lock_guard<std::mutex> l(m_draw_lock);
+
+	DrawRecord* r = &m_draws[m_draw_id % m_draws.size()];
+
+	memset(r, 0, sizeof(*r));
+
+	r->id = ++m_draw_id;
+	r->frame = m_draw_frame;
+	r->primclass = primclass;
+	r->vertices = vertices;
+	r->indices = indices;
+	r->begin = now;
+
+	m_draw = r;
+
+	return r->id;
+}
+
+void GSPerfMon::SetupDone()
+{
+	if(m_draw != NULL && m_draw->setup == 0)
+	{
+		m_draw->setup = __rdtsc();
+	}
+}
+
+void GSPerfMon::TextureLookup(bool hit)
+{
+	if(m_draw != NULL)
+	{
+		if(hit) m_draw->tc_hit++;
+		else m_draw->tc_miss++;
+	}
+}
+
+void GSPerfMon::DrawPixels(uint64 pixels)
+{
+	if(m_draw != NULL)
+	{
+		m_draw->pixels += pixels;
+	}
+}
+
+void GSPerfMon::EndDraw()
+{
+	if(m_draw != NULL)
+	{
+		m_draw->end = __rdtsc();
+
+		if(m_draw->setup == 0)
+		{
+			m_draw->setup = m_draw->end;
+		}
+
+		m_draw = NULL;
+	}
+}
+
+void GSPerfMon::AddRaster(uint64 id, uint64 begin, uint64 end, uint64 pixels)
+{
+	std::lock_guard<std::mutex> l(m_draw_lock);
+
+	if(m_draws.empty())
+	{
+		return;
+	}
+
+	DrawRecord& r = m_draws[(id - 1) % m_draws.size()];
+
+	if(r.id != id)
+	{
+		return; // overwritten, the ring is smaller than the rasterizer queue
+	}
+
+	if(r.raster_begin == 0 || begin < r.raster_begin) r.raster_begin = begin;
+	if(end > r.raster_end) r.raster_end = end;
+
+	r.raster_ticks += end - begin;
+	r.pixels += pixels;
+}
+
+bool GSPerfMon::ExportDraws(const std::string& fn)
+{
+	std::lock_guard<std::mutex> l(m_draw_lock);
+
+	if(m_draws.empty() || m_draw_tsc == 0)
+	{
+		return false;
+	}
+
+	FILE* fp = px_fopen(fn, "w");
+
+	if(fp == NULL)
+	{
+		return false;
+	}
+
+	// rdtsc to microseconds, calibrated over the whole recording
+
+	double us = (double)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_draw_clock).count();
+	double scale = us > 0 ? us / (double)(__rdtsc() - m_draw_tsc) : 0;
+
+	auto ts = [&](uint64 t) {return (double)(t - m_draw_tsc) * scale;};
+
+	static const char* prims[] = {"point", "line", "triangle", "sprite"};
+
+	size_t n = (size_t)std::min<uint64>(m_draw_id, m_draws.size());
+	size_t first = (size_t)(m_draw_id - n);
+
+	fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+	const char* sep = "";
+
+	for(size_t i = 0; i < n; )
+	{
+		// Draws of the same frame are nested in a frame slice
+
+		const DrawRecord& f = m_draws[(first + i) % m_draws.size()];
+
+		uint64 frame_end = 0;
+		size_t j = i;
+
+		for(; j < n; j++)
+		{
+			const DrawRecord& r = m_draws[(first + j) % m_draws.size()];
+
+			if(r.frame != f.frame) break;
+
+			frame_end = std::max(frame_end, std::max(r.end, r.raster_end));
+		}
+
+		if(f.end == 0) break; // still drawing
+
+		fprintf(fp, "%s{\"name\":\"frame %llu\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+			sep, (unsigned long long)f.frame, ts(f.begin), ts(frame_end) - ts(f.begin));
+
+		sep = ",\n";
+
+		for(; i < j; i++)
+		{
+			const DrawRecord& r = m_draws[(first + i) % m_draws.size()];
+
+			if(r.end == 0) continue;
+
+			const char* prim = r.primclass >= 0 && r.primclass < (int)countof(prims) ? prims[r.primclass] : "?";
+
+			fprintf(fp, ",\n{\"name\":\"draw %llu %s\",\"cat\":\"draw\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,"
+				"\"args\":{\"frame\":%llu,\"prim\":\"%s\",\"vertices\":%u,\"indices\":%u,\"pixels\":%llu,\"tc_hit\":%u,\"tc_miss\":%u,"
+				"\"setup_us\":%.3f,\"draw_us\":%.3f,\"raster_cpu_us\":%.3f}}",
+				(unsigned long long)r.id, prim, ts(r.begin), ts(r.end) - ts(r.begin),
+				(unsigned long long)r.frame, prim, r.vertices, r.indices, (unsigned long long)r.pixels, r.tc_hit, r.tc_miss,
+				ts(r.setup) - ts(r.begin), ts(r.end) - ts(r.setup), (double)r.raster_ticks * scale);
+
+			fprintf(fp, ",\n{\"name\":\"setup\",\"cat\":\"draw\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+				ts(r.begin), ts(r.setup) - ts(r.begin));
+
+			fprintf(fp, ",\n{\"name\":\"submit\",\"cat\":\"draw\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+				ts(r.setup), ts(r.end) - ts(r.setup));
+
+			if(r.raster_end > 0)
+			{
+				fprintf(fp, ",\n{\"name\":\"raster %llu\",\"cat\":\"raster\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":%.3f,\"dur\":%.3f}",
+					(unsigned long long)r.id, ts(r.raster_begin), ts(r.raster_end) - ts(r.raster_begin));
+			}
+		}
+	}
+
+	fprintf(fp, "\n]}\n");
+
+	fclose(fp);
+
+	return true;
+}
@@ -36,16 +36,42 @@ public:
 	enum counter_t 
 	{
 		Frame, Prim, Draw, Swizzle, Unswizzle, Fillrate, Quad, SyncPoint,
+		UnswizzleSkip, // bytes of texture upload avoided by the texture cache (texture_hash), also in DISABLE_PERF_MON builds once EnableCounters is called
 		CounterLast,
 	};
 
+	// One entry per draw call. Times are __rdtsc() ticks, begin..setup..end on the GS thread,
+	// raster_* are filled by the rasterizer threads of the SW renderer.
+
+	struct DrawRecord
+	{
+		uint64 id; // 0 = unused
+		uint64 frame;
+		int primclass;
+		uint32 vertices, indices;
+		uint64 pixels;
+		uint32 tc_hit, tc_miss;
+		uint64 begin, setup, end;
+		uint64 raster_begin, raster_end, raster_ticks;
+	};
+
 protected:
 	double m_counters[CounterLast];
 	double m_stats[CounterLast];
+	double m_totals[CounterLast];
 	uint64 m_begin[TimerLast], m_total[TimerLast], m_start[TimerLast];
 	uint64 m_frame;
 	clock_t m_lastframe;
 	int m_count;
+	bool m_counting;
+
+	std::vector<DrawRecord> m_draws;
+	DrawRecord* m_draw;
+	uint64 m_draw_id;
+	uint64 m_draw_frame;
+	uint64 m_draw_tsc;
+	std::chrono::steady_clock::time_point m_draw_clock;
+	std::mutex m_draw_lock;
 
 	friend class GSPerfMonAutoTimer;
 
@@ -55,13 +81,34 @@ public:
 	void SetFrame(uint64 frame) {m_frame = frame;}
 	uint64 GetFrame() {return m_frame;}
 
+	// Counters are compiled out with DISABLE_PERF_MON, unless enabled here (the replay benchmark)
+	void EnableCounters() {m_counting = true;}
+
 	void Put(counter_t c, double val = 0);
 	double Get(counter_t c) {return m_stats[c];}
+	double GetTotal(counter_t c) {return m_totals[c] + m_counters[c];}
 	void Update();
 
 	void Start(int timer = Main);
 	void Stop(int timer = Main);
 	int CPU(int timer = Main, bool reset = true);
+
+	// Per draw records, kept in a ring of the last 'count' draws (0 disables them)
+
+	void EnableDraws(size_t count);
+	bool IsRecordingDraws() const {return !m_draws.empty();}
+
+	uint64 BeginDraw(int primclass, uint32 vertices, uint32 indices);
+	void SetupDone();
+	void TextureLookup(bool hit);
+	void DrawPixels(uint64 pixels);
+	void EndDraw();
+	uint64 GetDrawId() const {return m_draw ? m_draw->id : 0;}
+
+	void AddRaster(uint64 id, uint64 begin, uint64 end, uint64 pixels);
+
+	// Chrome trace event format (chrome://tracing, perfetto), one slice per frame and draw
+	bool ExportDraws(const std::string& fn);
 };
 
 class GSPerfMonAutoTimer
@@ -220,8 +220,10 @@ void GSState::SetFrameSkip(int skip)
 		m_fpGIFRegHandlers[GIF_A_D_REG_XYZF3] = &GSState::GIFRegHandlerNOP;
 		m_fpGIFRegHandlers[GIF_A_D_REG_XYZ3] = &GSState::GIFRegHandlerNOP;
 
-		m_fpGIFPackedRegHandlersC[GIF_REG_STQRGBAXYZF2] = &GSState::GIFPackedRegHandlerNOP;
-		m_fpGIFPackedRegHandlersC[GIF_REG_STQRGBAXYZ2] = &GSState::GIFPackedRegHandlerNOP;
+		for(size_t i = 0; i < countof(m_fpGIFPackedRegHandlersC); i++)
+		{
+			m_fpGIFPackedRegHandlersC[i] = &GSState::GIFPackedRegHandlerNOP;
+		}
 	}
 	else
 	{
@@ -299,8 +301,18 @@ void GSState::ResetHandlers()
 		m_fpGIFRegHandlerXYZ[P][1] = &GSState::GIFRegHandlerXYZF2<P, 1, auto_flush>; \
 		m_fpGIFRegHandlerXYZ[P][2] = &GSState::GIFRegHandlerXYZ2<P, 0, auto_flush>; \
 		m_fpGIFRegHandlerXYZ[P][3] = &GSState::GIFRegHandlerXYZ2<P, 1, auto_flush>; \
-		m_fpGIFPackedRegHandlerSTQRGBAXYZF2[P] = &GSState::GIFPackedRegHandlerSTQRGBAXYZF2<P, auto_flush>; \
-		m_fpGIFPackedRegHandlerSTQRGBAXYZ2[P] = &GSState::GIFPackedRegHandlerSTQRGBAXYZ2<P, auto_flush>; \
+		m_fpGIFPackedRegHandlerC[P][GIF_REG_STQRGBAXYZF2] = &GSState::GIFPackedRegHandlerSTQRGBAXYZF2<P, auto_flush>; \
+		m_fpGIFPackedRegHandlerC[P][GIF_REG_STQRGBAXYZ2] = &GSState::GIFPackedRegHandlerSTQRGBAXYZ2<P, auto_flush>; \
+		m_fpGIFPackedRegHandlerC[P][GIF_REG_UVRGBAXYZF2] = &GSState::GIFPackedRegHandlerVertexRun<P, auto_flush, GIF_REG_UVRGBAXYZF2>; \
+		m_fpGIFPackedRegHandlerC[P][GIF_REG_UVRGBAXYZ2] = &GSState::GIFPackedRegHandlerVertexRun<P, auto_flush, GIF_REG_UVRGBAXYZ2>; \
+		m_fpGIFPackedRegHandlerC[P][GIF_REG_RGBAXYZF2] = &GSState::GIFPackedRegHandlerVertexRun<P, auto_flush, GIF_REG_RGBAXYZF2>; \
+		m_fpGIFPackedRegHandlerC[P][GIF_REG_RGBAXYZ2] = &GSState::GIFPackedRegHandlerVertexRun<P, auto_flush, GIF_REG_RGBAXYZ2>; \
+		m_fpGIFPackedRegHandlerC[P][GIF_REGLIST_STRGBAQXYZF2] = &GSState::GIFRegListHandlerVertexRun<P, auto_flush, GIF_REGLIST_STRGBAQXYZF2>; \
+		m_fpGIFPackedRegHandlerC[P][GIF_REGLIST_STRGBAQXYZ2] = &GSState::GIFRegListHandlerVertexRun<P, auto_flush, GIF_REGLIST_STRGBAQXYZ2>; \
+		m_fpGIFPackedRegHandlerC[P][GIF_REGLIST_UVRGBAQXYZF2] = &GSState::GIFRegListHandlerVertexRun<P, auto_flush, GIF_REGLIST_UVRGBAQXYZF2>; \
+		m_fpGIFPackedRegHandlerC[P][GIF_REGLIST_UVRGBAQXYZ2] = &GSState::GIFRegListHandlerVertexRun<P, auto_flush, GIF_REGLIST_UVRGBAQXYZ2>; \
+		m_fpGIFPackedRegHandlerC[P][GIF_REGLIST_RGBAQXYZF2] = &GSState::GIFRegListHandlerVertexRun<P, auto_flush, GIF_REGLIST_RGBAQXYZF2>; \
+		m_fpGIFPackedRegHandlerC[P][GIF_REGLIST_RGBAQXYZ2] = &GSState::GIFRegListHandlerVertexRun<P, auto_flush, GIF_REGLIST_RGBAQXYZ2>; \
 
 	if (m_userhacks_auto_flush) {
 		SetHandlerXYZ(GS_POINTLIST, true);
@@ -694,6 +706,8 @@ void GSState::GIFPackedRegHandlerSTQRGBAXYZF2(const GIFPackedReg* RESTRICT r, ui
 {
 	ASSERT(size > 0 && size % 3 == 0);
 
+	ReserveVertices(size / 3);
+
 	const GIFPackedReg* RESTRICT r_end = r + size;
 
 	while(r < r_end)
@@ -731,6 +745,8 @@ void GSState::GIFPackedRegHandlerSTQRGBAXYZ2(const GIFPackedReg* RESTRICT r, uin
 {
 	ASSERT(size > 0 && size % 3 == 0);
 
+	ReserveVertices(size / 3);
+
 	const GIFPackedReg* RESTRICT r_end = r + size;
 
 	while(r < r_end)
@@ -762,6 +778,106 @@ void GSState::GIFPackedRegHandlerSTQRGBAXYZ2(const GIFPackedReg* RESTRICT r, uin
 	m_q = r[-3].STQ.Q; // remember the last one, STQ outputs this to the temp Q each time
 }
 
+template<uint32 prim, bool auto_flush, uint32 layout>
+void GSState::GIFPackedRegHandlerVertexRun(const GIFPackedReg* RESTRICT r, uint32 size)
+{
+	// [UV] RGBA XYZF2/XYZ2, same as the separate handlers without the dispatch per register
+
+	const bool uv = layout == GIF_REG_UVRGBAXYZF2 || layout == GIF_REG_UVRGBAXYZ2;
+	const bool fog = layout == GIF_REG_UVRGBAXYZF2 || layout == GIF_REG_RGBAXYZF2;
+	const uint32 nreg = uv ? 3 : 2;
+
+	ASSERT(size > 0 && size % nreg == 0);
+
+	ReserveVertices(size / nreg);
+
+	if(uv && m_userhacks_wildhack)
+	{
+		m_isPackedUV_HackFlag = true; // see GIFPackedRegHandlerUV_Hack
+	}
+
+	const GIFPackedReg* RESTRICT r_end = r + size;
+
+	// nothing in the loop writes ST or Q, RGBA takes the last Q output by STQ
+
+	GSVector4i st = GSVector4i::loadl(&m_v.ST);
+	GSVector4i q = GSVector4i::cast(GSVector4(m_q));
+
+	while(r < r_end)
+	{
+		if(uv)
+		{
+			GSVector4i v = GSVector4i::loadl(r) & GSVector4i::x00003fff();
+
+			m_v.UV = (uint32)GSVector4i::store(v.ps32(v));
+
+			r++;
+		}
+
+		GSVector4i rgba = (GSVector4i::load<false>(&r[0]) & GSVector4i::x000000ff()).ps32().pu16();
+
+		m_v.m[0] = st.upl64(rgba.upl32(q));
+
+		GSVector4i xy = GSVector4i::loadl(&r[1].u64[0]);
+
+		if(fog)
+		{
+			GSVector4i zf = GSVector4i::loadl(&r[1].u64[1]);
+			xy = xy.upl16(xy.srl<4>()).upl32(GSVector4i::load((int)m_v.UV));
+			zf = zf.srl32(4) & GSVector4i::x00ffffff().upl32(GSVector4i::x000000ff());
+
+			m_v.m[1] = xy.upl32(zf);
+
+			VertexKick<prim, auto_flush>(r[1].XYZF2.Skip());
+		}
+		else
+		{
+			GSVector4i z = GSVector4i::loadl(&r[1].u64[1]);
+			GSVector4i xyz = xy.upl16(xy.srl<4>()).upl32(z);
+
+			m_v.m[1] = xyz.upl64(GSVector4i::loadl(&m_v.UV));
+
+			VertexKick<prim, auto_flush>(r[1].XYZ2.Skip());
+		}
+
+		r += 2;
+	}
+}
+
+template<uint32 prim, bool auto_flush, uint32 layout>
+void GSState::GIFRegListHandlerVertexRun(const GIFPackedReg* RESTRICT packed, uint32 size)
+{
+	// [ST|UV] RGBAQ XYZF2/XYZ2 as 64-bit registers, size is the number of registers
+
+	const bool st = layout == GIF_REGLIST_STRGBAQXYZF2 || layout == GIF_REGLIST_STRGBAQXYZ2;
+	const bool uv = layout == GIF_REGLIST_UVRGBAQXYZF2 || layout == GIF_REGLIST_UVRGBAQXYZ2;
+	const bool fog = layout == GIF_REGLIST_STRGBAQXYZF2 || layout == GIF_REGLIST_UVRGBAQXYZF2 || layout == GIF_REGLIST_RGBAQXYZF2;
+	const uint32 nreg = st || uv ? 3 : 2;
+
+	ASSERT(size > 0 && size % nreg == 0);
+
+	ReserveVertices(size / nreg);
+
+	if(uv && m_userhacks_wildhack)
+	{
+		m_isPackedUV_HackFlag = false; // see GIFRegHandlerUV_Hack
+	}
+
+	const GIFReg* RESTRICT r = (const GIFReg*)packed;
+	const GIFReg* RESTRICT r_end = r + size;
+
+	while(r < r_end)
+	{
+		if(st) GIFRegHandlerST(r++);
+		if(uv) GIFRegHandlerUV(r++);
+
+		GIFRegHandlerRGBAQ(r++);
+
+		if(fog) GIFRegHandlerXYZF2<prim, 0, auto_flush>(r++);
+		else GIFRegHandlerXYZ2<prim, 0, auto_flush>(r++);
+	}
+}
+
 void GSState::GIFPackedRegHandlerNOP(const GIFPackedReg* RESTRICT r, uint32 size)
 {
 }
@@ -1644,6 +1760,8 @@ void GSState::FlushPrim()
 
 			m_context->SaveReg();
 
+			m_perfmon.BeginDraw(m_vt.m_primclass, m_vertex.next, m_index.tail);
+
 			try {
 				Draw();
 			} catch (GSDXRecoverableError&) {
@@ -1654,6 +1772,8 @@ void GSState::FlushPrim()
 				fprintf(stderr, "GSDX OUT OF MEMORY\n");
 			}
 
+			m_perfmon.EndDraw();
+
 			m_context->RestoreReg();
 
 			m_perfmon.Put(GSPerfMon::Draw, 1);
@@ -2187,25 +2307,13 @@ template<int index> void GSState::Transfer(const uint8* mem, uint32 size)
 
 						break;
 					
-					case GIFPath::TYPE_STQRGBAXYZF2: // majority of the vertices are formatted like this
+					default: // TYPE_COMPLEX + GIF_REG_COMPLEX, the majority of the vertices are formatted like this (STQ RGBA XYZF2)
 
-						(this->*m_fpGIFPackedRegHandlersC[GIF_REG_STQRGBAXYZF2])((GIFPackedReg*)mem, total);
+						(this->*m_fpGIFPackedRegHandlersC[path.type - GIFPath::TYPE_COMPLEX])((GIFPackedReg*)mem, total);
 
 						mem += total * sizeof(GIFPackedReg);
 
 						break;
-
-					case GIFPath::TYPE_STQRGBAXYZ2:
-
-						(this->*m_fpGIFPackedRegHandlersC[GIF_REG_STQRGBAXYZ2])((GIFPackedReg*)mem, total);
-
-						mem += total * sizeof(GIFPackedReg);
-
-						break;
-
-					default:
-
-						__assume(0);
 					}
 
 					path.nloop = 0;
@@ -2226,7 +2334,24 @@ template<int index> void GSState::Transfer(const uint8* mem, uint32 size)
 
 			case GIF_FLG_REGLIST:
 
-				// TODO: do it similar to packed operation
+				// known vertex layouts are done similar to packed operation, when all data is available
+
+				if(path.type >= GIFPath::TYPE_COMPLEX && path.reg == 0)
+				{
+					total = path.nloop * path.nreg; // 64-bit registers, the last qword is padded when odd
+
+					if(size * 2 >= total)
+					{
+						(this->*m_fpGIFPackedRegHandlersC[path.type - GIFPath::TYPE_COMPLEX])((GIFPackedReg*)mem, total);
+
+						mem += (total + 1) / 2 * sizeof(GIFPackedReg);
+						size -= (total + 1) / 2;
+
+						path.nloop = 0;
+
+						break;
+					}
+				}
 
 				size *= 2;
 
@@ -2601,13 +2726,14 @@ void GSState::UpdateVertexKick()
 	m_fpGIFRegHandlers[GIF_A_D_REG_XYZ2] = m_fpGIFRegHandlerXYZ[prim][2];
 	m_fpGIFRegHandlers[GIF_A_D_REG_XYZ3] = m_fpGIFRegHandlerXYZ[prim][3];
 
-	m_fpGIFPackedRegHandlersC[GIF_REG_STQRGBAXYZF2] = m_fpGIFPackedRegHandlerSTQRGBAXYZF2[prim];
-	m_fpGIFPackedRegHandlersC[GIF_REG_STQRGBAXYZ2] = m_fpGIFPackedRegHandlerSTQRGBAXYZ2[prim];
+	memcpy(m_fpGIFPackedRegHandlersC, m_fpGIFPackedRegHandlerC[prim], sizeof(m_fpGIFPackedRegHandlersC));
 }
 
-void GSState::GrowVertexBuffer()
+void GSState::GrowVertexBuffer(size_t reserve)
 {
-	int maxcount = std::max<int>(m_vertex.maxcount * 3 / 2, 10000);
+	// reserve: room for that many more vertices, so a long run grows the buffers once instead of copying them several times
+
+	int maxcount = std::max<int>(std::max<size_t>(m_vertex.maxcount * 3 / 2, m_vertex.tail + reserve + 4), 10000);
 
 	GSVertex* vertex = (GSVertex*)_aligned_malloc(sizeof(GSVertex) * maxcount, 32);
 	uint32* index = (uint32*)_aligned_malloc(sizeof(uint32) * maxcount * 3, 32); // worst case is slightly less than vertex number * 3
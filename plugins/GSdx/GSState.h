@@ -75,12 +75,13 @@ class GSState : public GSAlignedClass<32>
 
 	typedef void (GSState::*GIFPackedRegHandlerC)(const GIFPackedReg* RESTRICT r, uint32 size);
 
-	GIFPackedRegHandlerC m_fpGIFPackedRegHandlersC[2];
-	GIFPackedRegHandlerC m_fpGIFPackedRegHandlerSTQRGBAXYZF2[8];
-	GIFPackedRegHandlerC m_fpGIFPackedRegHandlerSTQRGBAXYZ2[8];
+	GIFPackedRegHandlerC m_fpGIFPackedRegHandlersC[GIF_REG_COMPLEX_LAST];
+	GIFPackedRegHandlerC m_fpGIFPackedRegHandlerC[8][GIF_REG_COMPLEX_LAST];
 
 	template<uint32 prim, bool auto_flush> void GIFPackedRegHandlerSTQRGBAXYZF2(const GIFPackedReg* RESTRICT r, uint32 size);
 	template<uint32 prim, bool auto_flush> void GIFPackedRegHandlerSTQRGBAXYZ2(const GIFPackedReg* RESTRICT r, uint32 size);
+	template<uint32 prim, bool auto_flush, uint32 layout> void GIFPackedRegHandlerVertexRun(const GIFPackedReg* RESTRICT r, uint32 size);
+	template<uint32 prim, bool auto_flush, uint32 layout> void GIFRegListHandlerVertexRun(const GIFPackedReg* RESTRICT r, uint32 size);
 	void GIFPackedRegHandlerNOP(const GIFPackedReg* RESTRICT r, uint32 size);
 
 	template<int i> void ApplyTEX0(GIFRegTEX0& TEX0);
@@ -193,7 +194,15 @@ protected:
 
 	void UpdateVertexKick();
 
-	void GrowVertexBuffer();
+	void GrowVertexBuffer(size_t reserve = 0);
+
+	__forceinline void ReserveVertices(size_t count)
+	{
+		if(m_vertex.tail + count >= m_vertex.maxcount)
+		{
+			GrowVertexBuffer(count);
+		}
+	}
 
 	template<uint32 prim, bool auto_flush>
 	void VertexKick(uint32 skip);
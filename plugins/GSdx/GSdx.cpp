@@ -318,6 +318,8 @@ void GSdxApp::Init()
 	m_default_configuration["accurate_blending_unit_d3d11"]               = "1";
 #else
 	m_default_configuration["linux_replay"]                               = "1";
+	m_default_configuration["linux_replay_start_frame"]                   = "0";
+	m_default_configuration["linux_replay_stream"]                        = "0";
 #endif
 	m_default_configuration["aa1"]                                        = "0";
 	m_default_configuration["accurate_date"]                              = "1";
@@ -337,6 +339,10 @@ void GSdxApp::Init()
 	m_default_configuration["disable_hw_gl_draw"]                         = "0";
 	m_default_configuration["dithering_ps2"]                              = "2";
 	m_default_configuration["dump"]                                       = "0";
+	m_default_configuration["dump_buffer"]                                = "64";
+	m_default_configuration["dump_index"]                                 = "0";
+	m_default_configuration["dump_keyframes"]                             = "0";
+	m_default_configuration["dump_threads"]                               = "0";
 	m_default_configuration["extrathreads"]                               = "2";
 	m_default_configuration["extrathreads_height"]                        = "4";
 	m_default_configuration["filter"]                                     = std::to_string(static_cast<int8>(BiFiltering::PS2));
@@ -383,6 +389,8 @@ void GSdxApp::Init()
 	m_default_configuration["override_GL_ARB_vertex_attrib_binding"]      = "-1";
 	m_default_configuration["override_GL_ARB_texture_barrier"]            = "-1";
 	m_default_configuration["paltex"]                                     = "0";
+	m_default_configuration["perfmon_draws"]                              = "0";
+	m_default_configuration["perfmon_trace"]                              = "gsdx_draws.json";
 	m_default_configuration["png_compression_level"]                      = std::to_string(Z_BEST_SPEED);
 	m_default_configuration["preload_frame_with_gs_data"]                 = "0";
 	m_default_configuration["Renderer"]                                   = std::to_string(static_cast<int>(GSRendererType::Default));
@@ -401,6 +409,7 @@ void GSdxApp::Init()
 	m_default_configuration["shaderfx"]                                   = "0";
 	m_default_configuration["shaderfx_conf"]                              = "shaders/GSdx_FX_Settings.ini";
 	m_default_configuration["shaderfx_glsl"]                              = "shaders/GSdx.fx";
+	m_default_configuration["texture_hash"]                               = "0";
 	m_default_configuration["TVShader"]                                   = "0";
 	m_default_configuration["upscale_multiplier"]                         = "1";
 	m_default_configuration["UserHacks"]                                  = "0";
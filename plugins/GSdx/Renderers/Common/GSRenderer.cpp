@@ -50,10 +50,22 @@ GSRenderer::GSRenderer()
 	m_shaderfx    = theApp.GetConfigB("shaderfx");
 	m_shadeboost  = theApp.GetConfigB("ShadeBoost");
 	m_dithering   = theApp.GetConfigI("dithering_ps2"); // 0 off, 1 auto, 2 auto no scale
+
+	m_perfmon.EnableDraws(std::max(theApp.GetConfigI("perfmon_draws"), 0));
 }
 
 GSRenderer::~GSRenderer()
 {
+	if(m_perfmon.IsRecordingDraws())
+	{
+		std::string fn = theApp.GetConfigS("perfmon_trace");
+
+		if(m_perfmon.ExportDraws(fn))
+		{
+			fprintf(stderr, "GSdx: draw trace saved to %s\n", fn.c_str());
+		}
+	}
+
 	/*if(m_dev)
 	{
 		m_dev->Reset(1, 1, GSDevice::Windowed);
@@ -373,6 +385,13 @@ void GSRenderer::VSync(int field)
 				m_perfmon.Get(GSPerfMon::Unswizzle) / 1024
 			);
 
+			double skipped = m_perfmon.Get(GSPerfMon::UnswizzleSkip);
+
+			if(skipped > 0)
+			{
+				s += format(" | %.2f skip", skipped / 1024);
+			}
+
 			double fillrate = m_perfmon.Get(GSPerfMon::Fillrate);
 
 			if(fillrate > 0)
@@ -470,7 +489,20 @@ void GSRenderer::VSync(int field)
 	else if(m_dump)
 	{
 		if(m_dump->VSync(field, !m_control_key, m_regs))
+		{
 			m_dump.reset();
+		}
+		else if(m_dump->NeedKeyframe())
+		{
+			GSFreezeData fd = {0, nullptr};
+			Freeze(&fd, true);
+			fd.data = new uint8[fd.size];
+			Freeze(&fd, false);
+
+			m_dump->Keyframe(fd);
+
+			delete [] fd.data;
+		}
 	}
 #ifndef __LIBRETRO__
 	// capture
@@ -1510,6 +1510,10 @@ void GSRendererHW::Draw()
 
 	//
 
+	// The GPU fill isn't visible from here, the bounding box gives an upper bound
+	m_perfmon.DrawPixels((uint64)std::max(m_r.width(), 0) * std::max(m_r.height(), 0));
+	m_perfmon.SetupDone();
+
 	DrawPrims(rt_tex, ds_tex, m_src);
 
 	//
@@ -1712,6 +1716,7 @@ void GSRendererHW::OI_GsMemClear()
 			return;
 
 		GL_INS("OI_GsMemClear (%d,%d => %d,%d)", r.x, r.y, r.z, r.w);
+		m_tc->LocalMemWritten();
 		int format = GSLocalMemory::m_psm[m_context->FRAME.PSM].fmt;
 
 		// FIXME: loop can likely be optimized with AVX/SSE. Pixels aren't
@@ -1813,6 +1818,7 @@ bool GSRendererHW::OI_BlitFMV(GSTextureCache::Target* _rt, GSTextureCache::Sourc
 		// Copy back the texture into the GS mem. I don't know why but it will be
 		// reuploaded again later
 		m_tc->Read(tex, r_texture);
+		m_tc->LocalMemWritten();
 
 		m_tc->InvalidateVideoMemSubTarget(_rt);
 
@@ -2108,6 +2114,7 @@ bool GSRendererHW::OI_PointListPalette(GSTexture* rt, GSTexture* ds, GSTextureCa
 				}
 
 				m_mem.m_clut.Invalidate();
+				m_tc->LocalMemWritten();
 
 				return false;
 			}
@@ -2128,6 +2135,7 @@ bool GSRendererHW::OI_PointListPalette(GSTexture* rt, GSTexture* ds, GSTextureCa
 				}
 
 				m_mem.m_clut.Invalidate();
+				m_tc->LocalMemWritten();
 
 				return false;
 			}
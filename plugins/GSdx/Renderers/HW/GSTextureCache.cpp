@@ -27,9 +27,39 @@
 bool GSTextureCache::m_disable_partial_invalidation = false;
 bool GSTextureCache::m_wrap_gs_mem = false;
 
+// xxHash64 like hash of a GS memory page (8KB)
+static uint64 HashPage(const GSLocalMemory& mem, uint32 page)
+{
+	const uint64 P1 = 0x9E3779B185EBCA87ull;
+	const uint64 P2 = 0xC2B2AE3D27D4EB4Full;
+
+	const uint64* RESTRICT p = (const uint64*)&mem.m_vm8[(page % MAX_PAGES) << 13];
+
+	uint64 h[4] = {P1 + P2, P2, 0, 0 - P1};
+
+	for(int i = 0; i < 8192 / 8; i += 4)
+	{
+		for(int j = 0; j < 4; j++)
+		{
+			h[j] += p[i + j] * P2;
+			h[j] = (h[j] << 31) | (h[j] >> 33);
+			h[j] *= P1;
+		}
+	}
+
+	uint64 res = ((h[0] << 1) | (h[0] >> 63)) + ((h[1] << 7) | (h[1] >> 57)) + ((h[2] << 12) | (h[2] >> 52)) + ((h[3] << 18) | (h[3] >> 46));
+
+	res ^= res >> 33;
+	res *= P2;
+	res ^= res >> 29;
+
+	return res;
+}
+
 GSTextureCache::GSTextureCache(GSRenderer* r)
 	: m_renderer(r)
 	, m_palette_map(r)
+	, m_hash_cache(r)
 {
 	if (theApp.GetConfigB("UserHacks")) {
 		UserHacks_HalfPixelOffset      = theApp.GetConfigI("UserHacks_HalfPixelOffset") == 1;
@@ -50,6 +80,9 @@ GSTextureCache::GSTextureCache(GSRenderer* r)
 	}
 
 	m_paltex = theApp.GetConfigB("paltex");
+	m_texture_hash = theApp.GetConfigB("texture_hash");
+	if (m_texture_hash)
+		m_src.m_hash_cache = &m_hash_cache;
 	m_crc_hack_level = theApp.GetConfigT<CRCHackLevel>("crc_hack_level");
 	if (m_crc_hack_level == CRCHackLevel::Automatic)
 		m_crc_hack_level = GSUtil::GetRecommendedCRCHackLevel(theApp.GetCurrentRendererType());
@@ -81,11 +114,14 @@ void GSTextureCache::RemovePartial()
 
 		m_dst[type].clear();
 	}
+
+	m_dst_index.Clear();
 }
 
 void GSTextureCache::RemoveAll()
 {
 	m_src.RemoveAll();
+	m_hash_cache.RemoveAll();
 
 	for(int type = 0; type < 2; type++)
 	{
@@ -94,6 +130,8 @@ void GSTextureCache::RemoveAll()
 		m_dst[type].clear();
 	}
 
+	m_dst_index.Clear();
+
 	m_palette_map.Clear();
 }
 
@@ -455,6 +493,8 @@ GSTextureCache::Source* GSTextureCache::LookupSource(const GIFRegTEX0& TEX0, con
 		AttachPaletteToSource(src, psm_s.pal, true);
 	}
 
+	m_renderer->m_perfmon.TextureLookup(!new_source);
+
 	src->Update(r);
 
 	m_src.m_used = true;
@@ -502,19 +542,21 @@ GSTextureCache::Target* GSTextureCache::LookupTarget(const GIFRegTEX0& TEX0, int
 	Target* dst = NULL;
 
 	auto& list = m_dst[type];
-	for(auto i = list.begin(); i != list.end(); ++i) {
-		Target* t = *i;
+	if(m_dst_index.Has(type, bp)) {
+		for(auto i = list.begin(); i != list.end(); ++i) {
+			Target* t = *i;
 
-		if(bp == t->m_TEX0.TBP0)
-		{
-			list.MoveFront(i.Index());
+			if(bp == t->m_TEX0.TBP0)
+			{
+				list.MoveFront(i.Index());
 
-			dst = t;
+				dst = t;
 
-			dst->m_32_bits_fmt |= (psm_s.bpp != 16);
-			dst->m_TEX0 = TEX0;
+				dst->m_32_bits_fmt |= (psm_s.bpp != 16);
+				dst->m_TEX0 = TEX0;
 
-			break;
+				break;
+			}
 		}
 	}
 
@@ -532,13 +574,15 @@ GSTextureCache::Target* GSTextureCache::LookupTarget(const GIFRegTEX0& TEX0, int
 		// Depth stencil/RT can be an older RT/DS but only check recent RT/DS to avoid to pick
 		// some bad data.
 		Target* dst_match = nullptr;
-		for(auto t : m_dst[rev_type]) {
-			if (bp == t->m_TEX0.TBP0) {
-				if (t->m_age == 0) {
-					dst_match = t;
-					break;
-				} else if (t->m_age == 1) {
-					dst_match = t;
+		if (m_dst_index.Has(rev_type, bp)) {
+			for(auto t : m_dst[rev_type]) {
+				if (bp == t->m_TEX0.TBP0) {
+					if (t->m_age == 0) {
+						dst_match = t;
+						break;
+					} else if (t->m_age == 1) {
+						dst_match = t;
+					}
 				}
 			}
 		}
@@ -722,7 +766,7 @@ GSTextureCache::Target* GSTextureCache::LookupTarget(const GIFRegTEX0& TEX0, int
 // must invalidate the Target/Depth respectively
 void GSTextureCache::InvalidateVideoMemType(int type, uint32 bp)
 {
-	if (!m_can_convert_depth)
+	if (!m_can_convert_depth || !m_dst_index.Has(type, bp))
 		return;
 
 	auto& list = m_dst[type];
@@ -830,6 +874,10 @@ void GSTextureCache::InvalidateVideoMem(GSOffset* off, const GSVector4i& rect, b
 		uint32 page = *p;
 
 		auto& list = m_src.m_map[page];
+
+		// Content of the page before the transfer, the memory is written after the invalidation
+		uint64 hash = m_texture_hash && !list.empty() ? HashPage(m_renderer->m_mem, page) : 0;
+
 		for(auto i = list.begin(); i != list.end(); )
 		{
 			Source* s = *i;
@@ -849,6 +897,11 @@ void GSTextureCache::InvalidateVideoMem(GSOffset* off, const GSVector4i& rect, b
 					{
 						uint32* RESTRICT valid = s->m_valid;
 
+						if(m_texture_hash)
+						{
+							s->Invalidate(page, hash);
+						}
+
 						// Invalidate data of input texture
 						if(s->m_repeating)
 						{
@@ -887,6 +940,28 @@ void GSTextureCache::InvalidateVideoMem(GSOffset* off, const GSVector4i& rect, b
 
 	if(!target) return;
 
+	// A target is only touched when the transfer covers its TBP0 (same bp or "dirty after"),
+	// or starts inside it ("dirty in the middle"). Skip the scan when the index proves that
+	// no target spans over the pages of the transfer. The last page is an upper bound,
+	// transfers wrapping around the memory are not filtered.
+	{
+		const GSLocalMemory::psm_t& psm_s = GSLocalMemory::m_psm[psm];
+
+		int right = std::max(r.right, rect.right);
+		int bottom = std::max(r.bottom, rect.bottom);
+
+		if(right > 0 && bottom > 0)
+		{
+			uint32 first = bp >> 5;
+			uint32 last = first + (bottom - 1) / psm_s.pgs.y * bw + (right - 1) / psm_s.pgs.x;
+
+			if(last < MAX_PAGES && !m_dst_index.Overlaps(first, last))
+			{
+				return;
+			}
+		}
+	}
+
 	for(int type = 0; type < 2; type++)
 	{
 		auto& list = m_dst[type];
@@ -987,6 +1062,9 @@ void GSTextureCache::InvalidateVideoMem(GSOffset* off, const GSVector4i& rect, b
 // Called each time you want to read from the GS memory
 void GSTextureCache::InvalidateLocalMem(GSOffset* off, const GSVector4i& r)
 {
+	// The targets are read back into local memory below the sources
+	LocalMemWritten();
+
 	uint32 bp = off->bp;
 	uint32 psm = off->psm;
 	//uint32 bw = off->bw;
@@ -994,7 +1072,7 @@ void GSTextureCache::InvalidateLocalMem(GSOffset* off, const GSVector4i& r)
 	// No depth handling please.
 	if (psm == PSM_PSMZ32 || psm == PSM_PSMZ24 || psm == PSM_PSMZ16 || psm == PSM_PSMZ16S) {
 		GL_INS("ERROR: InvalidateLocalMem depth format isn't supported (%d,%d to %d,%d)", r.x, r.y, r.z, r.w);
-		if (m_can_convert_depth) {
+		if (m_can_convert_depth && m_dst_index.Has(DepthStencil, bp)) {
 			for(auto t : m_dst[DepthStencil]) {
 				if(GSUtil::HasSharedBits(bp, psm, t->m_TEX0.TBP0, t->m_TEX0.PSM)) {
 					if (GSUtil::HasCompatibleBits(psm, t->m_TEX0.PSM))
@@ -1009,6 +1087,9 @@ void GSTextureCache::InvalidateLocalMem(GSOffset* off, const GSVector4i& r)
 	// It works for all the games mentioned below and fixes a couple of other ones as well
 	// (Busen0: Wizardry and Chaos Legion).
 	// Also in a few games the below code ran the Grandia3 case when it shouldn't :p
+	if(!m_dst_index.Has(RenderTarget, bp))
+		return;
+
 	for(auto t : m_dst[RenderTarget])
 	{
 		if (t->m_TEX0.PSM != PSM_PSMZ32 && t->m_TEX0.PSM != PSM_PSMZ24 && t->m_TEX0.PSM != PSM_PSMZ16 && t->m_TEX0.PSM != PSM_PSMZ16S)
@@ -1160,6 +1241,8 @@ void GSTextureCache::IncAge()
 
 	m_src.m_used = false;
 
+	m_hash_cache.IncAge();
+
 	// Clearing of Rendertargets causes flickering in many scene transitions.
 	// Sigh, this seems to be used to invalidate surfaces. So set a huge maxage to avoid flicker,
 	// but still invalidate surfaces. (Disgaea 2 fmv when booting the game through the BIOS)
@@ -1195,6 +1278,8 @@ void GSTextureCache::IncAge()
 			}
 		}
 	}
+
+	RebuildTargetIndex();
 }
 
 //Fixme: Several issues in here. Not handling depth stencil, pitch conversion doesnt work.
@@ -1203,6 +1288,8 @@ GSTextureCache::Source* GSTextureCache::CreateSource(const GIFRegTEX0& TEX0, con
 	const GSLocalMemory::psm_t& psm = GSLocalMemory::m_psm[TEX0.PSM];
 	Source* src = new Source(m_renderer, TEX0, TEXA, m_temp);
 
+	src->m_hash_generation = m_hash_cache.m_generation;
+
 	int tw = 1 << TEX0.TW;
 	int th = 1 << TEX0.TH;
 	//int tp = TEX0.TBW << 6;
@@ -1513,16 +1600,19 @@ GSTextureCache::Source* GSTextureCache::CreateSource(const GIFRegTEX0& TEX0, con
 	}
 	else
 	{
+		// The palette is part of the key of the hash cache, attach it first
 		if (m_paltex && psm.pal > 0)
 		{
-			src->m_texture = m_renderer->m_dev->CreateTexture(tw, th, Get8bitFormat());
 			AttachPaletteToSource(src, psm.pal, true);
+			if (!(m_texture_hash && m_hash_cache.Lookup(src)))
+				src->m_texture = m_renderer->m_dev->CreateTexture(tw, th, Get8bitFormat());
 		}
 		else {
-			src->m_texture = m_renderer->m_dev->CreateTexture(tw, th);
 			if (psm.pal > 0) {
 				AttachPaletteToSource(src, psm.pal, false);
 			}
+			if (!(m_texture_hash && m_hash_cache.Lookup(src)))
+				src->m_texture = m_renderer->m_dev->CreateTexture(tw, th);
 		}
 	}
 
@@ -1537,7 +1627,7 @@ GSTextureCache::Target* GSTextureCache::CreateTarget(const GIFRegTEX0& TEX0, int
 {
 	ASSERT(type == RenderTarget || type == DepthStencil);
 
-	Target* t = new Target(m_renderer, TEX0, m_temp, m_can_convert_depth);
+	Target* t = new Target(m_renderer, TEX0, m_temp, m_can_convert_depth, &m_dst_index);
 
 	// FIXME: initial data should be unswizzled from local mem in Update() if dirty
 
@@ -1556,9 +1646,24 @@ GSTextureCache::Target* GSTextureCache::CreateTarget(const GIFRegTEX0& TEX0, int
 
 	m_dst[type].push_front(t);
 
+	m_dst_index.Add(t);
+
 	return t;
 }
 
+void GSTextureCache::RebuildTargetIndex()
+{
+	m_dst_index.Clear();
+
+	for(int type = 0; type < 2; type++)
+	{
+		for(auto t : m_dst[type])
+		{
+			m_dst_index.Add(t);
+		}
+	}
+}
+
 void GSTextureCache::PrintMemoryUsage()
 {
 #ifdef ENABLE_OGL_DEBUG
@@ -1641,6 +1746,8 @@ GSTextureCache::Source::Source(GSRenderer* r, const GIFRegTEX0& TEX0, const GIFR
 	, m_p2t(NULL)
 	, m_from_target(NULL)
 	, m_from_target_TEX0(TEX0)
+	, m_page_hash(NULL)
+	, m_hash_generation(0)
 {
 	m_TEX0 = TEX0;
 	m_TEXA = TEXA;
@@ -1676,6 +1783,8 @@ GSTextureCache::Source::Source(GSRenderer* r, const GIFRegTEX0& TEX0, const GIFR
 GSTextureCache::Source::~Source()
 {
 	_aligned_free(m_write.rect);
+
+	delete m_page_hash;
 }
 
 void GSTextureCache::Source::Update(const GSVector4i& rect, int layer)
@@ -1702,6 +1811,7 @@ void GSTextureCache::Source::Update(const GSVector4i& rect, int layer)
 	const GSOffset* off = m_renderer->m_context->offset.tex;
 
 	uint32 blocks = 0;
+	uint32 skipped = 0;
 
 	if(m_repeating)
 	{
@@ -1720,6 +1830,13 @@ void GSTextureCache::Source::Update(const GSVector4i& rect, int layer)
 					uint32 row = addr >> 5u;
 					uint32 col = 1 << (addr & 31u);
 
+					if((m_valid[row] & col) == 0 && m_page_hash)
+					{
+						Revalidate((block % MAX_BLOCKS) >> 5u);
+
+						skipped += (m_valid[row] & col) != 0;
+					}
+
 					if((m_valid[row] & col) == 0)
 					{
 						m_valid[row] |= col;
@@ -1749,6 +1866,13 @@ void GSTextureCache::Source::Update(const GSVector4i& rect, int layer)
 					uint32 row = block >> 5u;
 					uint32 col = 1 << (block & 31u);
 
+					if((m_valid[row] & col) == 0 && m_page_hash)
+					{
+						Revalidate(row);
+
+						skipped += (m_valid[row] & col) != 0;
+					}
+
 					if((m_valid[row] & col) == 0)
 					{
 						m_valid[row] |= col;
@@ -1768,6 +1892,91 @@ void GSTextureCache::Source::Update(const GSVector4i& rect, int layer)
 
 		Flush(m_write.count, layer);
 	}
+
+	if(skipped > 0)
+	{
+		m_renderer->m_perfmon.Put(GSPerfMon::UnswizzleSkip, bs.x * bs.y * skipped << (m_palette ? 2 : 0));
+	}
+}
+
+void GSTextureCache::Source::Invalidate(uint32 page, uint64 hash)
+{
+	// Blocks uploaded since the last invalidation of the page replace the older stale
+	// blocks, which may come from different content. Nothing uploaded: keep the older ones.
+
+	uint32 bit = 1u << (page & 31);
+
+	if(m_repeating)
+	{
+		uint32 removed = 0;
+
+		for(const GSVector2i& k : m_p2t[page])
+		{
+			removed |= m_valid[k.x] & ~k.y;
+		}
+
+		if(removed == 0)
+		{
+			return;
+		}
+
+		if(m_page_hash == NULL)
+		{
+			m_page_hash = new PageHash();
+		}
+
+		for(const GSVector2i& k : m_p2t[page])
+		{
+			m_page_hash->stale[k.x] = (m_page_hash->stale[k.x] & k.y) | (m_valid[k.x] & ~k.y);
+		}
+	}
+	else
+	{
+		if(m_valid[page] == 0)
+		{
+			return;
+		}
+
+		if(m_page_hash == NULL)
+		{
+			m_page_hash = new PageHash();
+		}
+
+		m_page_hash->stale[page] = m_valid[page];
+	}
+
+	m_page_hash->hash[page] = hash;
+	m_page_hash->pending[page >> 5] |= bit;
+}
+
+void GSTextureCache::Source::Revalidate(uint32 page)
+{
+	uint32 bit = 1u << (page & 31);
+
+	if((m_page_hash->pending[page >> 5] & bit) == 0)
+	{
+		return;
+	}
+
+	m_page_hash->pending[page >> 5] &= ~bit;
+
+	bool same = HashPage(m_renderer->m_mem, page) == m_page_hash->hash[page];
+
+	if(m_repeating)
+	{
+		for(const GSVector2i& k : m_p2t[page])
+		{
+			if(same) m_valid[k.x] |= m_page_hash->stale[k.x] & ~k.y;
+
+			m_page_hash->stale[k.x] &= k.y;
+		}
+	}
+	else
+	{
+		if(same) m_valid[page] |= m_page_hash->stale[page];
+
+		m_page_hash->stale[page] = 0;
+	}
 }
 
 void GSTextureCache::Source::UpdateLayer(const GIFRegTEX0& TEX0, const GSVector4i& rect, int layer)
@@ -1898,8 +2107,9 @@ bool GSTextureCache::Source::ClutMatch(PaletteKey palette_key) {
 
 // GSTextureCache::Target
 
-GSTextureCache::Target::Target(GSRenderer* r, const GIFRegTEX0& TEX0, uint8* temp, bool depth_supported)
+GSTextureCache::Target::Target(GSRenderer* r, const GIFRegTEX0& TEX0, uint8* temp, bool depth_supported, TargetIndex* index)
 	: Surface(r, temp)
+	, m_index(index)
 	, m_type(-1)
 	, m_used(false)
 	, m_depth_supported(depth_supported)
@@ -2011,9 +2221,56 @@ void GSTextureCache::Target::UpdateValidity(const GSVector4i& rect)
 	// Block of the bottom right texel of the validity rectangle, last valid block of the texture
 	m_end_block = GSLocalMemory::m_psm[m_TEX0.PSM].bn(m_valid.z - 1, m_valid.w - 1, m_TEX0.TBP0, m_TEX0.TBW);  // Valid only for color formats
 
+	m_index->Add(this);
+
 	// GL_CACHE("UpdateValidity (0x%x->0x%x) from R:%d,%d Valid: %d,%d", m_TEX0.TBP0, m_end_block, rect.z, rect.w, m_valid.z, m_valid.w);
 }
 
+// GSTextureCache::TargetIndex
+
+void GSTextureCache::TargetIndex::Clear()
+{
+	memset(m_tbp, 0, sizeof(m_tbp));
+	memset(m_pages, 0, sizeof(m_pages));
+}
+
+void GSTextureCache::TargetIndex::Add(const Target* t)
+{
+	uint32 first = t->m_TEX0.TBP0 >> 5;
+
+	// m_end_block wraps for targets at the end of the memory, they can only match on TBP0 then
+	uint32 last = std::max(t->m_TEX0.TBP0, t->m_end_block) >> 5;
+
+	if(first >= MAX_PAGES) return;
+
+	last = std::min<uint32>(last, MAX_PAGES - 1);
+
+	m_tbp[t->m_type][first >> 5] |= 1u << (first & 31);
+
+	for(uint32 page = first; page <= last; page++)
+	{
+		m_pages[page >> 5] |= 1u << (page & 31);
+	}
+}
+
+bool GSTextureCache::TargetIndex::Overlaps(uint32 first, uint32 last) const
+{
+	for(uint32 i = first >> 5; i <= last >> 5; i++)
+	{
+		uint32 mask = 0xffffffff;
+
+		if(i == first >> 5) mask &= 0xffffffff << (first & 31);
+		if(i == last >> 5) mask &= 0xffffffff >> (31 - (last & 31));
+
+		if(m_pages[i] & mask)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 // GSTextureCache::SourceMap
 
 void GSTextureCache::SourceMap::Add(Source* s, const GIFRegTEX0& TEX0, GSOffset* off)
@@ -2104,9 +2361,141 @@ void GSTextureCache::SourceMap::RemoveAt(Source* s)
 		}
 	}
 
+	if (m_hash_cache)
+		m_hash_cache->Add(s);
+
 	delete s;
 }
 
+// GSTextureCache::HashCache
+
+GSTextureCache::HashCache::Key GSTextureCache::HashCache::GetKey(const Source* s) const
+{
+	const GSLocalMemory::psm_t& psm = GSLocalMemory::m_psm[s->m_TEX0.PSM];
+
+	Key key;
+
+	key.hash = 0;
+	key.TEX0 = GetTEX0(s->m_TEX0);
+	key.TEXA = psm.pal == 0 && psm.fmt > 0 ? s->m_TEXA.u64 : 0;
+	key.clut = s->m_palette == NULL ? s->m_palette_obj.get() : NULL; // paltex textures hold the indices
+
+	for(size_t i = 0; i < MAX_PAGES / 32; i++)
+	{
+		unsigned long j;
+
+		for(uint32 p = s->m_pages_as_bit[i]; _BitScanForward(&j, p); p ^= 1U << j)
+		{
+			key.hash = (key.hash ^ HashPage(m_renderer->m_mem, (uint32)(i << 5) + j)) * 0x9E3779B185EBCA87ull;
+		}
+	}
+
+	return key;
+}
+
+void GSTextureCache::HashCache::Erase(std::unordered_map<Key, Entry, KeyHash>::iterator i, bool recycle)
+{
+	auto t = m_tex0.find(i->first.TEX0);
+
+	if(--t->second == 0)
+	{
+		m_tex0.erase(t);
+	}
+
+	if(recycle)
+	{
+		m_renderer->m_dev->Recycle(i->second.texture);
+	}
+
+	m_map.erase(i);
+}
+
+void GSTextureCache::HashCache::Add(Source* s)
+{
+	// The texture must hold all of the data of the source, uploaded from the pages as they are
+	// now: any write since then cleared m_complete, unless it was a readback (m_generation).
+
+	if(s->m_target || s->m_shared_texture || s->m_from_target != NULL || !s->m_complete || s->m_texture == NULL)
+	{
+		return;
+	}
+
+	if(s->m_hash_generation != m_generation || m_map.size() >= MaxSize)
+	{
+		return;
+	}
+
+	auto r = m_map.emplace(GetKey(s), Entry());
+
+	if(!r.second)
+	{
+		return; // the same content is already kept
+	}
+
+	Entry& e = r.first->second;
+
+	e.texture = s->m_texture;
+	e.palette = s->m_palette == NULL ? s->m_palette_obj : nullptr;
+	e.valid.assign(s->m_valid, s->m_valid + MAX_PAGES);
+	e.age = 0;
+
+	m_tex0[r.first->first.TEX0]++;
+
+	s->m_texture = NULL; // owned by the cache now
+}
+
+bool GSTextureCache::HashCache::Lookup(Source* s)
+{
+	if(m_tex0.find(GetTEX0(s->m_TEX0)) == m_tex0.end())
+	{
+		return false;
+	}
+
+	auto i = m_map.find(GetKey(s));
+
+	if(i == m_map.end())
+	{
+		return false;
+	}
+
+	s->m_texture = i->second.texture;
+	memcpy(s->m_valid, i->second.valid.data(), sizeof(s->m_valid));
+	s->m_complete = true;
+
+	Erase(i, false);
+
+	int tw = std::max<int>(1 << s->m_TEX0.TW, GSLocalMemory::m_psm[s->m_TEX0.PSM].bs.x);
+	int th = std::max<int>(1 << s->m_TEX0.TH, GSLocalMemory::m_psm[s->m_TEX0.PSM].bs.y);
+
+	m_renderer->m_perfmon.Put(GSPerfMon::UnswizzleSkip, tw * th << (s->m_palette ? 2 : 0));
+
+	return true;
+}
+
+void GSTextureCache::HashCache::IncAge()
+{
+	for(auto i = m_map.begin(); i != m_map.end(); )
+	{
+		auto j = i++;
+
+		if(++j->second.age > MaxAge)
+		{
+			Erase(j, true);
+		}
+	}
+}
+
+void GSTextureCache::HashCache::RemoveAll()
+{
+	for(auto& i : m_map)
+	{
+		m_renderer->m_dev->Recycle(i.second.texture);
+	}
+
+	m_map.clear();
+	m_tex0.clear();
+}
+
 void GSTextureCache::AttachPaletteToSource(Source* s, uint16 pal, bool need_gs_texture)
 {
 	s->m_palette_obj = m_palette_map.LookupPalette(pal, need_gs_texture);
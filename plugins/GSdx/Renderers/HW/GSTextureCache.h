@@ -121,6 +121,16 @@ public:
 		// Keep a GSTextureCache::SourceMap::m_map iterator to allow fast erase
 		std::array<uint16, MAX_PAGES> m_erase_it;
 		uint32* m_pages_as_bit;
+		// Content hashing (texture_hash): the m_valid bits removed by an invalidation are kept
+		// with a hash of their page, Update restores them instead of uploading if the page is unchanged.
+		// Textures of removed sources are shared through HashCache.
+		struct PageHash
+		{
+			uint32 stale[MAX_PAGES]; // same layout as m_valid
+			uint64 hash[MAX_PAGES];
+			uint32 pending[MAX_PAGES / 32]; // pages with a hash to check
+		}* m_page_hash;
+		uint32 m_hash_generation; // HashCache::m_generation when the source was created
 
 	public:
 		Source(GSRenderer* r, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, uint8* temp, bool dummy_container = false);
@@ -130,11 +140,17 @@ public:
 		void UpdateLayer(const GIFRegTEX0& TEX0, const GSVector4i& rect, int layer = 0);
 
 		bool ClutMatch(PaletteKey palette_key);
+
+		void Invalidate(uint32 page, uint64 hash);
+		void Revalidate(uint32 page);
 	};
 
+	class TargetIndex;
+
 	class Target : public Surface
 	{
 	public:
+		TargetIndex* m_index;
 		int m_type;
 		bool m_used;
 		GSDirtyRectList m_dirty;
@@ -143,7 +159,7 @@ public:
 		bool m_dirty_alpha;
 
 	public:
-		Target(GSRenderer* r, const GIFRegTEX0& TEX0, uint8* temp, bool depth_supported);
+		Target(GSRenderer* r, const GIFRegTEX0& TEX0, uint8* temp, bool depth_supported, TargetIndex* index);
 
 		void UpdateValidity(const GSVector4i& rect);
 
@@ -170,6 +186,59 @@ public:
 		void Clear(); // Clears m_maps, thus deletes Palette objects
 	};
 
+	// Content hashing (texture_hash): the textures of removed sources, keyed by the content of
+	// their pages, TEX0, TEXA and CLUT. A source created again over the same data takes the
+	// texture back instead of unswizzling and uploading it.
+	class HashCache
+	{
+		struct Key
+		{
+			uint64 hash; // pages of the texture
+			uint64 TEX0; // TBP0 TBW PSM TW TH
+			uint64 TEXA; // only for the formats expanded with it
+			const Palette* clut; // palette of CPU expanded textures, PaletteMap shares them by content
+
+			bool operator==(const Key& k) const {return hash == k.hash && TEX0 == k.TEX0 && TEXA == k.TEXA && clut == k.clut;}
+		};
+
+		struct KeyHash
+		{
+			std::size_t operator()(const Key& k) const {return (std::size_t)(k.hash ^ k.TEX0 ^ (k.TEXA * 31) ^ (uptr)k.clut);}
+		};
+
+		struct Entry
+		{
+			GSTexture* texture;
+			std::shared_ptr<Palette> palette; // keeps the Palette of the key alive
+			std::vector<uint32> valid; // m_valid of the source
+			int age;
+		};
+
+		static const int MaxAge = 30; // frames
+		static const size_t MaxSize = 256;
+
+		GSRenderer* m_renderer;
+		std::unordered_map<Key, Entry, KeyHash> m_map;
+		std::unordered_map<uint64, uint32> m_tex0; // keys per TEX0, other lookups don't hash anything
+
+		static uint64 GetTEX0(const GIFRegTEX0& TEX0) {return TEX0.u32[0] | ((uint64)(TEX0.u32[1] & 3) << 32);}
+
+		Key GetKey(const Source* s) const;
+		void Erase(std::unordered_map<Key, Entry, KeyHash>::iterator i, bool recycle);
+
+	public:
+		// Bumped when local memory is written without invalidating the sources over it (readbacks
+		// of targets), a source created before may not match its pages anymore.
+		uint32 m_generation;
+
+		HashCache(GSRenderer* r) : m_renderer(r), m_generation(0) {}
+
+		void Add(Source* s); // takes the texture of a source about to be deleted, if its content is known
+		bool Lookup(Source* s); // gives a new source the texture of the same content, if any
+		void IncAge();
+		void RemoveAll();
+	};
+
 	class SourceMap
 	{
 	public:
@@ -177,8 +246,9 @@ public:
 		std::array<FastList<Source*>, MAX_PAGES> m_map;
 		uint32 m_pages[16]; // bitmap of all pages
 		bool m_used;
+		HashCache* m_hash_cache; // texture_hash, RemoveAt hands the textures over
 
-		SourceMap() : m_used(false) {memset(m_pages, 0, sizeof(m_pages));}
+		SourceMap() : m_used(false), m_hash_cache(NULL) {memset(m_pages, 0, sizeof(m_pages));}
 
 		void Add(Source* s, const GIFRegTEX0& TEX0, GSOffset* off);
 		void RemoveAll();
@@ -186,6 +256,23 @@ public:
 		void RemoveAt(Source* s);
 	};
 
+	// Page bitmaps of the targets, used to skip the scans of m_dst. Bits are only set (when a
+	// target is created or grows) and the index is rebuilt from the lists once per frame, so
+	// a clear bit proves that no target starts on, or spans over, that page.
+	class TargetIndex
+	{
+	public:
+		uint32 m_tbp[2][MAX_PAGES / 32]; // pages holding a TBP0, per type
+		uint32 m_pages[MAX_PAGES / 32]; // pages from TBP0 to m_end_block, both types
+
+		TargetIndex() {Clear();}
+
+		void Clear();
+		void Add(const Target* t);
+		bool Has(int type, uint32 bp) const {uint32 page = (bp >> 5) % MAX_PAGES; return (m_tbp[type][page >> 5] & (1u << (page & 31))) != 0;}
+		bool Overlaps(uint32 first, uint32 last) const;
+	};
+
 	struct TexInsideRtCacheEntry
 	{
 		uint32 psm;
@@ -203,7 +290,9 @@ protected:
 	GSRenderer* m_renderer;
 	PaletteMap m_palette_map;
 	SourceMap m_src;
+	HashCache m_hash_cache;
 	FastList<Target*> m_dst[2];
+	TargetIndex m_dst_index;
 	bool m_paltex;
 	bool m_preload_frame;
 	uint8* m_temp;
@@ -211,6 +300,7 @@ protected:
 	bool m_cpu_fb_conversion;
 	CRCHackLevel m_crc_hack_level;
 	static bool m_disable_partial_invalidation;
+	bool m_texture_hash;
 	bool m_texture_inside_rt;
 	static bool m_wrap_gs_mem;
 	uint8 m_texture_inside_rt_cache_size = 255;
@@ -218,6 +308,7 @@ protected:
 
 	virtual Source* CreateSource(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, Target* t = NULL, bool half_right = false, int x_offset = 0, int y_offset = 0);
 	virtual Target* CreateTarget(const GIFRegTEX0& TEX0, int w, int h, int type);
+	void RebuildTargetIndex();
 
 	virtual int Get8bitFormat() = 0;
 
@@ -242,6 +333,7 @@ public:
 	void InvalidateVideoMemSubTarget(GSTextureCache::Target* rt);
 	void InvalidateVideoMem(GSOffset* off, const GSVector4i& r, bool target = true);
 	void InvalidateLocalMem(GSOffset* off, const GSVector4i& r);
+	void LocalMemWritten() {m_hash_cache.m_generation++;}
 
 	void IncAge();
 	bool UserHacks_HalfPixelOffset;
@@ -140,7 +140,8 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 	m_pixels.actual = 0;
 	m_pixels.total = 0;
 
-	data->start = __rdtsc();
+	// data is shared by all the rasterizer threads, each keeps its own start
+	const uint64 start = __rdtsc();
 
 	m_ds->BeginDraw(data);
 
@@ -228,10 +229,15 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 
 	data->pixels = m_pixels.actual;
 
-	uint64 ticks = __rdtsc() - data->start;
+	uint64 ticks = __rdtsc() - start;
 
 	m_pixels.sum += m_pixels.actual;
 
+	if(data->perf_id != 0)
+	{
+		m_perfmon->AddRaster(data->perf_id, start, start + ticks, m_pixels.actual);
+	}
+
 	m_ds->EndDraw(data->frame, ticks, m_pixels.actual, m_pixels.total);
 }
 
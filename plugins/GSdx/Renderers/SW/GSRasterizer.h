@@ -45,6 +45,7 @@ public:
 	uint64 start;
 	int pixels;
 	int counter;
+	uint64 perf_id;
 
 	GSRasterizerData() 
 		: scissor(GSVector4i::zero())
@@ -58,6 +59,7 @@ public:
 		, frame(0)
 		, start(0)
 		, pixels(0)
+		, perf_id(0)
 	{
 		counter = s_counter++;
 	}
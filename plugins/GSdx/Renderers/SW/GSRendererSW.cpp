@@ -45,7 +45,7 @@ GSRendererSW::GSRendererSW(int threads)
 {
 	m_nativeres = true; // ignore ini, sw is always native
 
-	m_tc = new GSTextureCacheSW(this);
+	m_tc = new GSTextureCacheSW(this, threads);
 
 	memset(m_texture, 0, sizeof(m_texture));
 
@@ -426,6 +426,7 @@ void GSRendererSW::Draw()
 	sd->scissor = scissor;
 	sd->bbox = bbox;
 	sd->frame = m_perfmon.GetFrame();
+	sd->perf_id = m_perfmon.GetDrawId();
 
 	if(!GetScanlineGlobalData(sd))
 	{
@@ -592,6 +593,8 @@ void GSRendererSW::Queue(std::shared_ptr<GSRasterizerData>& item)
 {
 	SharedData* sd = (SharedData*)item.get();
 
+	m_perfmon.SetupDone();
+
 	if(sd->m_syncpoint == SharedData::SyncSource) 
 	{
 		Sync(4);
@@ -22,8 +22,9 @@
 #include "stdafx.h"
 #include "GSTextureCacheSW.h"
 
-GSTextureCacheSW::GSTextureCacheSW(GSState* state)
+GSTextureCacheSW::GSTextureCacheSW(GSState* state, int threads)
 	: m_state(state)
+	, m_converter(threads)
 {
 }
 
@@ -60,11 +61,14 @@ GSTextureCacheSW::Texture* GSTextureCacheSW::Lookup(const GIFRegTEX0& TEX0, cons
 		// Lookup hit
 		m.MoveFront(i.Index());
 		t->m_age = 0;
+		m_state->m_perfmon.TextureLookup(true);
 		return t;
 	}
 
 	// Lookup miss
-	Texture* t = new Texture(m_state, tw0, TEX0, TEXA);
+	m_state->m_perfmon.TextureLookup(false);
+
+	Texture* t = new Texture(m_state, &m_converter, tw0, TEX0, TEXA);
 
 	m_textures.insert(t);
 
@@ -146,8 +150,9 @@ void GSTextureCacheSW::IncAge()
 
 //
 
-GSTextureCacheSW::Texture::Texture(GSState* state, uint32 tw0, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA)
+GSTextureCacheSW::Texture::Texture(GSState* state, Converter* converter, uint32 tw0, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA)
 	: m_state(state)
+	, m_converter(converter)
 	, m_buff(NULL)
 	, m_tw(tw0)
 	, m_age(0)
@@ -226,17 +231,11 @@ bool GSTextureCacheSW::Texture::Update(const GSVector4i& rect)
 		}
 	}
 
-	GSLocalMemory& mem = m_state->m_mem;
-
 	const GSOffset* RESTRICT off = m_offset;
 
-	uint32 blocks = 0;
-
-	GSLocalMemory::readTextureBlock rtxbP = psm.rtxbP;
-
 	uint32 pitch = (1 << m_tw) << shift;
 
-	uint8* dst = (uint8*)m_buff + pitch * r.top;
+	uint32 offset = pitch * r.top;
 
 	int block_pitch = pitch * bs.y;
 
@@ -249,7 +248,7 @@ bool GSTextureCacheSW::Texture::Update(const GSVector4i& rect)
 
 	if(m_repeating)
 	{
-		for(int y = r.top; y < r.bottom; y += bs.y, dst += block_pitch)
+		for(int y = r.top; y < r.bottom; y += bs.y, offset += block_pitch)
 		{
 			uint32 base = off->block.row[y];
 
@@ -264,16 +263,14 @@ bool GSTextureCacheSW::Texture::Update(const GSVector4i& rect)
 				{
 					m_valid[row] |= col;
 
-					(mem.*rtxbP)(block, &dst[x << shift], pitch, m_TEXA);
-
-					blocks++;
+					m_converter->Add(block, offset + (x << shift));
 				}
 			}
 		}
 	}
 	else
 	{
-		for(int y = r.top; y < r.bottom; y += bs.y, dst += block_pitch)
+		for(int y = r.top; y < r.bottom; y += bs.y, offset += block_pitch)
 		{
 			uint32 base = off->block.row[y];
 
@@ -288,14 +285,14 @@ bool GSTextureCacheSW::Texture::Update(const GSVector4i& rect)
 				{
 					m_valid[row] |= col;
 
-					(mem.*rtxbP)(block, &dst[x << shift], pitch, m_TEXA);
-
-					blocks++;
+					m_converter->Add(block, offset + (x << shift));
 				}
 			}
 		}
 	}
 
+	uint32 blocks = (uint32)m_converter->Run(this);
+
 	if(blocks > 0)
 	{
 		m_state->m_perfmon.Put(GSPerfMon::Unswizzle, bs.x * bs.y * blocks << shift);
@@ -304,6 +301,86 @@ bool GSTextureCacheSW::Texture::Update(const GSVector4i& rect)
 	return true;
 }
 
+//
+
+GSTextureCacheSW::Converter::Converter(int threads)
+{
+	for(int i = 0; i < threads; i++)
+	{
+		m_workers.push_back(std::unique_ptr<GSWorker>(new GSWorker(
+			[](Job& job) { Convert(job); })));
+	}
+}
+
+GSTextureCacheSW::Converter::~Converter()
+{
+}
+
+void GSTextureCacheSW::Converter::Convert(const Job& job)
+{
+	const Texture* t = job.t;
+
+	const GSLocalMemory& mem = t->m_state->m_mem;
+
+	const GSLocalMemory::psm_t& psm = GSLocalMemory::m_psm[t->m_TEX0.PSM];
+
+	GSLocalMemory::readTextureBlock rtxbP = psm.rtxbP;
+
+	int pitch = (1 << t->m_tw) << (psm.pal == 0 ? 2 : 0);
+
+	uint8* buff = (uint8*)t->m_buff;
+
+	for(const Block* RESTRICT b = job.begin; b < job.end; b++)
+	{
+		(mem.*rtxbP)(b->block, &buff[b->offset], pitch, t->m_TEXA);
+	}
+}
+
+size_t GSTextureCacheSW::Converter::Run(const Texture* t)
+{
+	// below this, waking up the workers costs more than it saves
+
+	static const size_t min_blocks_per_job = 128;
+
+	size_t count = m_blocks.size();
+
+	if(count == 0)
+	{
+		return 0;
+	}
+
+	size_t jobs = std::min<size_t>(m_workers.size() + 1, std::max<size_t>(count / min_blocks_per_job, 1));
+
+	size_t n = count / jobs;
+
+	Job job;
+
+	job.t = t;
+	job.begin = m_blocks.data();
+
+	for(size_t i = 0; i < jobs - 1; i++)
+	{
+		job.end = job.begin + n;
+
+		m_workers[i]->Push(job);
+
+		job.begin = job.end;
+	}
+
+	job.end = m_blocks.data() + count;
+
+	Convert(job);
+
+	for(size_t i = 0; i < jobs - 1; i++)
+	{
+		m_workers[i]->Wait();
+	}
+
+	m_blocks.clear();
+
+	return count;
+}
+
 #include "GSTextureSW.h"
 
 bool GSTextureCacheSW::Texture::Save(const std::string& fn, bool dds) const
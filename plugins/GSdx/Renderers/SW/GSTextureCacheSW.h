@@ -23,14 +23,45 @@
 
 #include "Renderers/Common/GSRenderer.h"
 #include "Renderers/Common/GSFastList.h"
+#include "GSThread_CXX11.h"
 
 class GSTextureCacheSW
 {
 public:
+	class Texture;
+
+	// Texture::Update only collects the invalid blocks, the unswizzling itself is split
+	// into jobs here. Large updates are spread over the workers, the calling thread takes
+	// its own share and waits for the rest, so the draw still sees a complete m_buff.
+
+	class Converter
+	{
+	public:
+		struct Block {uint32 block, offset;};
+		struct Job {const Texture* t; const Block* begin; const Block* end;};
+
+	private:
+		using GSWorker = GSJobQueue<Job, 256>;
+
+		std::vector<std::unique_ptr<GSWorker>> m_workers;
+		std::vector<Block> m_blocks;
+
+		static void Convert(const Job& job);
+
+	public:
+		Converter(int threads);
+		virtual ~Converter();
+
+		__forceinline void Add(uint32 block, uint32 offset) {m_blocks.push_back({block, offset});}
+
+		size_t Run(const Texture* t);
+	};
+
 	class Texture
 	{
 	public:
 		GSState* m_state;
+		Converter* m_converter;
 		GSOffset* m_offset;
 		GIFRegTEX0 m_TEX0;
 		GIFRegTEXA m_TEXA;
@@ -49,7 +80,7 @@ public:
 		// fast mode: each uint32 bits map to the 32 blocks of that page
 		// repeating mode: 1 bpp image of the texture tiles (8x8), also having 512 elements is just a coincidence (worst case: (1024*1024)/(8*8)/(sizeof(uint32)*8))
 
-		Texture(GSState* state, uint32 tw0, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA);
+		Texture(GSState* state, Converter* converter, uint32 tw0, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA);
 		virtual ~Texture();
 
 		bool Update(const GSVector4i& r);
@@ -60,9 +91,10 @@ protected:
 	GSState* m_state;
 	std::unordered_set<Texture*> m_textures;
 	std::array<FastList<Texture*>, MAX_PAGES> m_map;
+	Converter m_converter;
 
 public:
-	GSTextureCacheSW(GSState* state);
+	GSTextureCacheSW(GSState* state, int threads = 0);
 	virtual ~GSTextureCacheSW();
 
 	Texture* Lookup(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, uint32 tw0 = 0);
@@ -56,6 +56,29 @@ public:
 
 };
 
+// Window-less stand-in used by the headless replay benchmark. Only makes sense with a
+// device that doesn't need a context (GSDeviceNull).
+
+class GSWndNull : public GSWnd
+{
+public:
+	GSWndNull() {}
+	virtual ~GSWndNull() {}
+
+	bool Create(const std::string& title, int w, int h) {return true;}
+	bool Attach(void* handle, bool managed = true) {m_managed = managed; return true;}
+	void Detach() {}
+
+	void* GetDisplay() {return (void*)-1;}
+	void* GetHandle() {return (void*)-1;}
+	GSVector4i GetClientRect() {return GSVector4i(0, 0, 640, 480);}
+	bool SetWindowText(const char* title) {return true;}
+
+	void Show() {}
+	void Hide() {}
+	void HideFrame() {}
+};
+
 class GSWndGL : public GSWnd
 {
 protected:
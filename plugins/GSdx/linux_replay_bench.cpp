@@ -0,0 +1,113 @@
+/*
+ *  Copyright (C) 2019 PCSX2 Dev Team
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <dlfcn.h>
+#include <getopt.h>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// Must match GSRendererType
+enum { RENDERER_NULL = 11, RENDERER_SW = 13 };
+
+static void* handle;
+
+void help()
+{
+	fprintf(stderr, "Headless gs file benchmark\n");
+	fprintf(stderr, "Usage: [options] <GSdx plugin> <.gs file or directory>\n");
+	fprintf(stderr, "  -r null|sw   renderer (default sw)\n");
+	fprintf(stderr, "  -l N         number of loops over the dump (default 3)\n");
+	fprintf(stderr, "  -w N         warm-up frames, not measured (default 30)\n");
+	fprintf(stderr, "  -o file      output file, .csv for CSV, JSON otherwise (default stdout)\n");
+	fprintf(stderr, "  -c dir       ini directory (default GSDUMP_CONF, or ~/.config/pcsx2/inis)\n");
+	if (handle) {
+		dlclose(handle);
+	}
+	exit(1);
+}
+
+int main ( int argc, char *argv[] )
+{
+	int renderer = RENDERER_SW;
+	int loops = 3;
+	int warmup = 30;
+	const char* output = nullptr;
+	std::string ini_dir;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "r:l:w:o:c:h")) != -1) {
+		switch (opt) {
+			case 'r':
+				if (strcmp(optarg, "null") == 0)
+					renderer = RENDERER_NULL;
+				else if (strcmp(optarg, "sw") == 0)
+					renderer = RENDERER_SW;
+				else
+					help();
+				break;
+			case 'l': loops = atoi(optarg); break;
+			case 'w': warmup = atoi(optarg); break;
+			case 'o': output = optarg; break;
+			case 'c': ini_dir = optarg; break;
+			default: help();
+		}
+	}
+
+	if (argc - optind != 2) help();
+
+	char* plugin = argv[optind];
+	char* gs = argv[optind + 1];
+
+	if (ini_dir.empty()) {
+		if (char* conf = getenv("GSDUMP_CONF")) {
+			ini_dir = conf;
+		} else if (char* home = getenv("HOME")) {
+			ini_dir = std::string(home) + "/.config/pcsx2/inis";
+		}
+	}
+
+	handle = dlopen(plugin, RTLD_LAZY|RTLD_GLOBAL);
+	if (handle == NULL) {
+		fprintf(stderr, "Failed to dlopen plugin %s\n", plugin);
+		help();
+	}
+
+	__attribute__((stdcall)) void (*GSsetSettingsDir_ptr)(const char*);
+	__attribute__((stdcall)) int (*GSReplayBenchmark_ptr)(const char*, int, int, int, const char*);
+
+	GSsetSettingsDir_ptr = reinterpret_cast<decltype(GSsetSettingsDir_ptr)>(dlsym(handle, "GSsetSettingsDir"));
+	GSReplayBenchmark_ptr = reinterpret_cast<decltype(GSReplayBenchmark_ptr)>(dlsym(handle, "GSReplayBenchmark"));
+
+	if (GSReplayBenchmark_ptr == NULL) {
+		fprintf(stderr, "Plugin %s has no GSReplayBenchmark\n", plugin);
+		help();
+	}
+
+	if (!ini_dir.empty())
+		GSsetSettingsDir_ptr(ini_dir.c_str());
+
+	int failed = GSReplayBenchmark_ptr(gs, renderer, loops, warmup, output);
+
+	dlclose(handle);
+
+	return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -108,6 +108,7 @@ typedef int64 sint64;
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <bitset>
@@ -0,0 +1,147 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2020 PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "DirtyPageTracker.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+
+static const uint PageSize = DirtyPageTracker::PageSize;
+static const uint RegionPages = 64;
+
+// Page aligned, so that soft-dirty bits map to our pages.
+alignas(4096) static u8 s_ee[RegionPages * PageSize];
+alignas(4096) static u8 s_iop[RegionPages / 4 * PageSize];
+
+static bool Contains(const std::vector<u32>& pages, u32 page)
+{
+	return std::find(pages.begin(), pages.end(), page) != pages.end();
+}
+
+static void Scribble(u8* mem, u32 page, u8 value)
+{
+	((volatile u8*)mem)[page * PageSize + 100] = value;
+}
+
+TEST(DirtyPageTrackerTests, MergePages)
+{
+	std::vector<u32> out;
+	DirtyPageTracker::MergePages({1, 4, 9}, {2, 4, 10, 11}, out);
+	EXPECT_EQ(out, std::vector<u32>({1, 2, 4, 9, 10, 11}));
+
+	DirtyPageTracker::MergePages({}, {3}, out);
+	EXPECT_EQ(out, std::vector<u32>({3}));
+}
+
+static void SetRegions(DirtyPageTracker& tracker)
+{
+	tracker.SetRegion(DirtyPageTracker::Region_EEMain, s_ee, sizeof(s_ee));
+	tracker.SetRegion(DirtyPageTracker::Region_IOPMain, s_iop, sizeof(s_iop));
+}
+
+TEST(DirtyPageTrackerTests, UntrackedReportsEverything)
+{
+	DirtyPageTracker tracker;
+	SetRegions(tracker);
+	EXPECT_FALSE(tracker.IsValid(DirtyPageTracker::Checkpoint_Rewind));
+
+	std::vector<u32> pages;
+	tracker.Collect(DirtyPageTracker::Checkpoint_Rewind, DirtyPageTracker::Region_EEMain, pages);
+	EXPECT_EQ(pages.size(), RegionPages);
+}
+
+TEST(DirtyPageTrackerTests, CollectsWrittenPages)
+{
+	DirtyPageTracker tracker;
+	SetRegions(tracker);
+	tracker.Mark(DirtyPageTracker::Checkpoint_Rewind);
+	ASSERT_TRUE(tracker.IsValid(DirtyPageTracker::Checkpoint_Rewind));
+
+	Scribble(s_ee, 3, 0x11);
+	Scribble(s_ee, 40, 0x22);
+	Scribble(s_iop, 7, 0x33);
+
+	std::vector<u32> ee, iop;
+	tracker.Collect(DirtyPageTracker::Checkpoint_Rewind, DirtyPageTracker::Region_EEMain, ee);
+	tracker.Collect(DirtyPageTracker::Checkpoint_Rewind, DirtyPageTracker::Region_IOPMain, iop);
+
+	// Soft-dirty bits may report more than what was written, never less.
+	EXPECT_TRUE(Contains(ee, 3));
+	EXPECT_TRUE(Contains(ee, 40));
+	EXPECT_TRUE(Contains(iop, 7));
+	EXPECT_LT(ee.size(), RegionPages);
+	EXPECT_TRUE(std::is_sorted(ee.begin(), ee.end()));
+
+	tracker.Invalidate();
+	EXPECT_FALSE(tracker.IsValid(DirtyPageTracker::Checkpoint_Rewind));
+}
+
+TEST(DirtyPageTrackerTests, CheckpointsKeepTheirPages)
+{
+	DirtyPageTracker tracker;
+	SetRegions(tracker);
+	tracker.Mark(DirtyPageTracker::Checkpoint_Savestate);
+
+	Scribble(s_ee, 5, 0x44);
+	tracker.Mark(DirtyPageTracker::Checkpoint_Rewind);
+	Scribble(s_ee, 9, 0x55);
+
+	std::vector<u32> savestate, rewind;
+	tracker.Collect(DirtyPageTracker::Checkpoint_Savestate, DirtyPageTracker::Region_EEMain, savestate);
+	tracker.Collect(DirtyPageTracker::Checkpoint_Rewind, DirtyPageTracker::Region_EEMain, rewind);
+
+	// Marking the rewind checkpoint must not lose page 5 for the savestate one.
+	EXPECT_TRUE(Contains(savestate, 5));
+	EXPECT_TRUE(Contains(savestate, 9));
+	EXPECT_TRUE(Contains(rewind, 9));
+	EXPECT_TRUE(std::is_sorted(savestate.begin(), savestate.end()));
+
+	tracker.Release(DirtyPageTracker::Checkpoint_Savestate);
+	EXPECT_FALSE(tracker.IsValid(DirtyPageTracker::Checkpoint_Savestate));
+	EXPECT_TRUE(tracker.IsValid(DirtyPageTracker::Checkpoint_Rewind));
+}
+
+// Two copies saved alternately the way RewindBuffer::Capture and memIncrementalSavingState
+// do it: each save only gets the pages the swap chain lists for the copy it goes over.
+TEST(DirtyPageTrackerTests, IncrementalCopyRoundTrip)
+{
+	static u8 copies[2][sizeof(s_ee)];
+
+	DirtyPageTracker tracker;
+	SetRegions(tracker);
+	DirtyPageSwapChain chain(tracker, DirtyPageTracker::Checkpoint_Rewind);
+
+	for (uint step = 0; step < 12; step++)
+	{
+		// as after a rewind: both copies are stale
+		if (step == 6)
+			chain.Reset();
+
+		const bool in_place = chain.Next();
+		const uint since_reset = step < 6 ? step : step - 6;
+		EXPECT_EQ(in_place, since_reset >= 2) << "step " << step;
+
+		u8* dst = copies[step & 1];
+		DirtyPageTracker::CopyPages(dst, s_ee, sizeof(s_ee),
+			in_place ? &chain.GetCopyPages(DirtyPageTracker::Region_EEMain) : NULL);
+
+		ASSERT_EQ(memcmp(dst, s_ee, sizeof(s_ee)), 0) << "step " << step;
+
+		// a few writes before the next save, some hitting the same pages again
+		for (uint i = 0; i < 3; i++)
+			Scribble(s_ee, (step * 7 + i * 13) % RegionPages, (u8)(step * 3 + i + 1));
+	}
+}
@@ -163,3 +163,21 @@ TEST(CodegenTests, SSETest)
 	CODEGEN_TEST_64(xBLEND.PD(xmm8, xmm9, 0xaa), "66 45 0f 3a 0d c1 aa");
 	CODEGEN_TEST_64(xEXTRACTPS(ptr32[base], xmm1, 2), "66 0f 3a 17 0d f6 ff ff ff 02");
 }
+
+TEST(CodegenTests, AVXTest)
+{
+	CODEGEN_TEST_BOTH(xVMOVDQU(ymm0, ptr[rdi]), "c5 fe 6f 07");
+	CODEGEN_TEST_BOTH(xVMOVDQU(ptr[rdi+0x20], ymm1), "c5 fe 7f 4f 20");
+	CODEGEN_TEST_64(xVMOVDQU(ymm8, ptr[rsi+0x40]), "c5 7e 6f 46 40");
+	CODEGEN_TEST_BOTH(xVPMOVZXWD(ymm0, ptr[rsi]), "c4 e2 7d 33 06");
+	CODEGEN_TEST_64(xVPMOVSXWD(ymm9, ptr[rsi+8]), "c4 62 7d 23 4e 08");
+	CODEGEN_TEST_BOTH(xVPMOVZXBD(ymm1, ptr[rdx]), "c4 e2 7d 31 0a");
+	CODEGEN_TEST_BOTH(xVPMOVSXBD(ymm0, ptr[rcx+0x10]), "c4 e2 7d 21 41 10");
+	CODEGEN_TEST_BOTH(xVPBLENDD(ymm0, ymm0, ymm7, 0x11), "c4 e3 7d 02 c7 11");
+	CODEGEN_TEST_64(xVPBLENDD(ymm8, ymm9, ymm10, 0xf0), "c4 43 35 02 c2 f0");
+	CODEGEN_TEST_BOTH(xVPBLENDD(ymm0, ymm0, ptr[rdi+0x70], 0x88), "c4 e3 7d 02 47 70 88");
+	CODEGEN_TEST_64(xVPBLENDD(ymm0, ymm0, ptr[base], 0x88), "c4 e3 7d 02 05 f6 ff ff ff 88");
+	CODEGEN_TEST_BOTH(xVINSERTI128(ymm7, ymm6, xmm6, 1), "c4 e3 4d 38 fe 01");
+	CODEGEN_TEST_64(xVINSERTI128(ymm15, ymm2, xmm12, 1), "c4 43 6d 38 fc 01");
+	CODEGEN_TEST_BOTH(xVZEROUPPER(), "c5 f8 77");
+}
@@ -0,0 +1,210 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Throughput benchmark for the IPC server (pcsx2/IPC.cpp).  Snapshots the EE main memory
+// with batched MsgRead64, with a single MsgReadRange and with MsgReadScatter, and reports
+// the time taken by each.  A game has to be running in PCSX2 with IPC enabled.
+//
+// usage: ipc_bench [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <WinSock2.h>
+#include <windows.h>
+#define close_portable(a) (closesocket(a))
+typedef SOCKET socket_t;
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define close_portable(a) (close(a))
+typedef int socket_t;
+#endif
+
+enum IPCCommand : uint8_t
+{
+	MsgRead64 = 3,
+	MsgReadRange = 9,
+	MsgReadScatter = 11,
+};
+
+static const uint32_t MainRamBase = 0x00000000;
+static const uint32_t MainRamSize = 32 * 1024 * 1024;
+
+// Same limits as the server, see IPC.h
+static const uint32_t MaxRequestSize = 650000;
+static const uint32_t MaxReplySize = 450000;
+
+static bool OpenSocket(socket_t& sock)
+{
+#ifdef _WIN32
+	sock = socket(AF_INET, SOCK_STREAM, 0);
+	if (sock == INVALID_SOCKET)
+		return false;
+
+	sockaddr_in server = {};
+	server.sin_family = AF_INET;
+	server.sin_addr.s_addr = inet_addr("127.0.0.1");
+	server.sin_port = htons(28011);
+#else
+	sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock < 0)
+		return false;
+
+#ifdef __APPLE__
+	const char* runtime_dir = getenv("TMPDIR");
+#else
+	const char* runtime_dir = getenv("XDG_RUNTIME_DIR");
+#endif
+	sockaddr_un server = {};
+	server.sun_family = AF_UNIX;
+	snprintf(server.sun_path, sizeof(server.sun_path), "%s/pcsx2.sock", runtime_dir ? runtime_dir : "/tmp");
+#endif
+
+	if (connect(sock, (sockaddr*)&server, sizeof(server)) != 0)
+	{
+		close_portable(sock);
+		return false;
+	}
+	return true;
+}
+
+// The server handles one message per connection.
+static bool Transact(std::vector<char>& request, std::vector<char>& reply)
+{
+	socket_t sock;
+	if (!OpenSocket(sock))
+		return false;
+
+	const uint32_t size = (uint32_t)request.size();
+	memcpy(request.data(), &size, 4);
+
+	size_t sent = 0;
+	while (sent < request.size())
+	{
+		const int res = send(sock, &request[sent], (int)(request.size() - sent), 0);
+		if (res <= 0)
+		{
+			close_portable(sock);
+			return false;
+		}
+		sent += res;
+	}
+
+	uint32_t expected = 4;
+	size_t received = 0;
+	while (received < expected)
+	{
+		if (reply.size() < expected)
+			reply.resize(expected);
+		const int res = recv(sock, &reply[received], (int)(expected - received), 0);
+		if (res <= 0)
+			break;
+		received += res;
+		if (expected == 4 && received >= 4)
+			memcpy(&expected, reply.data(), 4);
+	}
+	close_portable(sock);
+
+	return received >= 5 && received == expected && reply[4] == 0;
+}
+
+static void PushU8(std::vector<char>& buf, uint8_t v) { buf.push_back((char)v); }
+static void PushU32(std::vector<char>& buf, uint32_t v) { buf.insert(buf.end(), (char*)&v, (char*)&v + 4); }
+
+template <typename F>
+static double Measure(int iterations, F func)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++)
+	{
+		if (!func())
+			return -1.0;
+	}
+	const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / iterations;
+}
+
+static void Report(const char* name, double ms)
+{
+	if (ms < 0)
+		printf("%-28s failed\n", name);
+	else
+		printf("%-28s %10.2f ms  %8.1f MB/s\n", name, ms, MainRamSize / (1024.0 * 1024.0) / (ms / 1000.0));
+}
+
+int main(int argc, char** argv)
+{
+	const int iterations = argc > 1 ? atoi(argv[1]) : 10;
+
+#ifdef _WIN32
+	WSADATA wsa;
+	if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+		return 1;
+#endif
+
+	std::vector<char> request;
+	std::vector<char> reply;
+
+	// per address reads, as many as fit in one message
+	const uint32_t per_message = std::min<uint32_t>((MaxRequestSize - 4) / 5, (MaxReplySize - 5) / 8) - 1;
+	Report("MsgRead64 batches", Measure(iterations, [&]() {
+		for (uint32_t addr = 0; addr < MainRamSize;)
+		{
+			request.assign(4, 0);
+			for (uint32_t i = 0; i < per_message && addr < MainRamSize; i++, addr += 8)
+			{
+				PushU8(request, MsgRead64);
+				PushU32(request, MainRamBase + addr);
+			}
+			if (!Transact(request, reply))
+				return false;
+		}
+		return true;
+	}));
+
+	Report("MsgReadRange", Measure(iterations, [&]() {
+		request.assign(4, 0);
+		PushU8(request, MsgReadRange);
+		PushU32(request, MainRamBase);
+		PushU32(request, MainRamSize);
+		return Transact(request, reply);
+	}));
+
+	// one entry per 4KB page, the usual shape of a "watch these structures" scrape
+	Report("MsgReadScatter (4KB pages)", Measure(iterations, [&]() {
+		request.assign(4, 0);
+		PushU8(request, MsgReadScatter);
+		PushU32(request, MainRamSize / 4096);
+		for (uint32_t addr = 0; addr < MainRamSize; addr += 4096)
+		{
+			PushU32(request, MainRamBase + addr);
+			PushU32(request, 4096);
+		}
+		return Transact(request, reply);
+	}));
+
+#ifdef _WIN32
+	WSACleanup();
+#endif
+	return 0;
+}